@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,6 +8,7 @@
 #include <arch_helpers.h>
 #include <assert.h>
 #include <debug.h>
+#include <drivers/arm/arm_gic.h>
 #include <drivers/arm/gic_v2.h>
 
 void arm_gic_enable_interrupts_local(void)
@@ -39,12 +40,24 @@ void arm_gic_restore_context_local(void)
 void arm_gic_save_context_global(void)
 {
 	gicv2_save_sgi_ppi_context();
+	gicv2_save_spi_context();
 }
 
 void arm_gic_restore_context_global(void)
 {
 	gicv2_setup_distif();
 	gicv2_restore_sgi_ppi_context();
+	gicv2_restore_spi_context();
+}
+
+uintptr_t arm_gic_get_dist_base(void)
+{
+	return gicv2_get_gicd_base();
+}
+
+uintptr_t arm_gic_get_sgi_ppi_base(void)
+{
+	return gicv2_get_gicd_base();
 }
 
 void arm_gic_setup_global(void)
@@ -68,6 +81,16 @@ void arm_gic_send_sgi(unsigned int sgi_id, unsigned int core_pos)
 	gicv2_send_sgi(sgi_id, core_pos);
 }
 
+void arm_gic_send_sgi_mask(unsigned int sgi_id, const core_mask_t *mask)
+{
+	gicv2_send_sgi_mask(sgi_id, mask);
+}
+
+void arm_gic_send_sgi_all_but_self(unsigned int sgi_id)
+{
+	gicv2_send_sgi_all_but_self(sgi_id);
+}
+
 void arm_gic_set_intr_target(unsigned int num, unsigned int core_pos)
 {
 	gicv2_set_itargetsr(num, core_pos);
@@ -101,6 +124,11 @@ unsigned int arm_gic_is_intr_pending(unsigned int num)
 	return gicv2_gicd_get_ispendr(num);
 }
 
+void arm_gic_set_intr_pending(unsigned int num)
+{
+	gicv2_gicd_set_ispendr(num);
+}
+
 void arm_gic_intr_clear(unsigned int num)
 {
 	gicv2_gicd_set_icpendr(num);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,9 +8,11 @@
 #include <arch_helpers.h>
 #include <assert.h>
 #include <debug.h>
+#include <drivers/arm/arm_gic.h>
 #include <drivers/arm/gic_common.h>
 #include <drivers/arm/gic_v2.h>
 #include <drivers/arm/gic_v3.h>
+#include <platform.h>
 
 /* Record whether a GICv3 was detected on the system */
 static unsigned int gicv3_detected;
@@ -60,10 +62,13 @@ void arm_gic_restore_context_local(void)
 
 void arm_gic_save_context_global(void)
 {
-	if (gicv3_detected)
+	if (gicv3_detected) {
 		gicv3_save_sgi_ppi_context();
-	else
+		gicv3_save_spi_context();
+	} else {
 		gicv2_save_sgi_ppi_context();
+		gicv2_save_spi_context();
+	}
 }
 
 void arm_gic_restore_context_global(void)
@@ -71,12 +76,31 @@ void arm_gic_restore_context_global(void)
 	if (gicv3_detected) {
 		gicv3_setup_distif();
 		gicv3_restore_sgi_ppi_context();
+		gicv3_restore_spi_context();
 	} else {
 		gicv2_setup_distif();
 		gicv2_restore_sgi_ppi_context();
+		gicv2_restore_spi_context();
 	}
 }
 
+uintptr_t arm_gic_get_dist_base(void)
+{
+	if (gicv3_detected)
+		return gicv3_get_gicd_base();
+	else
+		return gicv2_get_gicd_base();
+}
+
+uintptr_t arm_gic_get_sgi_ppi_base(void)
+{
+	if (gicv3_detected)
+		return gicv3_get_rdist_base(platform_get_core_pos(
+				read_mpidr_el1())) + GICR_SGIBASE_OFFSET;
+	else
+		return gicv2_get_gicd_base();
+}
+
 void arm_gic_setup_global(void)
 {
 	if (gicv3_detected)
@@ -110,6 +134,22 @@ void arm_gic_send_sgi(unsigned int sgi_id, unsigned int core_pos)
 		gicv2_send_sgi(sgi_id, core_pos);
 }
 
+void arm_gic_send_sgi_mask(unsigned int sgi_id, const core_mask_t *mask)
+{
+	if (gicv3_detected)
+		gicv3_send_sgi_mask(sgi_id, mask);
+	else
+		gicv2_send_sgi_mask(sgi_id, mask);
+}
+
+void arm_gic_send_sgi_all_but_self(unsigned int sgi_id)
+{
+	if (gicv3_detected)
+		gicv3_send_sgi_all_but_self(sgi_id);
+	else
+		gicv2_send_sgi_all_but_self(sgi_id);
+}
+
 void arm_gic_set_intr_target(unsigned int num, unsigned int core_pos)
 {
 	if (gicv3_detected)
@@ -163,6 +203,14 @@ unsigned int arm_gic_is_intr_pending(unsigned int num)
 		return gicv2_gicd_get_ispendr(num);
 }
 
+void arm_gic_set_intr_pending(unsigned int num)
+{
+	if (gicv3_detected)
+		gicv3_set_ispendr(num);
+	else
+		gicv2_gicd_set_ispendr(num);
+}
+
 void arm_gic_intr_clear(unsigned int num)
 {
 	if (gicv3_detected)
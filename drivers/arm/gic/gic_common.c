@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,6 +7,7 @@
 #include <arch.h>
 #include <arch_helpers.h>
 #include <assert.h>
+#include <drivers/arm/arm_gic.h>
 #include <drivers/arm/gic_common.h>
 #include <drivers/arm/gic_v3.h>
 #include <mmio.h>
@@ -123,6 +124,94 @@ void gicd_write_icfgr(uintptr_t base,
 	mmio_write_32(base + GICD_ICFGR + (n << 2), val);
 }
 
+/*******************************************************************************
+ * GIC Distributor context save and restore
+ ******************************************************************************/
+
+/* Interrupts of a 32-bit bitmap sharing an IPRIORITYR or ICFGR register */
+#define IPRIORITYR_BLOCK_MASK	0xfU
+#define ICFGR_BLOCK_MASK	0xffffU
+
+void gicd_ctx_set_configured(uint32_t *configured, unsigned int n)
+{
+	/* Several CPUs can configure SPIs at the same time */
+	__atomic_fetch_or(&configured[n >> ISENABLER_SHIFT],
+			  1U << (n & ((1U << ISENABLER_SHIFT) - 1U)),
+			  __ATOMIC_RELAXED);
+}
+
+void gicd_save_intr_ctx(uintptr_t base, unsigned int first_id,
+			unsigned int num, uint32_t *configured,
+			uint32_t *isenabler, uint32_t *ipriorityr,
+			uint32_t *icfgr)
+{
+	unsigned int i, j, id, mask;
+
+	assert((first_id % 32) == 0);
+
+	for (i = 0; i < GIC_CTX_ISENABLER_NUM(num); i++) {
+		id = first_id + (i << ISENABLER_SHIFT);
+		isenabler[i] = gicd_read_isenabler(base, id);
+
+		configured[i] |= isenabler[i];
+		mask = configured[i];
+		if (mask == 0U)
+			continue;
+
+		/* 4 interrupts per IPRIORITYR register */
+		for (j = 0; j < 8; j++) {
+			if (((mask >> (j << 2)) & IPRIORITYR_BLOCK_MASK) != 0U)
+				ipriorityr[(i << 3) + j] = gicd_read_ipriorityr(
+					base, id + (j << IPRIORITYR_SHIFT));
+		}
+
+		/* 16 interrupts per ICFGR register. ICFGR0 is read-only. */
+		for (j = 0; j < 2; j++) {
+			if ((id + (j << ICFGR_SHIFT)) < MIN_PPI_ID)
+				continue;
+			if (((mask >> (j << ICFGR_SHIFT)) & ICFGR_BLOCK_MASK) != 0U)
+				icfgr[(i << 1) + j] = gicd_read_icfgr(
+					base, id + (j << ICFGR_SHIFT));
+		}
+	}
+}
+
+void gicd_restore_intr_ctx(uintptr_t base, unsigned int first_id,
+			   unsigned int num, const uint32_t *configured,
+			   const uint32_t *isenabler,
+			   const uint32_t *ipriorityr, const uint32_t *icfgr)
+{
+	unsigned int i, j, id, mask;
+
+	assert((first_id % 32) == 0);
+
+	for (i = 0; i < GIC_CTX_ISENABLER_NUM(num); i++) {
+		id = first_id + (i << ISENABLER_SHIFT);
+		mask = configured[i];
+		if (mask == 0U)
+			continue;
+
+		for (j = 0; j < 8; j++) {
+			if (((mask >> (j << 2)) & IPRIORITYR_BLOCK_MASK) != 0U)
+				gicd_write_ipriorityr(base,
+					id + (j << IPRIORITYR_SHIFT),
+					ipriorityr[(i << 3) + j]);
+		}
+
+		for (j = 0; j < 2; j++) {
+			if ((id + (j << ICFGR_SHIFT)) < MIN_PPI_ID)
+				continue;
+			if (((mask >> (j << ICFGR_SHIFT)) & ICFGR_BLOCK_MASK) != 0U)
+				gicd_write_icfgr(base, id + (j << ICFGR_SHIFT),
+						 icfgr[(i << 1) + j]);
+		}
+
+		/* Writing 0 to ISENABLER has no effect */
+		if (isenabler[i] != 0U)
+			gicd_write_isenabler(base, id, isenabler[i]);
+	}
+}
+
 /*******************************************************************************
  * GIC Distributor interface accessors for individual interrupt manipulation
  ******************************************************************************/
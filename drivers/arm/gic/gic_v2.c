@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -22,13 +22,47 @@
  */
 struct gicv2_pcpu_ctx {
 	unsigned int gicc_ctlr;
-	unsigned int gicd_isenabler0;
-	unsigned int gicd_ipriorityr[NUM_PCPU_INTR >> IPRIORITYR_SHIFT];
-	unsigned int gicd_icfgr;
+	/* SGIs and PPIs configured by the framework on this CPU */
+	uint32_t gicd_configured[GIC_CTX_ISENABLER_NUM(NUM_PCPU_INTR)];
+	uint32_t gicd_isenabler[GIC_CTX_ISENABLER_NUM(NUM_PCPU_INTR)];
+	uint32_t gicd_ipriorityr[GIC_CTX_IPRIORITYR_NUM(NUM_PCPU_INTR)];
+	uint32_t gicd_icfgr[GIC_CTX_ICFGR_NUM(NUM_PCPU_INTR)];
 };
 
 static struct gicv2_pcpu_ctx pcpu_gic_ctx[PLATFORM_CORE_COUNT];
 
+/*
+ * Context of the SPIs that the framework can handle, saved before system
+ * suspend. The number of SPIs saved is capped to the ones the GIC implements.
+ */
+#define NUM_SPI_CTX	(PLAT_MAX_SPI_OFFSET_ID + 1)
+
+static struct {
+	unsigned int num_spi;
+	/* SPIs configured by the framework */
+	uint32_t gicd_configured[GIC_CTX_ISENABLER_NUM(NUM_SPI_CTX)];
+	uint32_t gicd_isenabler[GIC_CTX_ISENABLER_NUM(NUM_SPI_CTX)];
+	uint32_t gicd_ipriorityr[GIC_CTX_IPRIORITYR_NUM(NUM_SPI_CTX)];
+	uint32_t gicd_icfgr[GIC_CTX_ICFGR_NUM(NUM_SPI_CTX)];
+	/* ITARGETSR has the same layout as IPRIORITYR */
+	uint32_t gicd_itargetsr[GIC_CTX_IPRIORITYR_NUM(NUM_SPI_CTX)];
+} spi_ctx;
+
+/* Record that interrupt #interrupt_id is configured, if its context is saved */
+static void set_intr_configured(unsigned int interrupt_id)
+{
+	unsigned int core_pos;
+
+	if (interrupt_id < MIN_SPI_ID) {
+		core_pos = platform_get_core_pos(read_mpidr_el1());
+		gicd_ctx_set_configured(pcpu_gic_ctx[core_pos].gicd_configured,
+					interrupt_id);
+	} else if ((interrupt_id - MIN_SPI_ID) < NUM_SPI_CTX) {
+		gicd_ctx_set_configured(spi_ctx.gicd_configured,
+					interrupt_id - MIN_SPI_ID);
+	}
+}
+
 static uintptr_t gicc_base_addr;
 static uintptr_t gicd_base_addr;
 
@@ -195,40 +229,85 @@ void gicv2_setup_distif(void)
 /* Save the per-cpu GICD ISENABLER, IPRIORITYR and ICFGR registers */
 void gicv2_save_sgi_ppi_context(void)
 {
-	unsigned int i;
 	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
 
 	assert(gicd_base_addr);
-	pcpu_gic_ctx[core_pos].gicd_isenabler0 =
-				gicd_read_isenabler(gicd_base_addr, 0);
-
-	/* Read the ipriority registers, 4 at a time */
-	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++)
-		pcpu_gic_ctx[core_pos].gicd_ipriorityr[i] =
-			gicd_read_ipriorityr(gicd_base_addr, i << IPRIORITYR_SHIFT);
 
-	pcpu_gic_ctx[core_pos].gicd_icfgr =
-			gicd_read_icfgr(gicd_base_addr, MIN_PPI_ID);
+	gicd_save_intr_ctx(gicd_base_addr, MIN_SGI_ID, NUM_PCPU_INTR,
+			   pcpu_gic_ctx[core_pos].gicd_configured,
+			   pcpu_gic_ctx[core_pos].gicd_isenabler,
+			   pcpu_gic_ctx[core_pos].gicd_ipriorityr,
+			   pcpu_gic_ctx[core_pos].gicd_icfgr);
 }
 
 /* Restore the per-cpu GICD ISENABLER, IPRIORITYR and ICFGR registers */
 void gicv2_restore_sgi_ppi_context(void)
 {
-	unsigned int i;
 	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
 
 	assert(gicd_base_addr);
 
-	/* Write the ipriority registers, 4 at a time */
-	for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++)
-		gicd_write_ipriorityr(gicd_base_addr, i << IPRIORITYR_SHIFT,
-			pcpu_gic_ctx[core_pos].gicd_ipriorityr[i]);
+	gicd_restore_intr_ctx(gicd_base_addr, MIN_SGI_ID, NUM_PCPU_INTR,
+			      pcpu_gic_ctx[core_pos].gicd_configured,
+			      pcpu_gic_ctx[core_pos].gicd_isenabler,
+			      pcpu_gic_ctx[core_pos].gicd_ipriorityr,
+			      pcpu_gic_ctx[core_pos].gicd_icfgr);
+}
+
+void gicv2_save_spi_context(void)
+{
+	unsigned int i, j, configured;
+
+	assert(gicd_base_addr);
+
+	spi_ctx.num_spi = GICD_TYPER_NUM_INTR(gicd_read_typer(gicd_base_addr)) -
+			  MIN_SPI_ID;
+	if (spi_ctx.num_spi > NUM_SPI_CTX)
+		spi_ctx.num_spi = NUM_SPI_CTX;
 
-	gicd_write_icfgr(gicd_base_addr, MIN_PPI_ID,
-			pcpu_gic_ctx[core_pos].gicd_icfgr);
+	gicd_save_intr_ctx(gicd_base_addr, MIN_SPI_ID, spi_ctx.num_spi,
+			   spi_ctx.gicd_configured, spi_ctx.gicd_isenabler,
+			   spi_ctx.gicd_ipriorityr, spi_ctx.gicd_icfgr);
 
-	gicd_write_isenabler(gicd_base_addr, 0,
-			pcpu_gic_ctx[core_pos].gicd_isenabler0);
+	/* Only the targets of the configured SPIs are saved, 4 at a time */
+	for (i = 0; i < GIC_CTX_ISENABLER_NUM(spi_ctx.num_spi); i++) {
+		configured = spi_ctx.gicd_configured[i];
+		for (j = 0; j < 8; j++) {
+			if (((configured >> (j << 2)) & 0xf) == 0)
+				continue;
+			spi_ctx.gicd_itargetsr[(i << 3) + j] =
+				gicd_read_itargetsr(gicd_base_addr, MIN_SPI_ID +
+					(i << ISENABLER_SHIFT) + (j << 2));
+		}
+	}
+}
+
+void gicv2_restore_spi_context(void)
+{
+	unsigned int i, j, configured;
+
+	assert(gicd_base_addr);
+
+	/* The targets must be in place before the SPIs are enabled */
+	for (i = 0; i < GIC_CTX_ISENABLER_NUM(spi_ctx.num_spi); i++) {
+		configured = spi_ctx.gicd_configured[i];
+		for (j = 0; j < 8; j++) {
+			if (((configured >> (j << 2)) & 0xf) == 0)
+				continue;
+			gicd_write_itargetsr(gicd_base_addr, MIN_SPI_ID +
+					(i << ISENABLER_SHIFT) + (j << 2),
+					spi_ctx.gicd_itargetsr[(i << 3) + j]);
+		}
+	}
+
+	gicd_restore_intr_ctx(gicd_base_addr, MIN_SPI_ID, spi_ctx.num_spi,
+			      spi_ctx.gicd_configured, spi_ctx.gicd_isenabler,
+			      spi_ctx.gicd_ipriorityr, spi_ctx.gicd_icfgr);
+}
+
+uintptr_t gicv2_get_gicd_base(void)
+{
+	return gicd_base_addr;
 }
 
 unsigned int gicv2_gicd_get_ipriorityr(unsigned int interrupt_id)
@@ -246,6 +325,7 @@ void gicv2_gicd_set_ipriorityr(unsigned int interrupt_id,
 	assert(IS_VALID_INTR_ID(interrupt_id));
 
 	gicd_set_ipriorityr(gicd_base_addr, interrupt_id, priority);
+	set_intr_configured(interrupt_id);
 }
 
 void gicv2_send_sgi(unsigned int sgi_id, unsigned int core_pos)
@@ -261,6 +341,41 @@ void gicv2_send_sgi(unsigned int sgi_id, unsigned int core_pos)
 	gicd_write_sgir(gicd_base_addr, sgir_val);
 }
 
+void gicv2_send_sgi_mask(unsigned int sgi_id, const core_mask_t *mask)
+{
+	unsigned int sgir_val, target_list = 0;
+
+	assert(gicd_base_addr);
+	assert(IS_SGI(sgi_id));
+
+	for (unsigned int core_pos = 0; core_pos < PLATFORM_CORE_COUNT;
+	     core_pos++) {
+		if (core_mask_test(mask, core_pos))
+			target_list |= 1 << core_pos_to_gic_id(core_pos);
+	}
+
+	if (target_list == 0)
+		return;
+
+	sgir_val = sgi_id << GICD_SGIR_INTID_SHIFT;
+	sgir_val |= target_list << GICD_SGIR_CPUTL_SHIFT;
+
+	gicd_write_sgir(gicd_base_addr, sgir_val);
+}
+
+void gicv2_send_sgi_all_but_self(unsigned int sgi_id)
+{
+	unsigned int sgir_val;
+
+	assert(gicd_base_addr);
+	assert(IS_SGI(sgi_id));
+
+	sgir_val = sgi_id << GICD_SGIR_INTID_SHIFT;
+	sgir_val |= GICD_SGIR_TLF_ALL_BUT_SELF << GICD_SGIR_TLF_SHIFT;
+
+	gicd_write_sgir(gicd_base_addr, sgir_val);
+}
+
 void gicv2_set_itargetsr(unsigned int num, unsigned int core_pos)
 {
 	unsigned int gic_cpu_id;
@@ -269,6 +384,7 @@ void gicv2_set_itargetsr(unsigned int num, unsigned int core_pos)
 
 	gic_cpu_id = core_pos_to_gic_id(core_pos);
 	gicd_set_itargetsr(gicd_base_addr, num, gic_cpu_id);
+	set_intr_configured(num);
 }
 
 uint8_t gicv2_read_itargetsr_value(unsigned int num)
@@ -282,6 +398,7 @@ void gicv2_set_itargetsr_value(unsigned int num, unsigned int val)
 	assert(IS_SPI(num));
 
 	gicd_write_itargetsr_byte(gicd_base_addr, num, val);
+	set_intr_configured(num);
 
 	assert(gicv2_read_itargetsr_value(num) == val);
 }
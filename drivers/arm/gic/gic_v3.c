@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -37,14 +37,40 @@ struct gicv3_pcpu_ctx {
 	/* Flag to indicate whether the CPU is suspended */
 	unsigned int is_suspended;
 	unsigned int icc_igrpen1;
-	unsigned int gicr_isenabler;
-	unsigned int gicr_ipriorityr[NUM_PCPU_INTR >> IPRIORITYR_SHIFT];
-	unsigned int gicr_icfgr;
+	/* SGIs and PPIs configured by the framework on this CPU */
+	uint32_t gicr_configured[GIC_CTX_ISENABLER_NUM(NUM_PCPU_INTR)];
+	uint32_t gicr_isenabler[GIC_CTX_ISENABLER_NUM(NUM_PCPU_INTR)];
+	uint32_t gicr_ipriorityr[GIC_CTX_IPRIORITYR_NUM(NUM_PCPU_INTR)];
+	uint32_t gicr_icfgr[GIC_CTX_ICFGR_NUM(NUM_PCPU_INTR)];
 };
 
 /* Array to store the per-cpu GICv3 context when being suspended.*/
 static struct gicv3_pcpu_ctx pcpu_ctx[PLATFORM_CORE_COUNT];
 
+/*
+ * Context of the SPIs that the framework can handle, saved before system
+ * suspend. The number of SPIs saved is capped to the ones the GIC implements.
+ */
+#define NUM_SPI_CTX	(PLAT_MAX_SPI_OFFSET_ID + 1)
+
+static struct {
+	unsigned int num_spi;
+	/* SPIs configured by the framework */
+	uint32_t gicd_configured[GIC_CTX_ISENABLER_NUM(NUM_SPI_CTX)];
+	uint32_t gicd_isenabler[GIC_CTX_ISENABLER_NUM(NUM_SPI_CTX)];
+	uint32_t gicd_ipriorityr[GIC_CTX_IPRIORITYR_NUM(NUM_SPI_CTX)];
+	uint32_t gicd_icfgr[GIC_CTX_ICFGR_NUM(NUM_SPI_CTX)];
+	unsigned long long gicd_irouter[GIC_CTX_ISENABLER_NUM(NUM_SPI_CTX) * 32];
+} spi_ctx;
+
+/* Record that SPI #interrupt_id is configured, if its context is saved */
+static void set_spi_configured(unsigned int interrupt_id)
+{
+	if ((interrupt_id - MIN_SPI_ID) < NUM_SPI_CTX)
+		gicd_ctx_set_configured(spi_ctx.gicd_configured,
+					interrupt_id - MIN_SPI_ID);
+}
+
 /* Array to store the per-cpu redistributor frame addresses */
 static uintptr_t rdist_pcpu_base[PLATFORM_CORE_COUNT];
 
@@ -65,6 +91,13 @@ static void gicd_write_irouter(uintptr_t base,
 	mmio_write_64(base + GICD_IROUTER + (interrupt_id << 3), route);
 }
 
+static unsigned long long gicd_read_irouter(uintptr_t base,
+					    unsigned int interrupt_id)
+{
+	assert(interrupt_id >= MIN_SPI_ID);
+	return mmio_read_64(base + GICD_IROUTER + (interrupt_id << 3));
+}
+
 /******************************************************************************
  * GIC Re-distributor interface accessors for writing entire registers
  *****************************************************************************/
@@ -78,20 +111,14 @@ static void gicr_write_icenabler0(uintptr_t base, unsigned int val)
 	mmio_write_32(base + GICR_ICENABLER0, val);
 }
 
-static void gicr_write_icpendr0(uintptr_t base, unsigned int val)
-{
-	mmio_write_32(base + GICR_ICPENDR0, val);
-}
-
-static void gicr_write_ipriorityr(uintptr_t base, unsigned int id, unsigned int val)
+static void gicr_write_ispendr0(uintptr_t base, unsigned int val)
 {
-	unsigned n = id >> IPRIORITYR_SHIFT;
-	mmio_write_32(base + GICR_IPRIORITYR + (n << 2), val);
+	mmio_write_32(base + GICR_ISPENDR0, val);
 }
 
-static void gicr_write_icfgr1(uintptr_t base, unsigned int val)
+static void gicr_write_icpendr0(uintptr_t base, unsigned int val)
 {
-	mmio_write_32(base + GICR_ICFGR1, val);
+	mmio_write_32(base + GICR_ICPENDR0, val);
 }
 
 /******************************************************************************
@@ -102,22 +129,11 @@ static unsigned long long gicr_read_typer(uintptr_t base)
 	return mmio_read_64(base + GICR_TYPER);
 }
 
-static unsigned int gicr_read_icfgr1(uintptr_t base)
-{
-	return mmio_read_32(base + GICR_ICFGR1);
-}
-
 static unsigned int gicr_read_isenabler0(uintptr_t base)
 {
 	return mmio_read_32(base + GICR_ISENABLER0);
 }
 
-static unsigned int gicr_read_ipriorityr(uintptr_t base, unsigned int id)
-{
-	unsigned n = id >> IPRIORITYR_SHIFT;
-	return mmio_read_32(base + GICR_IPRIORITYR + (n << 2));
-}
-
 static unsigned int gicr_read_ispendr0(uintptr_t base)
 {
 	return mmio_read_32(base + GICR_ISPENDR0);
@@ -146,6 +162,12 @@ static void gicr_set_icenabler0(uintptr_t base, unsigned int interrupt_id)
 	gicr_write_icenabler0(base, (1 << bit_num));
 }
 
+static void gicr_set_ispendr0(uintptr_t base, unsigned int interrupt_id)
+{
+	unsigned bit_num = interrupt_id & ((1 << ISPENDR_SHIFT) - 1);
+	gicr_write_ispendr0(base, (1 << bit_num));
+}
+
 static void gicr_set_icpendr0(uintptr_t base, unsigned int interrupt_id)
 {
 	unsigned bit_num = interrupt_id & ((1 << ICPENDR_SHIFT) - 1);
@@ -204,7 +226,7 @@ void gicv3_restore_cpuif_context(void)
 
 void gicv3_save_sgi_ppi_context(void)
 {
-	unsigned int i, core_pos;
+	unsigned int core_pos;
 	unsigned int my_core_pos = platform_get_core_pos(read_mpidr_el1());
 
 	/* Save the context for all the suspended cores */
@@ -219,23 +241,20 @@ void gicv3_save_sgi_ppi_context(void)
 
 		assert(rdist_pcpu_base[core_pos]);
 
-		pcpu_ctx[core_pos].gicr_isenabler =
-					gicr_read_isenabler0(rdist_pcpu_base[core_pos]);
-
-		/* Read the ipriority registers, 4 at a time */
-		for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++)
-			pcpu_ctx[core_pos].gicr_ipriorityr[i] =
-				gicr_read_ipriorityr(rdist_pcpu_base[core_pos],
-						i << IPRIORITYR_SHIFT);
-
-		pcpu_ctx[core_pos].gicr_icfgr =
-				gicr_read_icfgr1(rdist_pcpu_base[core_pos]);
+		/* The SGI frame has the layout of the Distributor */
+		gicd_save_intr_ctx(
+			rdist_pcpu_base[core_pos] + GICR_SGIBASE_OFFSET,
+			MIN_SGI_ID, NUM_PCPU_INTR,
+			pcpu_ctx[core_pos].gicr_configured,
+			pcpu_ctx[core_pos].gicr_isenabler,
+			pcpu_ctx[core_pos].gicr_ipriorityr,
+			pcpu_ctx[core_pos].gicr_icfgr);
 	}
 }
 
 void gicv3_restore_sgi_ppi_context(void)
 {
-	unsigned int i, core_pos;
+	unsigned int core_pos;
 	unsigned int my_core_pos = platform_get_core_pos(read_mpidr_el1());
 
 	/* Restore the context for all the suspended cores */
@@ -250,17 +269,65 @@ void gicv3_restore_sgi_ppi_context(void)
 
 		assert(rdist_pcpu_base[core_pos]);
 
-		/* Read the ipriority registers, 4 at a time */
-		for (i = 0; i < (NUM_PCPU_INTR >> IPRIORITYR_SHIFT); i++)
-			gicr_write_ipriorityr(rdist_pcpu_base[core_pos],
-					i << IPRIORITYR_SHIFT,
-					pcpu_ctx[core_pos].gicr_ipriorityr[i]);
+		gicd_restore_intr_ctx(
+			rdist_pcpu_base[core_pos] + GICR_SGIBASE_OFFSET,
+			MIN_SGI_ID, NUM_PCPU_INTR,
+			pcpu_ctx[core_pos].gicr_configured,
+			pcpu_ctx[core_pos].gicr_isenabler,
+			pcpu_ctx[core_pos].gicr_ipriorityr,
+			pcpu_ctx[core_pos].gicr_icfgr);
+	}
+}
+
+void gicv3_save_spi_context(void)
+{
+	unsigned int i, configured;
+
+	assert(gicd_base_addr);
+
+	spi_ctx.num_spi = GICD_TYPER_NUM_INTR(gicd_read_typer(gicd_base_addr)) -
+			  MIN_SPI_ID;
+	if (spi_ctx.num_spi > NUM_SPI_CTX)
+		spi_ctx.num_spi = NUM_SPI_CTX;
+
+	gicd_save_intr_ctx(gicd_base_addr, MIN_SPI_ID, spi_ctx.num_spi,
+			   spi_ctx.gicd_configured, spi_ctx.gicd_isenabler,
+			   spi_ctx.gicd_ipriorityr, spi_ctx.gicd_icfgr);
+
+	/* Only the route of the configured SPIs is saved */
+	for (i = 0; i < GIC_CTX_ISENABLER_NUM(spi_ctx.num_spi); i++) {
+		for (configured = spi_ctx.gicd_configured[i]; configured != 0;
+		     configured &= configured - 1) {
+			unsigned int n = (i << ISENABLER_SHIFT) +
+					 __builtin_ctz(configured);
+
+			spi_ctx.gicd_irouter[n] = gicd_read_irouter(
+					gicd_base_addr, MIN_SPI_ID + n);
+		}
+	}
+}
+
+void gicv3_restore_spi_context(void)
+{
+	unsigned int i, configured;
+
+	assert(gicd_base_addr);
+
+	/* The routes must be in place before the SPIs are enabled */
+	for (i = 0; i < GIC_CTX_ISENABLER_NUM(spi_ctx.num_spi); i++) {
+		for (configured = spi_ctx.gicd_configured[i]; configured != 0;
+		     configured &= configured - 1) {
+			unsigned int n = (i << ISENABLER_SHIFT) +
+					 __builtin_ctz(configured);
 
-		gicr_write_icfgr1(rdist_pcpu_base[core_pos],
-				pcpu_ctx[core_pos].gicr_icfgr);
-		gicr_write_isenabler0(rdist_pcpu_base[core_pos],
-				pcpu_ctx[core_pos].gicr_isenabler);
+			gicd_write_irouter(gicd_base_addr, MIN_SPI_ID + n,
+					   spi_ctx.gicd_irouter[n]);
+		}
 	}
+
+	gicd_restore_intr_ctx(gicd_base_addr, MIN_SPI_ID, spi_ctx.num_spi,
+			      spi_ctx.gicd_configured, spi_ctx.gicd_isenabler,
+			      spi_ctx.gicd_ipriorityr, spi_ctx.gicd_icfgr);
 }
 
 unsigned int gicv3_get_ipriorityr(unsigned int interrupt_id)
@@ -292,52 +359,116 @@ void gicv3_set_ipriorityr(unsigned int interrupt_id,
 		assert(rdist_pcpu_base[core_pos]);
 		mmio_write_8(rdist_pcpu_base[core_pos] + GICR_IPRIORITYR
 				+ interrupt_id, priority & GIC_PRI_MASK);
+		gicd_ctx_set_configured(pcpu_ctx[core_pos].gicr_configured,
+					interrupt_id);
 	} else {
 		mmio_write_8(gicd_base_addr + GICD_IPRIORITYR + interrupt_id,
 					priority & GIC_PRI_MASK);
+		set_spi_configured(interrupt_id);
 	}
 }
 
-void gicv3_send_sgi(unsigned int sgi_id, unsigned int core_pos)
+/*
+ * Return the affinity fields of ICC_SGI1R that select the cluster of the core
+ * with MPIDR `mpidr`.
+ */
+static unsigned long long sgi1r_cluster_affinity(unsigned long long mpidr)
 {
-	unsigned long long aff0, aff1, aff2;
-	unsigned long long sgir, target_list;
-
-	assert(IS_SGI(sgi_id));
-	assert(core_pos < PLATFORM_CORE_COUNT);
-
-	assert(mpidr_list[core_pos] != UINT64_MAX);
+	unsigned long long sgir;
 
-	/* Extract the affinity information */
-	aff0 = MPIDR_AFF_ID(mpidr_list[core_pos], 0);
-	aff1 = MPIDR_AFF_ID(mpidr_list[core_pos], 1);
-	aff2 = MPIDR_AFF_ID(mpidr_list[core_pos], 2);
+	sgir = ((MPIDR_AFF_ID(mpidr, 2) & SGI1R_AFF_MASK) << SGI1R_AFF2_SHIFT) |
+	       ((MPIDR_AFF_ID(mpidr, 1) & SGI1R_AFF_MASK) << SGI1R_AFF1_SHIFT);
 #ifdef __aarch64__
-	unsigned long long aff3;
-	aff3 = MPIDR_AFF_ID(mpidr_list[core_pos], 3);
+	sgir |= (MPIDR_AFF_ID(mpidr, 3) & SGI1R_AFF_MASK) << SGI1R_AFF3_SHIFT;
 #endif
 
-	/* Construct the SGI target list using Affinity 0 */
-	assert(aff0 < SGI_TARGET_MAX_AFF0);
-	target_list = 1 << aff0;
+	return sgir;
+}
 
-	/* Construct the SGI target affinity */
-	sgir =
-#ifdef __aarch64__
-		((aff3 & SGI1R_AFF_MASK) << SGI1R_AFF3_SHIFT) |
-#endif
-		((aff2 & SGI1R_AFF_MASK) << SGI1R_AFF2_SHIFT) |
-		((aff1 & SGI1R_AFF_MASK) << SGI1R_AFF1_SHIFT) |
-		((target_list & SGI1R_TARGET_LIST_MASK)
-				<< SGI1R_TARGET_LIST_SHIFT);
+/* Return the bit of the core with MPIDR `mpidr` in the SGI target list */
+static unsigned long long sgi1r_target(unsigned long long mpidr)
+{
+	unsigned long long aff0 = MPIDR_AFF_ID(mpidr, 0);
 
-	/* Combine SGI target affinity with the SGI ID */
-	sgir |= ((sgi_id & SGI1R_INTID_MASK) << SGI1R_INTID_SHIFT);
+	assert(aff0 < SGI_TARGET_MAX_AFF0);
+	return (1ULL << aff0) << SGI1R_TARGET_LIST_SHIFT;
+}
+
+static void write_sgi1r(unsigned long long sgir)
+{
 #ifdef __aarch64__
 	write_icc_sgi1r(sgir);
 #else
 	write64_icc_sgi1r(sgir);
 #endif
+}
+
+void gicv3_send_sgi(unsigned int sgi_id, unsigned int core_pos)
+{
+	unsigned long long sgir;
+
+	assert(IS_SGI(sgi_id));
+	assert(core_pos < PLATFORM_CORE_COUNT);
+
+	assert(mpidr_list[core_pos] != UINT64_MAX);
+
+	/* Construct the SGI target affinity and target list */
+	sgir = sgi1r_cluster_affinity(mpidr_list[core_pos]) |
+	       sgi1r_target(mpidr_list[core_pos]);
+
+	/* Combine SGI target affinity with the SGI ID */
+	sgir |= ((sgi_id & SGI1R_INTID_MASK) << SGI1R_INTID_SHIFT);
+	write_sgi1r(sgir);
+	isb();
+}
+
+void gicv3_send_sgi_mask(unsigned int sgi_id, const core_mask_t *mask)
+{
+	unsigned long long cluster = 0, cluster_sgir;
+	unsigned long long target_list = 0;
+	unsigned long long intid;
+
+	assert(IS_SGI(sgi_id));
+
+	intid = (sgi_id & SGI1R_INTID_MASK) << SGI1R_INTID_SHIFT;
+
+	/*
+	 * The cores of a cluster usually have consecutive positions, so the
+	 * target list is written out whenever the cluster changes. Cores of a
+	 * cluster that are not next to each other only cost extra writes.
+	 */
+	for (unsigned int core_pos = 0; core_pos < PLATFORM_CORE_COUNT;
+	     core_pos++) {
+		if (mask->bits[core_pos / 64] == 0) {
+			core_pos |= 63;
+			continue;
+		}
+		if (!core_mask_test(mask, core_pos))
+			continue;
+
+		assert(mpidr_list[core_pos] != UINT64_MAX);
+
+		cluster_sgir = sgi1r_cluster_affinity(mpidr_list[core_pos]);
+		if ((target_list != 0) && (cluster_sgir != cluster)) {
+			write_sgi1r(cluster | target_list | intid);
+			target_list = 0;
+		}
+
+		cluster = cluster_sgir;
+		target_list |= sgi1r_target(mpidr_list[core_pos]);
+	}
+
+	if (target_list != 0)
+		write_sgi1r(cluster | target_list | intid);
+	isb();
+}
+
+void gicv3_send_sgi_all_but_self(unsigned int sgi_id)
+{
+	assert(IS_SGI(sgi_id));
+
+	write_sgi1r(((unsigned long long)SGI1R_IRM_MASK << SGI1R_IRM_SHIFT) |
+		    ((sgi_id & SGI1R_INTID_MASK) << SGI1R_INTID_SHIFT));
 	isb();
 }
 
@@ -355,6 +486,7 @@ void gicv3_set_intr_route(unsigned int interrupt_id,
 	route_affinity = mpidr_list[core_pos];
 
 	gicd_write_irouter(gicd_base_addr, interrupt_id, route_affinity);
+	set_spi_configured(interrupt_id);
 }
 
 unsigned int gicv3_get_isenabler(unsigned int interrupt_id)
@@ -421,6 +553,21 @@ unsigned int gicv3_get_ispendr(unsigned int interrupt_id)
 	return !!(ispendr & (1 << bit_pos));
 }
 
+void gicv3_set_ispendr(unsigned int interrupt_id)
+{
+	unsigned int core_pos;
+
+	assert(gicd_base_addr);
+	assert(IS_SPI(interrupt_id) || IS_PPI(interrupt_id));
+
+	if (interrupt_id < MIN_SPI_ID) {
+		core_pos = platform_get_core_pos(read_mpidr_el1());
+		assert(rdist_pcpu_base[core_pos]);
+		gicr_set_ispendr0(rdist_pcpu_base[core_pos], interrupt_id);
+	} else
+		gicd_set_ispendr(gicd_base_addr, interrupt_id);
+}
+
 void gicv3_set_icpendr(unsigned int interrupt_id)
 {
 	unsigned int core_pos;
@@ -437,6 +584,17 @@ void gicv3_set_icpendr(unsigned int interrupt_id)
 		gicd_set_icpendr(gicd_base_addr, interrupt_id);
 }
 
+uintptr_t gicv3_get_gicd_base(void)
+{
+	return gicd_base_addr;
+}
+
+uintptr_t gicv3_get_rdist_base(unsigned int core_pos)
+{
+	assert(core_pos < PLATFORM_CORE_COUNT);
+	return rdist_pcpu_base[core_pos];
+}
+
 void gicv3_probe_redistif_addr(void)
 {
 	unsigned long long typer_val;
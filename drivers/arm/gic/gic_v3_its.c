@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <drivers/arm/arm_gic.h>
+#include <drivers/arm/gic_v3.h>
+#include <drivers/arm/gic_v3_its.h>
+#include <mmio.h>
+#include <platform.h>
+#include <spinlock.h>
+#include <stdbool.h>
+#include <string.h>
+#include <utils_def.h>
+
+/*
+ * All the tables are in static memory, which the framework maps flat. They are
+ * given to the GIC as Normal Non-cacheable memory, so the cores clean them to
+ * the point of coherency after writing to them.
+ */
+#define ITS_PAGE_SIZE		0x1000
+#define ITS_CMD_SIZE		32
+#define ITS_CMD_QUEUE_SIZE	ITS_PAGE_SIZE
+
+/* Largest ITT entry supported, in bytes */
+#define ITS_MAX_ITT_ENTRY_SIZE	16
+#define ITS_ITT_SIZE		(ITS_MAX_ITT_ENTRY_SIZE << ITS_EVENT_ID_BITS)
+#define ITS_ITT_ALIGN		256
+
+/* One byte of configuration per LPI, one bit of pending state per INTID */
+#define LPI_PROP_TABLE_SIZE	((1U << LPI_ID_BITS) - MIN_LPI_ID)
+#define LPI_PEND_TABLE_SIZE	((1U << LPI_ID_BITS) >> 3)
+#define LPI_PEND_TABLE_ALIGN	0x10000
+
+/* Time given to the ITS to process commands or to become quiescent */
+#define ITS_TIMEOUT_MS		100
+
+/* ITS command encodings */
+#define ITS_CMD_SYNC		0x05
+#define ITS_CMD_MAPD		0x08
+#define ITS_CMD_MAPC		0x09
+#define ITS_CMD_MAPTI		0x0a
+#define ITS_CMD_INV		0x0c
+#define ITS_CMD_DISCARD		0x0f
+
+#define ITS_CMD_VALID		(1ULL << 63)
+#define ITS_CMD_ITT_ADDR_MASK	0xfffffffffff00ULL
+#define ITS_CMD_RDBASE_SHIFT	16
+
+typedef struct {
+	uint64_t dw[ITS_CMD_SIZE >> 3];
+} its_cmd_t;
+
+static uint64_t its_cmd_queue[ITS_CMD_QUEUE_SIZE >> 3] __aligned(ITS_PAGE_SIZE);
+static uint8_t its_device_table[ITS_PAGE_SIZE] __aligned(ITS_PAGE_SIZE);
+static uint8_t its_collection_table[ITS_PAGE_SIZE] __aligned(ITS_PAGE_SIZE);
+static uint8_t its_itt[ITS_MAX_DEVICES][ITS_ITT_SIZE] __aligned(ITS_ITT_ALIGN);
+static uint8_t lpi_prop_table[LPI_PROP_TABLE_SIZE] __aligned(ITS_PAGE_SIZE);
+
+/*
+ * The pending table of a Re-distributor must be 64KB aligned, although it only
+ * takes LPI_PEND_TABLE_SIZE bytes.
+ */
+static struct {
+	uint8_t bits[LPI_PEND_TABLE_SIZE];
+} __aligned(LPI_PEND_TABLE_ALIGN) lpi_pend_table[PLATFORM_CORE_COUNT];
+
+/* Target of the commands for the collection of each core */
+static struct {
+	uint64_t rdbase;
+	bool mapped;
+} its_collection[PLATFORM_CORE_COUNT];
+
+/* Core that each LPI is routed to */
+static unsigned int lpi_core_pos[MAX_LPI_NUM];
+
+static uintptr_t its_base_addr;
+static uint64_t its_typer;
+static unsigned int its_cmd_offset;
+static spinlock_t its_lock;
+
+static uint64_t its_timeout(void)
+{
+	return syscounter_read() + (read_cntfrq_el0() * ITS_TIMEOUT_MS) / 1000;
+}
+
+static int its_wait_for_quiescent(void)
+{
+	uint64_t timeout = its_timeout();
+
+	while ((mmio_read_32(its_base_addr + GITS_CTLR) &
+		GITS_CTLR_QUIESCENT) == 0U) {
+		if (syscounter_read() > timeout)
+			return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Write `num` commands to the queue and wait for the ITS to process them.
+ * The queue is empty when this function is entered.
+ */
+static int its_send_cmds(const its_cmd_t *cmds, unsigned int num)
+{
+	uint64_t creadr, timeout;
+	unsigned int i;
+	int ret = 0;
+
+	assert(its_base_addr != 0U);
+	assert(num < (ITS_CMD_QUEUE_SIZE / ITS_CMD_SIZE));
+
+	spin_lock(&its_lock);
+
+	for (i = 0; i < num; i++) {
+		memcpy(&its_cmd_queue[its_cmd_offset >> 3], &cmds[i],
+		       ITS_CMD_SIZE);
+		clean_dcache_range((uintptr_t)&its_cmd_queue[its_cmd_offset >> 3],
+				   ITS_CMD_SIZE);
+		its_cmd_offset = (its_cmd_offset + ITS_CMD_SIZE) %
+				 ITS_CMD_QUEUE_SIZE;
+	}
+
+	mmio_write_64(its_base_addr + GITS_CWRITER, its_cmd_offset);
+
+	timeout = its_timeout();
+	do {
+		creadr = mmio_read_64(its_base_addr + GITS_CREADR);
+		if ((creadr & GITS_CREADR_STALLED) != 0U) {
+			ERROR("ITS: command queue stalled at offset 0x%llx\n",
+			      (unsigned long long)(creadr & GITS_CMD_OFFSET_MASK));
+			ret = -1;
+			break;
+		}
+		if (syscounter_read() > timeout) {
+			ERROR("ITS: timeout processing commands\n");
+			ret = -1;
+			break;
+		}
+	} while ((creadr & GITS_CMD_OFFSET_MASK) != its_cmd_offset);
+
+	spin_unlock(&its_lock);
+
+	return ret;
+}
+
+static void its_cmd_mapd(its_cmd_t *cmd, uint32_t device_id, uintptr_t itt)
+{
+	cmd->dw[0] = ITS_CMD_MAPD | ((uint64_t)device_id << 32);
+	cmd->dw[1] = ITS_EVENT_ID_BITS - 1;
+	cmd->dw[2] = ITS_CMD_VALID | (itt & ITS_CMD_ITT_ADDR_MASK);
+	cmd->dw[3] = 0;
+}
+
+static void its_cmd_mapc(its_cmd_t *cmd, unsigned int icid, uint64_t rdbase)
+{
+	cmd->dw[0] = ITS_CMD_MAPC;
+	cmd->dw[1] = 0;
+	cmd->dw[2] = ITS_CMD_VALID | (rdbase << ITS_CMD_RDBASE_SHIFT) | icid;
+	cmd->dw[3] = 0;
+}
+
+static void its_cmd_mapti(its_cmd_t *cmd, uint32_t device_id,
+			  uint32_t event_id, unsigned int lpi, unsigned int icid)
+{
+	cmd->dw[0] = ITS_CMD_MAPTI | ((uint64_t)device_id << 32);
+	cmd->dw[1] = event_id | ((uint64_t)lpi << 32);
+	cmd->dw[2] = icid;
+	cmd->dw[3] = 0;
+}
+
+/* Commands that only take a DeviceID and an EventID */
+static void its_cmd_event(its_cmd_t *cmd, unsigned int cmd_id,
+			  uint32_t device_id, uint32_t event_id)
+{
+	cmd->dw[0] = cmd_id | ((uint64_t)device_id << 32);
+	cmd->dw[1] = event_id;
+	cmd->dw[2] = 0;
+	cmd->dw[3] = 0;
+}
+
+static void its_cmd_sync(its_cmd_t *cmd, uint64_t rdbase)
+{
+	cmd->dw[0] = ITS_CMD_SYNC;
+	cmd->dw[1] = 0;
+	cmd->dw[2] = rdbase << ITS_CMD_RDBASE_SHIFT;
+	cmd->dw[3] = 0;
+}
+
+/*
+ * Give `table` to the ITS as the table of GITS_BASER<n>, if it holds enough
+ * entries for the IDs below `num_ids`.
+ */
+static int its_setup_baser(unsigned int n, uintptr_t table,
+			   unsigned int num_ids)
+{
+	uint64_t baser = mmio_read_64(its_base_addr + GITS_BASER(n));
+	unsigned int entry_size = ((baser >> GITS_BASER_ENTRY_SIZE_SHIFT) &
+				   GITS_BASER_ENTRY_SIZE_MASK) + 1U;
+
+	if ((entry_size * num_ids) > ITS_PAGE_SIZE) {
+		ERROR("ITS: GITS_BASER%u entries of %u bytes are too large\n",
+		      n, entry_size);
+		return -1;
+	}
+
+	/* A single 4KB page, flat table */
+	baser = GITS_BASER_VALID |
+		(GIC_BASER_CACHE_NC << GITS_BASER_INNER_CACHE_SHIFT) |
+		(table & GIC_BASER_PA_MASK) |
+		(GITS_BASER_PAGE_SIZE_4K << GITS_BASER_PAGE_SIZE_SHIFT);
+	mmio_write_64(its_base_addr + GITS_BASER(n), baser);
+
+	baser = mmio_read_64(its_base_addr + GITS_BASER(n));
+	if (((baser >> GITS_BASER_PAGE_SIZE_SHIFT) &
+	     GITS_BASER_PAGE_SIZE_MASK) != GITS_BASER_PAGE_SIZE_4K) {
+		ERROR("ITS: GITS_BASER%u does not support 4KB pages\n", n);
+		return -1;
+	}
+
+	return 0;
+}
+
+int gicv3_its_init(uintptr_t its_base)
+{
+	unsigned int n, type, itt_entry_size, event_id_bits;
+	uint64_t baser;
+	int ret = 0;
+
+	assert(its_base != 0U);
+
+	if (its_base_addr != 0U) {
+		assert(its_base_addr == its_base);
+		return 0;
+	}
+
+	if ((mmio_read_32(its_base + GITS_CTLR) & GITS_CTLR_ENABLED) != 0U) {
+		ERROR("ITS: already enabled\n");
+		return -1;
+	}
+
+	its_base_addr = its_base;
+	if (its_wait_for_quiescent() != 0) {
+		ERROR("ITS: not quiescent\n");
+		goto fail;
+	}
+
+	its_typer = mmio_read_64(its_base + GITS_TYPER);
+	itt_entry_size = ((its_typer >> GITS_TYPER_ITT_SIZE_SHIFT) &
+			  GITS_TYPER_ITT_SIZE_MASK) + 1U;
+	event_id_bits = ((its_typer >> GITS_TYPER_IDBITS_SHIFT) &
+			 GITS_TYPER_IDBITS_MASK) + 1U;
+	if ((itt_entry_size > ITS_MAX_ITT_ENTRY_SIZE) ||
+	    (event_id_bits < ITS_EVENT_ID_BITS)) {
+		ERROR("ITS: unsupported ITT of %u bytes entries, %u EventID bits\n",
+		      itt_entry_size, event_id_bits);
+		goto fail;
+	}
+
+	/* The GIC must not see stale lines of the tables */
+	flush_dcache_range((uintptr_t)its_cmd_queue, sizeof(its_cmd_queue));
+	flush_dcache_range((uintptr_t)its_device_table,
+			   sizeof(its_device_table));
+	flush_dcache_range((uintptr_t)its_collection_table,
+			   sizeof(its_collection_table));
+	flush_dcache_range((uintptr_t)its_itt, sizeof(its_itt));
+	flush_dcache_range((uintptr_t)lpi_prop_table, sizeof(lpi_prop_table));
+
+	for (n = 0; n < GITS_BASER_NUM; n++) {
+		baser = mmio_read_64(its_base + GITS_BASER(n));
+		type = (baser >> GITS_BASER_TYPE_SHIFT) & GITS_BASER_TYPE_MASK;
+
+		if (type == GITS_BASER_TYPE_DEVICE)
+			ret = its_setup_baser(n, (uintptr_t)its_device_table,
+					      ITS_MAX_DEVICES);
+		else if (type == GITS_BASER_TYPE_COLLECTION)
+			ret = its_setup_baser(n, (uintptr_t)its_collection_table,
+					      PLATFORM_CORE_COUNT);
+
+		if (ret != 0)
+			goto fail;
+	}
+
+	/* A single 4KB page of commands. The ITS resets GITS_CREADR. */
+	mmio_write_64(its_base + GITS_CBASER, GITS_BASER_VALID |
+		      (GIC_BASER_CACHE_NC << GITS_BASER_INNER_CACHE_SHIFT) |
+		      ((uintptr_t)its_cmd_queue & GIC_BASER_PA_MASK));
+	its_cmd_offset = 0;
+	mmio_write_64(its_base + GITS_CWRITER, its_cmd_offset);
+
+	init_spinlock(&its_lock);
+	memset(its_collection, 0, sizeof(its_collection));
+
+	mmio_write_32(its_base + GITS_CTLR,
+		      mmio_read_32(its_base + GITS_CTLR) | GITS_CTLR_ENABLED);
+
+	INFO("ITS: enabled at 0x%llx\n", (unsigned long long)its_base);
+
+	return 0;
+
+fail:
+	its_base_addr = 0;
+	return -1;
+}
+
+int gicv3_its_setup_local(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	uintptr_t rdist_base = gicv3_get_rdist_base(core_pos);
+	uint64_t typer, propbaser, pendbaser;
+	its_cmd_t cmds[2];
+
+	assert(its_base_addr != 0U);
+	assert(rdist_base != 0U);
+
+	typer = mmio_read_64(rdist_base + GICR_TYPER);
+	if ((typer & TYPER_PLPIS_BIT) == 0U) {
+		ERROR("GICR: LPIs not supported\n");
+		return -1;
+	}
+
+	propbaser = ((uintptr_t)lpi_prop_table & GIC_BASER_PA_MASK) |
+		    (GIC_BASER_CACHE_NC << GICR_BASER_INNER_CACHE_SHIFT) |
+		    (LPI_ID_BITS - 1U);
+	pendbaser = ((uintptr_t)lpi_pend_table[core_pos].bits &
+		     GIC_BASER_PA_MASK) |
+		    (GIC_BASER_CACHE_NC << GICR_BASER_INNER_CACHE_SHIFT);
+
+	/*
+	 * Once enabled, LPIs cannot be reliably disabled, nor their tables
+	 * changed. They stay enabled as long as the Re-distributor is powered.
+	 */
+	if ((mmio_read_32(rdist_base + GICR_CTLR) &
+	     GICR_CTLR_ENABLE_LPIS) == 0U) {
+		memset(lpi_pend_table[core_pos].bits, 0, LPI_PEND_TABLE_SIZE);
+		flush_dcache_range((uintptr_t)lpi_pend_table[core_pos].bits,
+				   LPI_PEND_TABLE_SIZE);
+
+		mmio_write_64(rdist_base + GICR_PROPBASER, propbaser);
+		mmio_write_64(rdist_base + GICR_PENDBASER, pendbaser);
+		mmio_write_32(rdist_base + GICR_CTLR,
+			      mmio_read_32(rdist_base + GICR_CTLR) |
+			      GICR_CTLR_ENABLE_LPIS);
+	} else if (((mmio_read_64(rdist_base + GICR_PROPBASER) ^ propbaser) &
+		    GIC_BASER_PA_MASK) != 0U) {
+		ERROR("GICR: LPIs already enabled with other tables\n");
+		return -1;
+	}
+
+	if ((its_typer & GITS_TYPER_PTA) != 0U)
+		its_collection[core_pos].rdbase = rdist_base >> 16;
+	else
+		its_collection[core_pos].rdbase =
+			(typer >> TYPER_PROC_NUM_SHIFT) & TYPER_PROC_NUM_MASK;
+
+	its_cmd_mapc(&cmds[0], core_pos, its_collection[core_pos].rdbase);
+	its_cmd_sync(&cmds[1], its_collection[core_pos].rdbase);
+	if (its_send_cmds(cmds, ARRAY_SIZE(cmds)) != 0)
+		return -1;
+
+	its_collection[core_pos].mapped = true;
+
+	return 0;
+}
+
+int gicv3_its_map_device(uint32_t device_id)
+{
+	its_cmd_t cmd;
+
+	assert(device_id < ITS_MAX_DEVICES);
+
+	its_cmd_mapd(&cmd, device_id, (uintptr_t)its_itt[device_id]);
+
+	return its_send_cmds(&cmd, 1);
+}
+
+int gicv3_its_map_lpi(uint32_t device_id, uint32_t event_id, unsigned int lpi,
+		      unsigned int core_pos, uint8_t priority)
+{
+	its_cmd_t cmds[3];
+	uint8_t *prop;
+
+	assert(device_id < ITS_MAX_DEVICES);
+	assert(event_id < (1U << ITS_EVENT_ID_BITS));
+	assert(IS_LPI(lpi));
+	assert(core_pos < PLATFORM_CORE_COUNT);
+	assert(its_collection[core_pos].mapped);
+
+	prop = &lpi_prop_table[lpi - MIN_LPI_ID];
+	*prop = (priority & LPI_PROP_PRIORITY_MASK) | LPI_PROP_RES1 |
+		LPI_PROP_ENABLE;
+	clean_dcache_range((uintptr_t)prop, sizeof(*prop));
+
+	lpi_core_pos[lpi - MIN_LPI_ID] = core_pos;
+
+	/* The Re-distributor may have cached the previous configuration */
+	its_cmd_mapti(&cmds[0], device_id, event_id, lpi, core_pos);
+	its_cmd_event(&cmds[1], ITS_CMD_INV, device_id, event_id);
+	its_cmd_sync(&cmds[2], its_collection[core_pos].rdbase);
+
+	return its_send_cmds(cmds, ARRAY_SIZE(cmds));
+}
+
+int gicv3_its_unmap_lpi(uint32_t device_id, uint32_t event_id,
+			unsigned int lpi)
+{
+	unsigned int core_pos;
+	its_cmd_t cmds[2];
+	uint8_t *prop;
+
+	assert(device_id < ITS_MAX_DEVICES);
+	assert(event_id < (1U << ITS_EVENT_ID_BITS));
+	assert(IS_LPI(lpi));
+
+	core_pos = lpi_core_pos[lpi - MIN_LPI_ID];
+
+	its_cmd_event(&cmds[0], ITS_CMD_DISCARD, device_id, event_id);
+	its_cmd_sync(&cmds[1], its_collection[core_pos].rdbase);
+	if (its_send_cmds(cmds, ARRAY_SIZE(cmds)) != 0)
+		return -1;
+
+	prop = &lpi_prop_table[lpi - MIN_LPI_ID];
+	*prop = LPI_PROP_RES1;
+	clean_dcache_range((uintptr_t)prop, sizeof(*prop));
+
+	return 0;
+}
+
+void gicv3_its_translate(uint32_t event_id)
+{
+	assert(its_base_addr != 0U);
+	mmio_write_32(its_base_addr + GITS_TRANSLATER, event_id);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,6 +7,7 @@
 #ifndef __ARM_GIC_H__
 #define __ARM_GIC_H__
 
+#include <platform_def.h>
 #include <stdint.h>
 
 /***************************************************************************
@@ -29,6 +30,16 @@
 #define IS_SPI(irq_num)							\
 	(((irq_num) >= MIN_SPI_ID) && ((irq_num) <= MAX_SPI_ID))
 
+/*
+ * LPIs start at MIN_LPI_ID. The framework only handles the first MAX_LPI_NUM
+ * of them, which is what IS_LPI() checks.
+ */
+#define MIN_LPI_ID		8192
+#define MAX_LPI_NUM		64
+
+#define IS_LPI(irq_num)							\
+	(((irq_num) >= MIN_LPI_ID) && ((irq_num) < MIN_LPI_ID + MAX_LPI_NUM))
+
 #define IS_VALID_INTR_ID(irq_num)					\
 	(((irq_num) >= MIN_SGI_ID) && ((irq_num) <= MAX_SPI_ID))
 
@@ -36,6 +47,30 @@
 #define GIC_LOWEST_NS_PRIORITY	254 /* 255 would disable an interrupt */
 #define GIC_SPURIOUS_INTERRUPT	1023
 
+/* Set of cores targeted by an SGI, as a bitmap indexed by core position */
+#define CORE_MASK_WORDS		((PLATFORM_CORE_COUNT + 63) / 64)
+
+typedef struct core_mask {
+	uint64_t bits[CORE_MASK_WORDS];
+} core_mask_t;
+
+static inline void core_mask_clear(core_mask_t *mask)
+{
+	for (unsigned int i = 0; i < CORE_MASK_WORDS; i++)
+		mask->bits[i] = 0;
+}
+
+static inline void core_mask_set(core_mask_t *mask, unsigned int core_pos)
+{
+	mask->bits[core_pos / 64] |= 1ULL << (core_pos % 64);
+}
+
+static inline unsigned int core_mask_test(const core_mask_t *mask,
+					  unsigned int core_pos)
+{
+	return (mask->bits[core_pos / 64] >> (core_pos % 64)) & 1;
+}
+
 /******************************************************************************
  * Setup the global GIC interface. In case of GICv2, it would be the GIC
  * Distributor and in case of GICv3 it would be GIC Distributor and
@@ -63,6 +98,18 @@ void arm_gic_enable_interrupts_local(void);
  *****************************************************************************/
 void arm_gic_send_sgi(unsigned int sgi_id, unsigned int core_pos);
 
+/******************************************************************************
+ * Send SGI with ID `sgi_id` to all the cores in `mask`, with as few writes to
+ * the GIC as the GIC architecture allows.
+ *****************************************************************************/
+void arm_gic_send_sgi_mask(unsigned int sgi_id, const core_mask_t *mask);
+
+/******************************************************************************
+ * Send SGI with ID `sgi_id` to all the cores but the calling one, with a
+ * single write to the GIC. All the cores must be able to take it.
+ *****************************************************************************/
+void arm_gic_send_sgi_all_but_self(unsigned int sgi_id);
+
 /******************************************************************************
  * Set the interrupt target of interrupt ID `num` to a core with index
  * `core_pos`
@@ -114,6 +161,12 @@ void arm_gic_end_of_intr(unsigned int raw_iar);
  *****************************************************************************/
 unsigned int arm_gic_is_intr_pending(unsigned int num);
 
+/******************************************************************************
+ * Set the pending status of the interrupt with ID `num` at the GIC. This is
+ * only valid for SPIs and for the PPIs of the calling core.
+ *****************************************************************************/
+void arm_gic_set_intr_pending(unsigned int num);
+
 /******************************************************************************
  * Clear the pending status of the interrupt with ID `num` at the GIC.
  *****************************************************************************/
@@ -150,4 +203,13 @@ void arm_gic_save_context_global(void);
  *****************************************************************************/
 void arm_gic_restore_context_global(void);
 
+/******************************************************************************
+ * Get the base address of the GIC Distributor, and the one of the frame holding
+ * the SGI and PPI registers of the calling CPU: the Distributor on GICv2, the
+ * SGI frame of the Re-distributor of the CPU on GICv3. The registers of both
+ * frames have the same layout.
+ *****************************************************************************/
+uintptr_t arm_gic_get_dist_base(void);
+uintptr_t arm_gic_get_sgi_ppi_base(void);
+
 #endif /* __ARM_GIC_H__ */
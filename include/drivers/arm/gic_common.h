@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -35,6 +35,17 @@
 /* GICD_TYPER bit definitions */
 #define IT_LINES_NO_MASK	0x1f
 
+/* Number of interrupt IDs implemented by a GIC whose GICD_TYPER is `typer` */
+#define GICD_TYPER_NUM_INTR(typer)	((((typer) & IT_LINES_NO_MASK) + 1) * 32)
+
+/*
+ * Number of registers of each kind in the context of `n` interrupts saved by
+ * gicd_save_intr_ctx()
+ */
+#define GIC_CTX_ISENABLER_NUM(n)	(((n) + 31) >> ISENABLER_SHIFT)
+#define GIC_CTX_IPRIORITYR_NUM(n)	(GIC_CTX_ISENABLER_NUM(n) << 3)
+#define GIC_CTX_ICFGR_NUM(n)		(GIC_CTX_ISENABLER_NUM(n) << 1)
+
 /* GICD Priority register mask */
 #define GIC_PRI_MASK		0xff
 
@@ -79,6 +90,38 @@ void gicd_write_ipriorityr(uintptr_t base, unsigned int interrupt_id,
 					unsigned int val);
 void gicd_write_icfgr(uintptr_t base, unsigned int interrupt_id,
 					unsigned int val);
+
+/*
+ * Record that the framework has configured interrupt #n of a context, in
+ * `configured`, a bitmap with the layout of the ISENABLER registers.
+ */
+void gicd_ctx_set_configured(uint32_t *configured, unsigned int n);
+
+/*
+ * Save the context of the `num` interrupts from `first_id`, which must be a
+ * multiple of 32, at the Distributor at `base`. As the Re-distributor SGI
+ * frame has the same layout, it can be passed as `base` for SGIs and PPIs.
+ *
+ * The enable bits of all the interrupts are saved. The IPRIORITYR and ICFGR
+ * registers are only read when they hold the configuration of an interrupt
+ * marked in `configured`, or of an enabled one, which is then marked too. The
+ * other interrupts have never been configured by the framework.
+ */
+void gicd_save_intr_ctx(uintptr_t base, unsigned int first_id,
+			unsigned int num, uint32_t *configured,
+			uint32_t *isenabler, uint32_t *ipriorityr,
+			uint32_t *icfgr);
+
+/*
+ * Restore a context saved by gicd_save_intr_ctx(). All the registers that were
+ * saved are written back, and the interrupts are enabled after their
+ * configuration has been restored.
+ */
+void gicd_restore_intr_ctx(uintptr_t base, unsigned int first_id,
+			   unsigned int num, const uint32_t *configured,
+			   const uint32_t *isenabler,
+			   const uint32_t *ipriorityr, const uint32_t *icfgr);
+
 unsigned int gicd_get_isenabler(uintptr_t base, unsigned int interrupt_id);
 void gicd_set_isenabler(uintptr_t base, unsigned int interrupt_id);
 void gicd_set_icenabler(uintptr_t base, unsigned int interrupt_id);
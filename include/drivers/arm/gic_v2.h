@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -28,6 +28,11 @@
 /* GICD_SGIR bit shifts */
 #define GICD_SGIR_INTID_SHIFT		0
 #define GICD_SGIR_CPUTL_SHIFT		16
+#define GICD_SGIR_TLF_SHIFT		24
+
+/* GICD_SGIR target list filters */
+#define GICD_SGIR_TLF_LIST		0
+#define GICD_SGIR_TLF_ALL_BUT_SELF	1
 
 /* Physical CPU Interface register offsets */
 #define GICC_CTLR		0x0
@@ -97,6 +102,9 @@
 
 #include <mmio.h>
 
+/* Defined in arm_gic.h, which depends on the platform */
+struct core_mask;
+
 /*******************************************************************************
  * Private Interfaces for internal use by the GICv2 driver
  ******************************************************************************/
@@ -215,6 +223,11 @@ static inline void gicc_write_dir(unsigned int base, unsigned int val)
  */
 void gicv2_init(uintptr_t gicc_base, uintptr_t gicd_base);
 
+/*
+ * Get the Distributor base address.
+ */
+uintptr_t gicv2_get_gicd_base(void);
+
 /*
  * Write the GICv2 EOIR register with `val` passed as argument. `val`
  * should be the raw value read from IAR register.
@@ -276,6 +289,18 @@ void gicv2_set_itargetsr_value(unsigned int num, unsigned int val);
  */
 void gicv2_send_sgi(unsigned int sgi_id, unsigned int core_pos);
 
+/*
+ * Send SGI with ID `sgi_id` to all the cores in `mask` with a single write to
+ * GICD_SGIR.
+ */
+void gicv2_send_sgi_mask(unsigned int sgi_id, const struct core_mask *mask);
+
+/*
+ * Send SGI with ID `sgi_id` to all the cores but the calling one, using the
+ * target list filter of GICD_SGIR.
+ */
+void gicv2_send_sgi_all_but_self(unsigned int sgi_id);
+
 /*
  * Get the priority of the interrupt `interrupt_id`.
  */
@@ -303,6 +328,18 @@ void gicv2_save_sgi_ppi_context(void);
  */
 void gicv2_restore_sgi_ppi_context(void);
 
+/*
+ * Save the configuration of the SPIs before powering down the GIC
+ * Distributor.
+ */
+void gicv2_save_spi_context(void);
+
+/*
+ * Restore the SPI context saved by gicv2_save_spi_context() after powering up
+ * the GIC Distributor.
+ */
+void gicv2_restore_spi_context(void);
+
 /*
  * Disable the GIC CPU interface.
  */
@@ -14,6 +14,9 @@
 /* GICD register offsets */
 #define GICD_IROUTER		0x6000
 
+/* GICD_TYPER bit definitions */
+#define GICD_TYPER_LPIS		(1 << 17)
+
 /* GICD_CTLR bit definitions */
 #define GICD_CTLR_ENABLE_GRP1A		(1 << 1)
 #define GICD_CTLR_ARE_NS_SHIFT		4
@@ -29,6 +32,10 @@
 #define TYPER_LAST_MASK		0x1
 
 #define TYPER_LAST_BIT		(1 << TYPER_LAST_SHIFT)
+#define TYPER_PLPIS_BIT		(1 << 0)
+
+/* GICR_CTLR bit definitions */
+#define GICR_CTLR_ENABLE_LPIS	(1 << 0)
 
 /* GICD_IROUTER shifts and masks */
 #define IROUTER_IRM_SHIFT	31
@@ -42,6 +49,8 @@
 #define GICR_CTLR		0x0
 #define GICR_TYPER		0x08
 #define GICR_WAKER		0x14
+#define GICR_PROPBASER		0x70
+#define GICR_PENDBASER		0x78
 #define GICR_IGROUPR0		(GICR_SGIBASE_OFFSET + 0x80)
 #define GICR_ISENABLER0		(GICR_SGIBASE_OFFSET + 0x100)
 #define GICR_ICENABLER0		(GICR_SGIBASE_OFFSET + 0x180)
@@ -77,7 +86,7 @@
 #define SGI1R_INTID_MASK		0xf
 #define SGI1R_INTID_SHIFT		24
 #define SGI1R_IRM_MASK			0x1
-#define SGI1R_IRM_SHIFT			0x40
+#define SGI1R_IRM_SHIFT			40ULL
 
 /* ICC_IGRPEN1_EL1 bit definitions */
 #define IGRPEN1_EL1_ENABLE_SHIFT	0
@@ -107,6 +116,9 @@
 
 #ifndef ASSEMBLY
 
+/* Defined in arm_gic.h, which depends on the platform */
+struct core_mask;
+
 /*******************************************************************************
  * Helper GICv3 macros
  ******************************************************************************/
@@ -141,6 +153,23 @@ void gicv3_setup_distif(void);
  */
 void gicv3_probe_redistif_addr(void);
 
+/*
+ * Get the Distributor base address.
+ */
+uintptr_t gicv3_get_gicd_base(void);
+
+/*
+ * Get the Re-distributor base address of the core at `core_pos`, or 0 if the
+ * core has not probed it yet.
+ */
+uintptr_t gicv3_get_rdist_base(unsigned int core_pos);
+
+/*
+ * Set the bit corresponding to `interrupt_id` in the ISPENDR register
+ * at either Distributor or Re-distributor depending on the interrupt.
+ */
+void gicv3_set_ispendr(unsigned int interrupt_id);
+
 /*
  * Set the bit corresponding to `interrupt_id` in the ICPENDR register
  * at either Distributor or Re-distributor depending on the interrupt.
@@ -182,6 +211,18 @@ void gicv3_set_intr_route(unsigned int interrupt_id, unsigned int core_pos);
  */
 void gicv3_send_sgi(unsigned int sgi_id, unsigned int core_pos);
 
+/*
+ * Send SGI with ID `sgi_id` to all the cores in `mask`. The cores that share
+ * affinities 3 to 1 are targeted by a single write to ICC_SGI1R.
+ */
+void gicv3_send_sgi_mask(unsigned int sgi_id, const struct core_mask *mask);
+
+/*
+ * Send SGI with ID `sgi_id` to all the cores but the calling one, using the
+ * Interrupt Routing Mode of ICC_SGI1R.
+ */
+void gicv3_send_sgi_all_but_self(unsigned int sgi_id);
+
 /*
  * Get the priority of the interrupt `interrupt_id`.
  */
@@ -198,6 +239,18 @@ void gicv3_set_ipriorityr(unsigned int interrupt_id, unsigned int priority);
  */
 void gicv3_restore_sgi_ppi_context(void);
 
+/*
+ * Save the configuration of the SPIs before powering down the GIC
+ * Distributor.
+ */
+void gicv3_save_spi_context(void);
+
+/*
+ * Restore the SPI context saved by gicv3_save_spi_context() after powering up
+ * the GIC Distributor.
+ */
+void gicv3_restore_spi_context(void);
+
 /*
  * Save the GICv3 SGI and PPI context prior to powering down the
  * GIC Re-distributor.
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef __GIC_V3_ITS_H__
+#define __GIC_V3_ITS_H__
+
+#include <stdint.h>
+
+/***************************************************************************
+ * Defines and prototypes of the GICv3 Interrupt Translation Service (ITS)
+ * driver, which routes LPIs to the Re-distributors.
+ *************************************************************************/
+
+/* GITS register offsets, from the ITS control register frame */
+#define GITS_CTLR		0x0
+#define GITS_TYPER		0x8
+#define GITS_CBASER		0x80
+#define GITS_CWRITER		0x88
+#define GITS_CREADR		0x90
+#define GITS_BASER(n)		(0x100 + ((n) << 3))
+
+/* The translation register frame follows the control register frame */
+#define GITS_TRANSLATER		(0x10000 + 0x40)
+
+#define GITS_BASER_NUM		8
+
+/* GITS_CTLR bit definitions */
+#define GITS_CTLR_ENABLED	(1U << 0)
+#define GITS_CTLR_QUIESCENT	(1U << 31)
+
+/* GITS_TYPER bit definitions */
+#define GITS_TYPER_ITT_SIZE_SHIFT	4
+#define GITS_TYPER_ITT_SIZE_MASK	0xf
+#define GITS_TYPER_IDBITS_SHIFT		8
+#define GITS_TYPER_IDBITS_MASK		0x1f
+#define GITS_TYPER_DEVBITS_SHIFT	13
+#define GITS_TYPER_DEVBITS_MASK		0x1f
+#define GITS_TYPER_PTA			(1ULL << 19)
+#define GITS_TYPER_HCC_SHIFT		24
+#define GITS_TYPER_HCC_MASK		0xff
+
+/* GITS_CBASER, GITS_BASER<n>, GICR_PROPBASER and GICR_PENDBASER fields */
+#define GITS_BASER_VALID		(1ULL << 63)
+#define GITS_BASER_INDIRECT		(1ULL << 62)
+#define GITS_BASER_TYPE_SHIFT		56
+#define GITS_BASER_TYPE_MASK		0x7
+#define GITS_BASER_TYPE_NONE		0
+#define GITS_BASER_TYPE_DEVICE		1
+#define GITS_BASER_TYPE_COLLECTION	4
+#define GITS_BASER_ENTRY_SIZE_SHIFT	48
+#define GITS_BASER_ENTRY_SIZE_MASK	0x1f
+#define GITS_BASER_PAGE_SIZE_SHIFT	8
+#define GITS_BASER_PAGE_SIZE_MASK	0x3
+#define GITS_BASER_PAGE_SIZE_4K		0
+#define GITS_BASER_INNER_CACHE_SHIFT	59
+#define GICR_BASER_INNER_CACHE_SHIFT	7
+#define GIC_BASER_CACHE_NC		1ULL
+#define GIC_BASER_PA_MASK		0xffffffffff000ULL
+
+/* GITS_CREADR and GITS_CWRITER fields */
+#define GITS_CREADR_STALLED		(1ULL << 0)
+#define GITS_CMD_OFFSET_MASK		0xfffe0ULL
+
+/* LPI configuration table entries */
+#define LPI_PROP_ENABLE			(1U << 0)
+#define LPI_PROP_RES1			(1U << 1)
+#define LPI_PROP_PRIORITY_MASK		0xfc
+
+/*
+ * Number of bits of the LPI INTIDs. 14 bits is the minimum that includes LPIs,
+ * which start at INTID 8192.
+ */
+#define LPI_ID_BITS		14
+
+/* Devices and EventIDs per device that can be mapped */
+#define ITS_MAX_DEVICES		4
+#define ITS_EVENT_ID_BITS	6
+
+#ifndef __ASSEMBLY__
+
+/*
+ * Initialise the ITS at `its_base`: allocate its command queue, device and
+ * collection tables, the LPI configuration table, and enable it. Calling it
+ * again once the ITS is enabled has no effect.
+ *
+ * Return 0 on success, a negative value otherwise.
+ */
+int gicv3_its_init(uintptr_t its_base);
+
+/*
+ * Enable LPIs at the Re-distributor of the calling core and map its
+ * collection, whose ID is the core position, to it. It must be called by
+ * each core that LPIs are routed to, after gicv3_its_init().
+ *
+ * Return 0 on success, a negative value otherwise.
+ */
+int gicv3_its_setup_local(void);
+
+/*
+ * Map the device `device_id`, which must be lower than ITS_MAX_DEVICES, to
+ * an Interrupt Translation Table with 2^ITS_EVENT_ID_BITS events.
+ *
+ * Return 0 on success, a negative value otherwise.
+ */
+int gicv3_its_map_device(uint32_t device_id);
+
+/*
+ * Translate the event `event_id` of the device `device_id` to the LPI `lpi`
+ * with priority `priority`, delivered to the core at `core_pos`. That core
+ * must have called gicv3_its_setup_local().
+ *
+ * Return 0 on success, a negative value otherwise.
+ */
+int gicv3_its_map_lpi(uint32_t device_id, uint32_t event_id, unsigned int lpi,
+		      unsigned int core_pos, uint8_t priority);
+
+/*
+ * Remove the translation of the event `event_id` of the device `device_id`
+ * to the LPI `lpi`, and disable the LPI. A pending LPI is discarded.
+ *
+ * Return 0 on success, a negative value otherwise.
+ */
+int gicv3_its_unmap_lpi(uint32_t device_id, uint32_t event_id,
+			unsigned int lpi);
+
+/*
+ * Generate the event `event_id` by writing it to GITS_TRANSLATER. The ITS
+ * gives writes from the cores an IMPLEMENTATION DEFINED DeviceID.
+ */
+void gicv3_its_translate(uint32_t event_id);
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* __GIC_V3_ITS_H__ */
@@ -217,6 +217,12 @@
 #define ID_AA64PFR0_GIC_WIDTH	U(4)
 #define ID_AA64PFR0_GIC_MASK	ULL(0xf)
 
+/* ID_AA64ISAR0_EL1 definitions */
+#define ID_AA64ISAR0_TLB_SHIFT		U(56)
+#define ID_AA64ISAR0_TLB_WIDTH		U(4)
+#define ID_AA64ISAR0_TLB_MASK		ULL(0xf)
+#define ID_AA64ISAR0_TLB_RANGE		ULL(0x2)
+
 /* ID_AA64ISAR1_EL1 definitions */
 #define ID_AA64ISAR1_EL1	S3_0_C0_C6_1
 #define ID_AA64ISAR1_GPI_SHIFT	U(28)
@@ -766,6 +772,26 @@
 #define TLBI_ADDR_MASK		ULL(0x00000FFFFFFFFFFF)
 #define TLBI_ADDR(x)		(((x) >> TLBI_ADDR_SHIFT) & TLBI_ADDR_MASK)
 
+/*
+ * Operand of the TLBI by range instructions (FEAT_TLBIRANGE) for a 4KB
+ * granule. They invalidate (NUM + 1) << (5 * SCALE + 1) pages from BaseADDR.
+ */
+#define TLBI_RANGE_TG_4K		(ULL(1) << 46)
+#define TLBI_RANGE_SCALE_SHIFT		U(44)
+#define TLBI_RANGE_SCALE_MAX		U(3)
+#define TLBI_RANGE_NUM_SHIFT		U(39)
+#define TLBI_RANGE_NUM_MAX		U(31)
+#define TLBI_RANGE_BADDR_MASK		ULL(0x1FFFFFFFFF)
+#define TLBI_RANGE_PAGES(num, scale)	\
+	((unsigned long)((num) + 1U) << ((5U * (scale)) + 1U))
+#define TLBI_RANGE_MAX_PAGES		\
+	TLBI_RANGE_PAGES(TLBI_RANGE_NUM_MAX, TLBI_RANGE_SCALE_MAX)
+#define TLBI_RANGE(va, num, scale)					\
+	(TLBI_RANGE_TG_4K |						\
+	 ((unsigned long long)(scale) << TLBI_RANGE_SCALE_SHIFT) |	\
+	 ((unsigned long long)(num) << TLBI_RANGE_NUM_SHIFT) |		\
+	 (((va) >> TLBI_ADDR_SHIFT) & TLBI_RANGE_BADDR_MASK))
+
 /*******************************************************************************
  * Definitions of register offsets and fields in the CNTCTLBase Frame of the
  * system level implementation of the Generic Timer.
@@ -131,6 +131,7 @@ DEFINE_SYSOP_TYPE_FUNC(tlbi, alle3)
 DEFINE_SYSOP_TYPE_FUNC(tlbi, alle3is)
 #endif
 DEFINE_SYSOP_TYPE_FUNC(tlbi, vmalle1)
+DEFINE_SYSOP_TYPE_FUNC(tlbi, vmalle1is)
 
 DEFINE_SYSOP_TYPE_PARAM_FUNC(tlbi, vaae1is)
 DEFINE_SYSOP_TYPE_PARAM_FUNC(tlbi, vaale1is)
@@ -144,6 +145,20 @@ DEFINE_SYSOP_TYPE_PARAM_FUNC(tlbi, vae3is)
 DEFINE_SYSOP_TYPE_PARAM_FUNC(tlbi, vale3is)
 #endif
 
+/*
+ * TLBI by range (FEAT_TLBIRANGE), encoded as SYS instructions so that they can
+ * be assembled without enabling Armv8.4 in the toolchain.
+ */
+#define DEFINE_TLBIOP_RANGE_FUNC(_type, _op1, _op2)			\
+static inline void tlbi ## _type(uint64_t v)				\
+{									\
+	__asm__("sys #" #_op1 ", c8, c2, #" #_op2 ", %0" : : "r" (v));	\
+}
+
+DEFINE_TLBIOP_RANGE_FUNC(rvaae1is, 0, 3)
+DEFINE_TLBIOP_RANGE_FUNC(rvae2is, 4, 1)
+DEFINE_TLBIOP_RANGE_FUNC(rvae3is, 6, 1)
+
 /*******************************************************************************
  * Cache maintenance accessor prototypes
  ******************************************************************************/
@@ -186,6 +201,7 @@ void disable_mmu_icache(void);
 
 DEFINE_SYSREG_RW_FUNCS(par_el1)
 DEFINE_SYSREG_READ_FUNC(id_pfr1_el1)
+DEFINE_SYSREG_READ_FUNC(id_aa64isar0_el1)
 DEFINE_SYSREG_READ_FUNC(id_aa64isar1_el1)
 DEFINE_SYSREG_READ_FUNC(id_aa64pfr0_el1)
 DEFINE_SYSREG_READ_FUNC(id_aa64pfr1_el1)
@@ -397,6 +413,8 @@ DEFINE_SYSREG_RW_FUNCS(cnthctl_el2)
 #define clr_cntp_ctl_enable(x)  ((x) &= ~(U(1) << CNTP_CTL_ENABLE_SHIFT))
 #define clr_cntp_ctl_imask(x)   ((x) &= ~(U(1) << CNTP_CTL_IMASK_SHIFT))
 
+DEFINE_SYSREG_RW_FUNCS(tpidr_el1)
+DEFINE_SYSREG_RW_FUNCS(tpidr_el2)
 DEFINE_SYSREG_RW_FUNCS(tpidr_el3)
 
 DEFINE_SYSREG_RW_FUNCS(cntvoff_el2)
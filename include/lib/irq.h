@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -47,8 +47,27 @@ typedef struct {
 typedef irq_handler_banked_t ppi_desc;
 typedef irq_handler_banked_t sgi_desc;
 
+/*
+ * Statistics of an interrupt on a CPU. Times are in system counter ticks, and
+ * only cover the IRQ handler registered for the interrupt.
+ */
+typedef struct {
+	/* Number of times the interrupt was taken */
+	uint64_t count;
+	/* Total time spent in the handler */
+	uint64_t ticks;
+	/* Longest time spent in the handler */
+	uint64_t max_ticks;
+} irq_stats_t;
+
 void tftf_irq_setup(void);
 
+/*
+ * Per-CPU setup of the IRQ framework. It must be called by each CPU when it
+ * boots or resumes from a power down state, before it unmasks IRQs.
+ */
+void tftf_irq_setup_local(void);
+
 /*
  * Generic handler called upon reception of an IRQ.
  *
@@ -59,7 +78,8 @@ void tftf_irq_setup(void);
 int tftf_irq_handler_dispatcher(void);
 
 /*
- * Enable interrupt #irq_num for the calling core.
+ * Enable interrupt #irq_num for the calling core. LPIs are enabled through
+ * the ITS driver instead.
  */
 void tftf_irq_enable(unsigned int irq_num, uint8_t irq_priority);
 
@@ -85,6 +105,33 @@ int tftf_irq_register_handler(unsigned int num, irq_handler_t irq_handler);
  */
 int tftf_irq_unregister_handler(unsigned int irq_num);
 
+/*
+ * Get the statistics of interrupt #irq_num on the CPU at position core_pos.
+ * The statistics of spurious interrupts are returned for
+ * GIC_SPURIOUS_INTERRUPT. They also count the interrupts with an INTID that
+ * the framework doesn't handle, such as SPIs above PLAT_MAX_SPI_OFFSET_ID and
+ * LPIs beyond the first MAX_LPI_NUM.
+ *
+ * The statistics are updated by each CPU without synchronisation, so they
+ * should be read from another CPU only when it isn't taking interrupts.
+ */
+void tftf_irq_get_stats(unsigned int core_pos, unsigned int irq_num,
+			irq_stats_t *stats);
+
+/*
+ * Get the system counter value sampled on entry to
+ * tftf_irq_handler_dispatcher() for the last interrupt taken by the calling
+ * CPU. Called from an IRQ handler, it returns the time at which the interrupt
+ * being handled was taken.
+ */
+uint64_t tftf_irq_get_entry_ticks(void);
+
+/*
+ * Reset the statistics of all the interrupts on all the CPUs. No CPU should
+ * be taking interrupts at the same time.
+ */
+void tftf_irq_reset_stats(void);
+
 #endif /* __ASSEMBLY__ */
 
 #endif /* __IRQ_H__ */
@@ -4,7 +4,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 /*
- * Portions copyright (c) 2018-2019, ARM Limited and Contributors.
+ * Portions copyright (c) 2018-2023, ARM Limited and Contributors.
  * All rights reserved.
  */
 
@@ -25,6 +25,7 @@ extern int atexit(void (*func)(void));
 extern void exit(int status);
 
 int rand(void);
+int rand_r(unsigned int *ctx);
 void srand(unsigned int seed);
 
 #endif /* STDLIB_H */
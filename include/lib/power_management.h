@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -107,6 +107,11 @@ int32_t tftf_cpu_off(void);
  */
 int tftf_suspend(const suspend_info_t *info);
 
+/*
+ * Get the time, in system counter ticks, spent saving and restoring the global
+ * GIC context during the last suspend that saved the system context.
+ */
+void tftf_get_system_ctx_ticks(uint64_t *save_ticks, uint64_t *restore_ticks);
 
 /* ----------------------------------------------------------------------------
  * The above APIs might not be suitable in all test scenarios.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,6 +7,8 @@
 #ifndef __SGI_H__
 #define __SGI_H__
 
+#include <drivers/arm/arm_gic.h>
+
 /* Data associated with the reception of an SGI */
 typedef struct {
 	/* Interrupt ID of the signaled interrupt */
@@ -18,4 +20,16 @@ typedef struct {
  */
 void tftf_send_sgi(unsigned int sgi_id, unsigned int core_pos);
 
+/*
+ * Send an SGI to all the cores in `mask`, which must be online. This costs
+ * fewer writes to the GIC than calling tftf_send_sgi() for each core.
+ */
+void tftf_send_sgi_mask(unsigned int sgi_id, const core_mask_t *mask);
+
+/*
+ * Send an SGI to all the online cores but the calling one. When all the cores
+ * are online, it is broadcast with a single write to the GIC.
+ */
+void tftf_send_sgi_all_but_self(unsigned int sgi_id);
+
 #endif /* __SGI_H__ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2022, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -56,6 +56,14 @@
 #define CONT_HINT		(ULL(1) << 0)
 #define UPPER_ATTRS(x)		(((x) & ULL(0x7)) << 52)
 
+/*
+ * Number of adjacent entries of a table that the contiguous hint applies to,
+ * and size of the memory they map together. Both the VA and the PA of the
+ * first entry of a run must be aligned to this size.
+ */
+#define XLAT_CONT_ENTRIES	U(16)
+#define XLAT_CONT_SIZE(level)	(XLAT_CONT_ENTRIES * XLAT_BLOCK_SIZE(level))
+
 #define NON_GLOBAL		(U(1) << 9)
 #define ACCESS_FLAG		(U(1) << 8)
 #define NSH			(U(0x0) << 6)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -65,6 +65,8 @@
 #define MT_EXECUTE_SHIFT	U(5)
 /* In the EL1&0 translation regime, User (EL0) or Privileged (EL1). */
 #define MT_USER_SHIFT		U(6)
+/* Contiguous hint allowed or not (CONT_HINT/NO_CONT_HINT) */
+#define MT_CONT_SHIFT		U(7)
 /* All other bits are reserved */
 
 /*
@@ -105,6 +107,17 @@
 #define MT_USER			(U(1) << MT_USER_SHIFT)
 #define MT_PRIVILEGED		(U(0) << MT_USER_SHIFT)
 
+/*
+ * In a region mapped with MT_CONT_HINT, runs of XLAT_CONT_ENTRIES block or page
+ * descriptors whose VA and PA are aligned to XLAT_CONT_SIZE() are mapped with
+ * the contiguous hint so that they only use one TLB entry. The attributes of
+ * such a run can only be changed as a whole (see
+ * xlat_change_mem_attributes_ctx()). Regions are mapped without the hint by
+ * default.
+ */
+#define MT_NO_CONT_HINT		(U(0) << MT_CONT_SHIFT)
+#define MT_CONT_HINT		(U(1) << MT_CONT_SHIFT)
+
 /* Compound attributes for most common usages */
 #define MT_CODE			(MT_MEMORY | MT_RO | MT_EXECUTE)
 #define MT_RO_DATA		(MT_MEMORY | MT_RO | MT_EXECUTE_NEVER)
@@ -217,7 +230,8 @@ void xlat_setup_dynamic_ctx(xlat_ctx_t *ctx, unsigned long long pa_max,
 			    uintptr_t va_max, struct mmap_region *mmap,
 			    unsigned int mmap_num, uint64_t **tables,
 			    unsigned int tables_num, uint64_t *base_table,
-			    int xlat_regime, int *mapped_regions);
+			    int xlat_regime, int *mapped_regions,
+			    uint64_t *tables_free_map);
 
 /*
  * Add a static region with defined base PA and base VA. This function can only
@@ -339,6 +353,12 @@ int mmap_remove_dynamic_region_ctx(xlat_ctx_t *ctx,
  * NOTE2: The caller is responsible for making sure that the targeted
  * translation tables are not modified by any other code while this function is
  * executing.
+ *
+ * NOTE3: The pages of the region are briefly unmapped while their attributes
+ * change, so they must not be accessed while this function is executing. The
+ * pages of a region mapped with MT_CONT_HINT may be grouped into runs of
+ * XLAT_CONT_SIZE() bytes, whose attributes can only be changed as a whole:
+ * this function fails if the region only covers part of such a run.
  */
 int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 				   size_t size, uint32_t attr);
@@ -363,5 +383,117 @@ int xlat_get_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 				uint32_t *attr);
 int xlat_get_mem_attributes(uintptr_t base_va, uint32_t *attr);
 
+/* Use of the translation tables and of the mmap array of a context. */
+typedef struct xlat_tables_stats {
+	/* Number of sub-tables in use and available */
+	unsigned int tables_used;
+	unsigned int tables_num;
+	/*
+	 * Highest number of sub-tables in use since the translation tables
+	 * were initialized. Sub-tables aren't freed without dynamic regions,
+	 * so it is the same as tables_used.
+	 */
+	unsigned int tables_peak;
+	/* Number of regions in the mmap array, and maximum number of them */
+	unsigned int regions;
+	unsigned int regions_num;
+} xlat_tables_stats_t;
+
+/*
+ * Get the statistics of use of a set of translation tables.
+ *
+ * ctx
+ *   Translation context to work on.
+ * stats
+ *   Output parameter where to store the statistics.
+ */
+void xlat_get_tables_stats_ctx(const xlat_ctx_t *ctx,
+			       xlat_tables_stats_t *stats);
+void xlat_get_tables_stats(xlat_tables_stats_t *stats);
+
+/*
+ * Snapshot of the mappings of a translation context.
+ *
+ * It is made of this header, followed by a copy of the `regions` used entries
+ * of the mmap array, followed by `runs` runs of block or page descriptors. A
+ * run is a group of descriptors of the same level, with the same attributes,
+ * that map consecutive VAs to consecutive PAs. The runs are sorted by VA. A
+ * snapshot doesn't point to anything, so it can be copied anywhere.
+ */
+#define XLAT_SNAPSHOT_MAGIC	U(0x584c4154)	/* "XLAT" */
+
+typedef struct xlat_snapshot_run {
+	uintptr_t base_va;
+	unsigned long long base_pa;
+	/* Bits of the descriptors other than the type and output address */
+	uint64_t attr;
+	/* Lookup level and number of the descriptors */
+	unsigned int level;
+	unsigned int count;
+} xlat_snapshot_run_t;
+
+typedef struct xlat_snapshot {
+	unsigned int magic;
+	int xlat_regime;
+	unsigned int base_level;
+	unsigned int regions;
+	unsigned int runs;
+	/* Size of the whole snapshot, in bytes */
+	size_t size;
+} xlat_snapshot_t;
+
+/* Summary of the descriptors of a snapshot. */
+typedef struct xlat_snapshot_profile {
+	/* Number of block (levels 0 to 2) or page (level 3) descriptors */
+	unsigned long long descs[XLAT_TABLE_LEVEL_MAX + 1U];
+	/* Size of the memory mapped by them */
+	unsigned long long mapped;
+	/*
+	 * Number of descriptors that would be needed to map the same memory with
+	 * the largest blocks that the alignment of the VAs and PAs allows.
+	 */
+	unsigned long long ideal_descs;
+	/*
+	 * Share of the descriptors that could be merged in larger blocks, from
+	 * 0 (none) to 100.
+	 */
+	unsigned int fragmentation;
+	/*
+	 * Average number of lookup levels walked to translate an address, in
+	 * hundredths of level. Every mapped byte has the same weight.
+	 */
+	unsigned int walk_depth;
+} xlat_snapshot_profile_t;
+
+/*
+ * Take a snapshot of the translation tables of a context.
+ *
+ * ctx
+ *   Translation context to work on. It must be initialized.
+ * snap
+ *   Buffer where to store the snapshot. It must be aligned to 8 bytes.
+ * size
+ *   Size of the buffer, in bytes.
+ *
+ * Return 0 on success, or -ENOMEM if the buffer is too small. In the latter
+ * case, if the buffer can hold the header, snap->size is the size needed.
+ */
+int xlat_snapshot_ctx(const xlat_ctx_t *ctx, xlat_snapshot_t *snap,
+		      size_t size);
+int xlat_snapshot(xlat_snapshot_t *snap, size_t size);
+
+/*
+ * Compare two snapshots and print the regions that were added, removed or
+ * modified, and the VA ranges whose translation changed, for example from
+ * blocks to pages. Return the number of differences found.
+ */
+unsigned int xlat_snapshot_diff(const xlat_snapshot_t *before,
+				const xlat_snapshot_t *after);
+
+/* Compute the profile of a snapshot, or compute and print it. */
+void xlat_snapshot_get_profile(const xlat_snapshot_t *snap,
+			       xlat_snapshot_profile_t *profile);
+void xlat_snapshot_print_profile(const xlat_snapshot_t *snap);
+
 #endif /*__ASSEMBLY__*/
 #endif /* XLAT_TABLES_V2_H */
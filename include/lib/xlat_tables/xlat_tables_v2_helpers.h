@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -61,6 +61,9 @@ struct xlat_ctx {
 	struct mmap_region *mmap;
 	int mmap_num;
 
+	/* Number of regions currently in the `mmap` array. */
+	int mmap_regions;
+
 	/*
 	 * Array of finer-grain translation tables.
 	 * For example, if the initial lookup level is 1 then this array would
@@ -74,6 +77,17 @@ struct xlat_ctx {
 	 */
 #if PLAT_XLAT_TABLES_DYNAMIC
 	int *tables_mapped_regions;
+
+	/*
+	 * Bitmap of the tables that don't map any region. Table i is free when
+	 * bit (63 - i % 64) of word i / 64 is set, so that the first free table
+	 * is found with CLZ.
+	 */
+	uint64_t *tables_free_map;
+
+	/* Number of tables in use, and highest number of tables ever in use */
+	int tables_used;
+	int tables_peak;
 #endif /* PLAT_XLAT_TABLES_DYNAMIC */
 
 	int next_table;
@@ -107,11 +121,18 @@ struct xlat_ctx {
 };
 
 #if PLAT_XLAT_TABLES_DYNAMIC
+/* Number of words of the bitmap of free tables of a context */
+#define XLAT_TABLES_FREE_MAP_WORDS(_xlat_tables_count)			\
+	(((_xlat_tables_count) + 63) / 64)
+
 #define XLAT_ALLOC_DYNMAP_STRUCT(_ctx_name, _xlat_tables_count)		\
-	static int _ctx_name##_mapped_regions[_xlat_tables_count];
+	static int _ctx_name##_mapped_regions[_xlat_tables_count];	\
+	static uint64_t _ctx_name##_tables_free_map			\
+		[XLAT_TABLES_FREE_MAP_WORDS(_xlat_tables_count)];
 
 #define XLAT_REGISTER_DYNMAP_STRUCT(_ctx_name)				\
-	.tables_mapped_regions = _ctx_name##_mapped_regions,
+	.tables_mapped_regions = _ctx_name##_mapped_regions,		\
+	.tables_free_map = _ctx_name##_tables_free_map,
 #else
 #define XLAT_ALLOC_DYNMAP_STRUCT(_ctx_name, _xlat_tables_count)		\
 	/* do nothing */
@@ -144,6 +165,7 @@ struct xlat_ctx {
 		.pa_max_address = (_phy_addr_space_size) - 1ULL,	\
 		.mmap = _ctx_name##_mmap,				\
 		.mmap_num = (_mmap_count),				\
+		.mmap_regions = 0,					\
 		.base_level = GET_XLAT_TABLE_LEVEL_BASE(_virt_addr_space_size),\
 		.base_table = _ctx_name##_base_xlat_table,		\
 		.base_table_entries =					\
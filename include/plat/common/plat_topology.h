@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -163,6 +163,30 @@ unsigned int tftf_topology_next_cpu(unsigned int cpu_node);
  */
 unsigned int tftf_get_mpidr_from_node(unsigned int cpu_node);
 
+/*
+ * Returns the core position of the present CPU specified by `mpidr`, or
+ * PWR_DOMAIN_INIT if there is none. Unlike platform_get_core_pos(), this
+ * checks the MPIDR against the detected topology, using a lookup table built
+ * by tftf_init_topology().
+ */
+unsigned int tftf_get_core_pos_from_mpidr(unsigned int mpidr);
+
+/*
+ * Returns the index of the cluster power domain, i.e. the parent power domain
+ * at level 1, of the CPU at `core_pos`.
+ */
+unsigned int tftf_core_pos_to_cluster_node(unsigned int core_pos);
+
+/*
+ * Iterate over every CPU in the cluster of the CPU at `core_pos`, including
+ * that CPU. Skip absent CPUs.
+ * - cpu_idx: CPU index.
+ * - core_pos: core position of a CPU in the cluster.
+ */
+#define for_each_cpu_in_cluster(cpu_idx, core_pos)			\
+	for_each_cpu_in_power_domain(cpu_idx,				\
+			tftf_core_pos_to_cluster_node(core_pos))
+
 
 /*
  * Returns the index corresponding to the parent power domain at `pwrlvl` of the
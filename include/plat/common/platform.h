@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -171,6 +171,13 @@ unsigned long platform_get_stack(unsigned long mpidr);
  */
 const mem_region_t *plat_get_prot_regions(int *nelem);
 
+/*
+ * plat_get_gits_base: It returns the base address of the
+ * GICv3 ITS control register frame, or 0 if the platform
+ * does not have an ITS.
+ */
+uintptr_t plat_get_gits_base(void);
+
 void tftf_plat_reset(void);
 
 const mmap_region_t *tftf_platform_get_mmap(void);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -23,37 +23,94 @@
 	(((irq_num) >= MIN_SPI_ID) &&					\
 	 ((irq_num) <= MIN_SPI_ID + PLAT_MAX_SPI_OFFSET_ID))
 
+/*
+ * Statistics are kept for SGIs, PPIs, platform SPIs, spurious interrupts and
+ * the LPIs handled by the framework, in this order. Any other INTID is counted
+ * as a spurious interrupt.
+ */
+#define IRQ_STATS_SPURIOUS	(MIN_SPI_ID + PLAT_MAX_SPI_OFFSET_ID + 1)
+#define IRQ_STATS_LPI		(IRQ_STATS_SPURIOUS + 1)
+#define IRQ_STATS_NUM		(IRQ_STATS_LPI + MAX_LPI_NUM)
+
 static spi_desc spi_desc_table[PLAT_MAX_SPI_OFFSET_ID + 1];
+static spi_desc lpi_desc_table[MAX_LPI_NUM];
 static ppi_desc ppi_desc_table[PLATFORM_CORE_COUNT][
 				(MAX_PPI_ID + 1) - MIN_PPI_ID];
 static sgi_desc sgi_desc_table[PLATFORM_CORE_COUNT][MAX_SGI_ID + 1];
 static spurious_desc spurious_desc_handler;
 
 /*
- * For a given SPI, the associated IRQ handler is common to all CPUs.
+ * For a given SPI or LPI, the associated IRQ handler is common to all CPUs.
  * Therefore, we need a lock to prevent simultaneous updates.
  *
- * We use one lock for all SPIs. This will make it impossible to update
+ * We use one lock for all SPIs and LPIs. This will make it impossible to update
  * different SPIs' handlers at the same time (although it would be fine) but it
  * saves memory. Updating an SPI handler shouldn't occur that often anyway so we
  * shouldn't suffer from this restriction too much.
  */
 static spinlock_t spi_lock;
 
-static irq_handler_t *get_irq_handler(unsigned int irq_num)
+/*
+ * Each CPU only updates its own statistics. They are aligned on the size of a
+ * cache line so that CPUs don't write to the same cache lines.
+ */
+static struct {
+	irq_stats_t irq[IRQ_STATS_NUM];
+	/* System counter value on entry to the dispatcher */
+	uint64_t entry_ticks;
+} __aligned(CACHE_WRITEBACK_GRANULE) irq_stats[PLATFORM_CORE_COUNT];
+
+/*
+ * Return the position of the calling CPU. It is cached in the software thread
+ * ID register of the exception level of the TFTF by tftf_irq_setup_local(),
+ * which saves converting the MPIDR on each interrupt.
+ */
+static unsigned int irq_get_core_pos(void)
+{
+	u_register_t core_pos;
+
+#ifdef __aarch64__
+	if (IS_IN_EL2())
+		core_pos = read_tpidr_el2();
+	else
+		core_pos = read_tpidr_el1();
+#else
+	core_pos = read_htpidr();
+#endif
+	assert(core_pos == platform_get_core_pos(read_mpidr_el1()));
+
+	return (unsigned int)core_pos;
+}
+
+void tftf_irq_setup_local(void)
+{
+	u_register_t core_pos = platform_get_core_pos(read_mpidr_el1());
+
+#ifdef __aarch64__
+	if (IS_IN_EL2())
+		write_tpidr_el2(core_pos);
+	else
+		write_tpidr_el1(core_pos);
+#else
+	write_htpidr(core_pos);
+#endif
+}
+
+static irq_handler_t *get_irq_handler(unsigned int irq_num,
+				      unsigned int linear_id)
 {
 	if (IS_PLAT_SPI(irq_num))
 		return &spi_desc_table[irq_num - MIN_SPI_ID].handler;
 
-	unsigned int mpid = read_mpidr_el1();
-	unsigned int linear_id = platform_get_core_pos(mpid);
-
 	if (IS_PPI(irq_num))
 		return &ppi_desc_table[linear_id][irq_num - MIN_PPI_ID].handler;
 
 	if (IS_SGI(irq_num))
 		return &sgi_desc_table[linear_id][irq_num - MIN_SGI_ID].handler;
 
+	if (IS_LPI(irq_num))
+		return &lpi_desc_table[irq_num - MIN_LPI_ID].handler;
+
 	/*
 	 * The only possibility is for it to be a spurious
 	 * interrupt.
@@ -62,6 +119,27 @@ static irq_handler_t *get_irq_handler(unsigned int irq_num)
 	return &spurious_desc_handler;
 }
 
+/*
+ * Return the index of the statistics of an INTID. Each range is checked
+ * against the size of its part of the table, so that the index is always
+ * valid whatever the INTID read from the GIC.
+ */
+static unsigned int irq_stats_index(unsigned int irq_num)
+{
+	/* SGIs, PPIs and platform SPIs */
+	if (irq_num < IRQ_STATS_SPURIOUS)
+		return irq_num;
+
+	if ((irq_num >= MIN_LPI_ID) && ((irq_num - MIN_LPI_ID) < MAX_LPI_NUM))
+		return IRQ_STATS_LPI + (irq_num - MIN_LPI_ID);
+
+	/*
+	 * Spurious interrupts, the other special INTIDs, the SPIs above
+	 * PLAT_MAX_SPI_OFFSET_ID and the LPIs beyond MAX_LPI_NUM.
+	 */
+	return IRQ_STATS_SPURIOUS;
+}
+
 void tftf_send_sgi(unsigned int sgi_id, unsigned int core_pos)
 {
 	assert(IS_SGI(sgi_id));
@@ -85,6 +163,52 @@ void tftf_send_sgi(unsigned int sgi_id, unsigned int core_pos)
 	arm_gic_send_sgi(sgi_id, core_pos);
 }
 
+void tftf_send_sgi_mask(unsigned int sgi_id, const core_mask_t *mask)
+{
+	assert(IS_SGI(sgi_id));
+
+	/* See tftf_send_sgi() */
+	dsbish();
+
+#if ENABLE_ASSERTIONS
+	for (unsigned int core_pos = 0; core_pos < PLATFORM_CORE_COUNT;
+	     core_pos++) {
+		if (core_mask_test(mask, core_pos))
+			assert(tftf_is_core_pos_online(core_pos));
+	}
+#endif
+	arm_gic_send_sgi_mask(sgi_id, mask);
+}
+
+void tftf_send_sgi_all_but_self(unsigned int sgi_id)
+{
+	unsigned int self = irq_get_core_pos();
+	unsigned int online = 0;
+	core_mask_t mask;
+
+	assert(IS_SGI(sgi_id));
+
+	core_mask_clear(&mask);
+	for (unsigned int core_pos = 0; core_pos < PLATFORM_CORE_COUNT;
+	     core_pos++) {
+		if ((core_pos != self) && tftf_is_core_pos_online(core_pos)) {
+			core_mask_set(&mask, core_pos);
+			online++;
+		}
+	}
+
+	/*
+	 * The broadcast reaches all the cores, so it can only be used when none
+	 * of them is powered down.
+	 */
+	if (online + 1 == tftf_get_total_cpus_count()) {
+		dsbish();
+		arm_gic_send_sgi_all_but_self(sgi_id);
+	} else if (online != 0) {
+		tftf_send_sgi_mask(sgi_id, &mask);
+	}
+}
+
 void tftf_irq_enable(unsigned int irq_num, uint8_t irq_priority)
 {
 	if (IS_PLAT_SPI(irq_num)) {
@@ -92,7 +216,7 @@ void tftf_irq_enable(unsigned int irq_num, uint8_t irq_priority)
 		 * Instruct the GIC Distributor to forward the interrupt to
 		 * the calling core
 		 */
-		arm_gic_set_intr_target(irq_num, platform_get_core_pos(read_mpidr_el1()));
+		arm_gic_set_intr_target(irq_num, irq_get_core_pos());
 	}
 
 	arm_gic_set_intr_priority(irq_num, irq_priority);
@@ -119,21 +243,22 @@ static int tftf_irq_update_handler(unsigned int irq_num,
 	irq_handler_t *cur_handler;
 	int ret = -1;
 
-	cur_handler = get_irq_handler(irq_num);
-	if (IS_PLAT_SPI(irq_num))
+	cur_handler = get_irq_handler(irq_num, irq_get_core_pos());
+	if (IS_PLAT_SPI(irq_num) || IS_LPI(irq_num))
 		spin_lock(&spi_lock);
 
 	/*
 	 * Update the IRQ handler, if the current handler is in the expected
-	 * state
+	 * state. The dispatcher reads the handler without taking the lock, so
+	 * it is published with a single atomic store.
 	 */
 	assert(HANDLER_VALID(*cur_handler, expect_handler));
 	if (HANDLER_VALID(*cur_handler, expect_handler)) {
-		*cur_handler = irq_handler;
+		__atomic_store_n(cur_handler, irq_handler, __ATOMIC_RELEASE);
 		ret = 0;
 	}
 
-	if (IS_PLAT_SPI(irq_num))
+	if (IS_PLAT_SPI(irq_num) || IS_LPI(irq_num))
 		spin_unlock(&spi_lock);
 
 	return ret;
@@ -164,18 +289,24 @@ int tftf_irq_unregister_handler(unsigned int irq_num)
 
 int tftf_irq_handler_dispatcher(void)
 {
+	/* Sampled first so that it excludes as little of the latency as possible */
+	uint64_t entry_ticks = syscounter_read();
 	unsigned int raw_iar;
 	unsigned int irq_num;
+	unsigned int core_pos = irq_get_core_pos();
 	sgi_data_t sgi_data;
-	irq_handler_t *handler;
+	irq_handler_t handler;
+	irq_stats_t *stats;
 	void *irq_data = NULL;
+	uint64_t start, ticks;
 	int rc = 0;
 
 	/* Acknowledge the interrupt */
 	irq_num = arm_gic_intr_ack(&raw_iar);
 
-	handler = get_irq_handler(irq_num);
-	if (IS_PLAT_SPI(irq_num)) {
+	handler = __atomic_load_n(get_irq_handler(irq_num, core_pos),
+				  __ATOMIC_ACQUIRE);
+	if (IS_PLAT_SPI(irq_num) || IS_LPI(irq_num)) {
 		irq_data = &irq_num;
 	} else if (IS_PPI(irq_num)) {
 		irq_data = &irq_num;
@@ -184,8 +315,19 @@ int tftf_irq_handler_dispatcher(void)
 		irq_data = &sgi_data;
 	}
 
-	if (*handler != NULL)
-		rc = (*handler)(irq_data);
+	stats = &irq_stats[core_pos].irq[irq_stats_index(irq_num)];
+	stats->count++;
+	irq_stats[core_pos].entry_ticks = entry_ticks;
+
+	if (handler != NULL) {
+		start = syscounter_read();
+		rc = handler(irq_data);
+		ticks = syscounter_read() - start;
+
+		stats->ticks += ticks;
+		if (ticks > stats->max_ticks)
+			stats->max_ticks = ticks;
+	}
 
 	/* Mark the processing of the interrupt as complete */
 	if (irq_num != GIC_SPURIOUS_INTERRUPT)
@@ -197,8 +339,29 @@ int tftf_irq_handler_dispatcher(void)
 void tftf_irq_setup(void)
 {
 	memset(spi_desc_table, 0, sizeof(spi_desc_table));
+	memset(lpi_desc_table, 0, sizeof(lpi_desc_table));
 	memset(ppi_desc_table, 0, sizeof(ppi_desc_table));
 	memset(sgi_desc_table, 0, sizeof(sgi_desc_table));
 	memset(&spurious_desc_handler, 0, sizeof(spurious_desc_handler));
+	memset(irq_stats, 0, sizeof(irq_stats));
 	init_spinlock(&spi_lock);
 }
+
+void tftf_irq_get_stats(unsigned int core_pos, unsigned int irq_num,
+			irq_stats_t *stats)
+{
+	assert(core_pos < PLATFORM_CORE_COUNT);
+	assert(stats != NULL);
+
+	*stats = irq_stats[core_pos].irq[irq_stats_index(irq_num)];
+}
+
+uint64_t tftf_irq_get_entry_ticks(void)
+{
+	return irq_stats[irq_get_core_pos()].entry_ticks;
+}
+
+void tftf_irq_reset_stats(void)
+{
+	memset(irq_stats, 0, sizeof(irq_stats));
+}
@@ -43,19 +43,25 @@ static unsigned int next = 1;
   * October 1988, p. 1195.
 **/
 int
-rand()
+rand_r(unsigned int *ctx)
 {
   int hi, lo, x;
 
   /* Can't be initialized with 0, so use another value. */
-  if (next == 0)
-    next = 123459876;
-  hi = next / 127773;
-  lo = next % 127773;
+  if (*ctx == 0)
+    *ctx = 123459876;
+  hi = *ctx / 127773;
+  lo = *ctx % 127773;
   x = 16807 * lo - 2836 * hi;
   if (x < 0)
     x += 0x7fffffff;
-  return ((next = x) % ((unsigned int)RAND_MAX + 1));
+  return ((*ctx = x) % ((unsigned int)RAND_MAX + 1));
+}
+
+int
+rand()
+{
+  return (rand_r(&next));
 }
 
 void
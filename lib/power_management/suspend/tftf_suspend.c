@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,6 +8,7 @@
 #include <debug.h>
 #include <drivers/arm/arm_gic.h>
 #include <drivers/console.h>
+#include <irq.h>
 #include <platform.h>
 #include <power_management.h>
 #include <psci.h>
@@ -17,6 +18,10 @@
 #include <tftf_lib.h>
 #include "suspend_private.h"
 
+/* Time spent saving and restoring the global GIC context */
+static uint64_t gic_ctx_save_ticks;
+static uint64_t gic_ctx_restore_ticks;
+
 int32_t tftf_enter_suspend(const suspend_info_t *info,
 			   tftf_suspend_ctx_t *ctx)
 {
@@ -70,6 +75,8 @@ int32_t tftf_enter_suspend(const suspend_info_t *info,
 
 void tftf_restore_system_ctx(tftf_suspend_ctx_t *ctx)
 {
+	uint64_t start;
+
 	assert(ctx != NULL);
 	assert(ctx->save_system_context);
 
@@ -83,12 +90,16 @@ void tftf_restore_system_ctx(tftf_suspend_ctx_t *ctx)
 	INFO("Restoring system context\n");
 
 	/* restore the global GIC context */
+	start = syscounter_read();
 	arm_gic_restore_context_global();
+	gic_ctx_restore_ticks = syscounter_read() - start;
 	tftf_timer_gic_state_restore();
 }
 
 void tftf_save_system_ctx(tftf_suspend_ctx_t *ctx)
 {
+	uint64_t start;
+
 	assert(ctx != NULL);
 	assert(ctx->save_system_context);
 
@@ -96,7 +107,15 @@ void tftf_save_system_ctx(tftf_suspend_ctx_t *ctx)
 	INFO("Saving system context\n");
 
 	/* Save the global GIC context */
+	start = syscounter_read();
 	arm_gic_save_context_global();
+	gic_ctx_save_ticks = syscounter_read() - start;
+}
+
+void tftf_get_system_ctx_ticks(uint64_t *save_ticks, uint64_t *restore_ticks)
+{
+	*save_ticks = gic_ctx_save_ticks;
+	*restore_ticks = gic_ctx_restore_ticks;
 }
 
 int tftf_suspend(const suspend_info_t *info)
@@ -117,6 +136,7 @@ int tftf_suspend(const suspend_info_t *info)
 
 	/* Restore the local GIC context */
 	arm_gic_restore_context_local();
+	tftf_irq_setup_local();
 
 	/*
 	 * DAIF flags should be restored last because it could be an issue
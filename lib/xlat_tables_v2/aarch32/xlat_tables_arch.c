@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -99,6 +99,29 @@ void xlat_arch_tlbi_va(uintptr_t va, int xlat_regime)
 	}
 }
 
+void xlat_arch_tlbi_va_range(uintptr_t va, size_t size, int xlat_regime)
+{
+	size_t pages = size >> PAGE_SIZE_SHIFT;
+
+	/* There are no TLBI by range instructions in AArch32. */
+	if (pages <= XLAT_TLBI_RANGE_MAX_PAGES) {
+		for (size_t i = 0U; i < pages; i++) {
+			xlat_arch_tlbi_va(va + (i << PAGE_SIZE_SHIFT),
+					  xlat_regime);
+		}
+		return;
+	}
+
+	dsbishst();
+
+	if (xlat_regime == EL1_EL0_REGIME) {
+		tlbiallis();
+	} else {
+		assert(xlat_regime == EL2_REGIME);
+		tlbiallhis();
+	}
+}
+
 void xlat_arch_tlbi_va_sync(void)
 {
 	/* Invalidate all entries from branch predictors. */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -154,14 +154,8 @@ uint64_t xlat_arch_regime_get_xn_desc(int xlat_regime)
 	}
 }
 
-void xlat_arch_tlbi_va(uintptr_t va, int xlat_regime)
+static void xlat_arch_tlbi_page(uintptr_t va, int xlat_regime)
 {
-	/*
-	 * Ensure the translation table write has drained into memory before
-	 * invalidating the TLB entry.
-	 */
-	dsbishst();
-
 	/*
 	 * This function only supports invalidation of TLB entries for the EL3
 	 * and EL1&0 translation regimes.
@@ -182,6 +176,111 @@ void xlat_arch_tlbi_va(uintptr_t va, int xlat_regime)
 	}
 }
 
+void xlat_arch_tlbi_va(uintptr_t va, int xlat_regime)
+{
+	/*
+	 * Ensure the translation table write has drained into memory before
+	 * invalidating the TLB entry.
+	 */
+	dsbishst();
+
+	xlat_arch_tlbi_page(va, xlat_regime);
+}
+
+/* Invalidate all the TLB entries of the given translation regime. */
+static void xlat_arch_tlbi_all(int xlat_regime)
+{
+	if (xlat_regime == EL1_EL0_REGIME) {
+		assert(xlat_arch_current_el() >= 1U);
+		tlbivmalle1is();
+	} else if (xlat_regime == EL2_REGIME) {
+		assert(xlat_arch_current_el() >= 2U);
+		tlbialle2is();
+	} else {
+		assert(xlat_regime == EL3_REGIME);
+		assert(xlat_arch_current_el() >= 3U);
+		tlbialle3is();
+	}
+}
+
+/*
+ * Invalidate TLBI_RANGE_PAGES(num, scale) pages from `va` with one TLBI by
+ * range instruction.
+ */
+static void xlat_arch_tlbi_range(uintptr_t va, unsigned int num,
+				 unsigned int scale, int xlat_regime)
+{
+	uint64_t range = TLBI_RANGE(va, num, scale);
+
+	if (xlat_regime == EL1_EL0_REGIME) {
+		assert(xlat_arch_current_el() >= 1U);
+		tlbirvaae1is(range);
+	} else if (xlat_regime == EL2_REGIME) {
+		assert(xlat_arch_current_el() >= 2U);
+		tlbirvae2is(range);
+	} else {
+		assert(xlat_regime == EL3_REGIME);
+		assert(xlat_arch_current_el() >= 3U);
+		tlbirvae3is(range);
+	}
+}
+
+void xlat_arch_tlbi_va_range(uintptr_t va, size_t size, int xlat_regime)
+{
+	unsigned long pages = size >> PAGE_SIZE_SHIFT;
+	unsigned int scale = 0U;
+	unsigned int num;
+
+	/*
+	 * Ensure the translation table writes have drained into memory before
+	 * invalidating the TLB entries.
+	 */
+	dsbishst();
+
+	if (!is_feat_tlbirange_present()) {
+		if (pages > XLAT_TLBI_RANGE_MAX_PAGES) {
+			xlat_arch_tlbi_all(xlat_regime);
+			return;
+		}
+
+		for (unsigned long i = 0UL; i < pages; i++) {
+			xlat_arch_tlbi_page(va + (i << PAGE_SIZE_SHIFT),
+					    xlat_regime);
+		}
+		return;
+	}
+
+	/* The sum of all the ranges must be below TLBI_RANGE_MAX_PAGES */
+	if (pages >= TLBI_RANGE_MAX_PAGES) {
+		xlat_arch_tlbi_all(xlat_regime);
+		return;
+	}
+
+	/*
+	 * A range covers an even number of pages, so an odd page is
+	 * invalidated on its own first. Then, the ranges with increasing scales
+	 * invalidate the pages given by the next 5 bits of the number of pages.
+	 */
+	while (pages != 0UL) {
+		assert(scale <= TLBI_RANGE_SCALE_MAX);
+
+		if ((pages & 1UL) != 0UL) {
+			xlat_arch_tlbi_page(va, xlat_regime);
+			va += PAGE_SIZE;
+			pages--;
+			continue;
+		}
+
+		num = (pages >> ((5U * scale) + 1U)) & TLBI_RANGE_NUM_MAX;
+		if (num != 0U) {
+			xlat_arch_tlbi_range(va, num - 1U, scale, xlat_regime);
+			va += TLBI_RANGE_PAGES(num - 1U, scale) << PAGE_SIZE_SHIFT;
+			pages -= TLBI_RANGE_PAGES(num - 1U, scale);
+		}
+		scale++;
+	}
+}
+
 void xlat_arch_tlbi_va_sync(void)
 {
 	/*
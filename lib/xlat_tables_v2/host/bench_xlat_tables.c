@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Micro-benchmark of the dynamic regions of the translation tables library:
+ *  - adding and removing many small regions, in random order, which measures
+ *    the cost of the mmap array and table bookkeeping as the number of
+ *    regions grows;
+ *  - adding and removing large regions mapped with blocks and with pages;
+ *  - changing the attributes of a region mapped with pages.
+ * The number of TLB maintenance calls per operation is printed as well.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <xlat_tables_defs.h>
+#include <xlat_tables_v2.h>
+
+#include "xlat_host.h"
+
+#define VA_SPACE_SIZE		(1ULL << 39)
+#define PA_SPACE_SIZE		(1ULL << 39)
+#define MMAP_REGIONS		1024
+#define XLAT_TABLES		1024
+
+#define ROUNDS			20U
+#define SMALL_REGION_SIZE	(4U * PAGE_SIZE)
+#define SMALL_REGIONS_BASE	(1ULL << 32)
+#define LARGE_REGION_BASE	(1ULL << 36)
+
+REGISTER_XLAT_CONTEXT2(bench, MMAP_REGIONS, XLAT_TABLES, VA_SPACE_SIZE,
+		       PA_SPACE_SIZE, EL1_EL0_REGIME, "xlat_table");
+
+static xlat_ctx_t *const ctx = &bench_xlat_ctx;
+
+static unsigned int order[MMAP_REGIONS];
+
+/* Time and TLB maintenance calls of one kind of operation */
+struct phase {
+	uint64_t ns;
+	struct xlat_host_counters counters;
+};
+
+static uint64_t phase_start_ns;
+static struct xlat_host_counters phase_start_counters;
+
+static void phase_start(void)
+{
+	phase_start_counters = xlat_host_counters;
+	phase_start_ns = xlat_host_now_ns();
+}
+
+static void phase_end(struct phase *phase)
+{
+	phase->ns += xlat_host_now_ns() - phase_start_ns;
+	phase->counters.tlbi_va += xlat_host_counters.tlbi_va -
+				   phase_start_counters.tlbi_va;
+	phase->counters.tlbi_range += xlat_host_counters.tlbi_range -
+				      phase_start_counters.tlbi_range;
+	phase->counters.tlbi_range_pages +=
+		xlat_host_counters.tlbi_range_pages -
+		phase_start_counters.tlbi_range_pages;
+	phase->counters.tlbi_sync += xlat_host_counters.tlbi_sync -
+				     phase_start_counters.tlbi_sync;
+}
+
+static void report(const char *name, const struct phase *phase,
+		   unsigned long ops)
+{
+	const struct xlat_host_counters *c = &phase->counters;
+
+	printf("  %-24s %10.2f us/op  %6.1f TLBI/op (%8.1f pages)  %5.1f syncs/op\n",
+	       name, (double)phase->ns / (1000.0 * ops),
+	       (double)(c->tlbi_va + c->tlbi_range) / ops,
+	       (double)(c->tlbi_va + c->tlbi_range_pages) / ops,
+	       (double)c->tlbi_sync / ops);
+}
+
+static int bench_small(unsigned int count)
+{
+	struct phase add = { 0 }, remove = { 0 };
+	char name[32];
+	int rc;
+
+	for (unsigned int r = 0U; r < ROUNDS; r++) {
+		/* Regions one page apart, added and removed in random order */
+		for (unsigned int i = 0U; i < count; i++) {
+			order[i] = i;
+		}
+		for (unsigned int i = count - 1U; i > 0U; i--) {
+			unsigned int j = rand() % (i + 1U);
+			unsigned int tmp = order[i];
+
+			order[i] = order[j];
+			order[j] = tmp;
+		}
+
+		phase_start();
+		for (unsigned int i = 0U; i < count; i++) {
+			uintptr_t va = SMALL_REGIONS_BASE +
+				       (order[i] * (SMALL_REGION_SIZE + PAGE_SIZE));
+
+			rc = mmap_add_dynamic_region_ctx(ctx,
+				&(mmap_region_t)MAP_REGION_FLAT(va,
+					SMALL_REGION_SIZE, MT_DEVICE | MT_RW));
+			if (rc != 0) {
+				printf("  add: %d\n", rc);
+				return -1;
+			}
+		}
+		phase_end(&add);
+
+		for (unsigned int i = count - 1U; i > 0U; i--) {
+			unsigned int j = rand() % (i + 1U);
+			unsigned int tmp = order[i];
+
+			order[i] = order[j];
+			order[j] = tmp;
+		}
+
+		phase_start();
+		for (unsigned int i = 0U; i < count; i++) {
+			uintptr_t va = SMALL_REGIONS_BASE +
+				       (order[i] * (SMALL_REGION_SIZE + PAGE_SIZE));
+
+			rc = mmap_remove_dynamic_region_ctx(ctx, va,
+							    SMALL_REGION_SIZE);
+			if (rc != 0) {
+				printf("  remove: %d\n", rc);
+				return -1;
+			}
+		}
+		phase_end(&remove);
+	}
+
+	snprintf(name, sizeof(name), "add, %u regions", count);
+	report(name, &add, ROUNDS * count);
+	snprintf(name, sizeof(name), "remove, %u regions", count);
+	report(name, &remove, ROUNDS * count);
+
+	return 0;
+}
+
+static int bench_large(const char *name, unsigned long long pa, size_t size)
+{
+	struct phase add = { 0 }, remove = { 0 }, attr = { 0 };
+	bool pages = (pa % XLAT_BLOCK_SIZE(2U)) != 0U;
+	char label[40];
+	int rc;
+
+	for (unsigned int r = 0U; r < ROUNDS; r++) {
+		phase_start();
+		rc = mmap_add_dynamic_region_ctx(ctx,
+			&(mmap_region_t)MAP_REGION(pa, LARGE_REGION_BASE, size,
+						   MT_RW_DATA));
+		phase_end(&add);
+		if (rc != 0) {
+			printf("  add: %d\n", rc);
+			return -1;
+		}
+
+		if (pages) {
+			phase_start();
+			rc = xlat_change_mem_attributes_ctx(ctx,
+				LARGE_REGION_BASE, size, MT_RO_DATA);
+			phase_end(&attr);
+			if (rc != 0) {
+				printf("  change attributes: %d\n", rc);
+				return -1;
+			}
+		}
+
+		phase_start();
+		rc = mmap_remove_dynamic_region_ctx(ctx, LARGE_REGION_BASE,
+						    size);
+		phase_end(&remove);
+		if (rc != 0) {
+			printf("  remove: %d\n", rc);
+			return -1;
+		}
+	}
+
+	snprintf(label, sizeof(label), "add %s, %zu MiB", name, size >> 20);
+	report(label, &add, ROUNDS);
+	if (pages) {
+		snprintf(label, sizeof(label), "attributes, %zu MiB",
+			 size >> 20);
+		report(label, &attr, ROUNDS);
+	}
+	snprintf(label, sizeof(label), "remove %s, %zu MiB", name, size >> 20);
+	report(label, &remove, ROUNDS);
+
+	return 0;
+}
+
+int main(void)
+{
+	static const unsigned int counts[] = { 16U, 128U, 512U, 1000U };
+	xlat_tables_stats_t stats;
+
+	init_xlat_tables_ctx(ctx);
+
+	for (unsigned int i = 0U; i < (sizeof(counts) / sizeof(counts[0])); i++) {
+		if (bench_small(counts[i]) != 0) {
+			return 1;
+		}
+	}
+
+	if ((bench_large("blocks", LARGE_REGION_BASE, 1ULL << 30) != 0) ||
+	    (bench_large("pages", LARGE_REGION_BASE + PAGE_SIZE,
+			 64ULL << 20) != 0)) {
+		return 1;
+	}
+
+	xlat_get_tables_stats_ctx(ctx, &stats);
+	printf("  tables: peak %u of %u\n", stats.tables_peak, stats.tables_num);
+
+	return 0;
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/* Host version of the feature checks used by the translation tables library */
+
+#ifndef ARCH_FEATURES_H
+#define ARCH_FEATURES_H
+
+#include <stdbool.h>
+
+static inline bool is_armv8_5_bti_present(void)
+{
+	return false;
+}
+
+#endif /* ARCH_FEATURES_H */
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host version of the barriers and cache maintenance operations used by the
+ * translation tables library. The host harness is single threaded and the
+ * tables are only read by the software walker, so they have no effect.
+ */
+
+#ifndef ARCH_HELPERS_H
+#define ARCH_HELPERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+static inline void dsbish(void)
+{
+}
+
+static inline void dsbishst(void)
+{
+}
+
+static inline void dccvac(uintptr_t addr)
+{
+	(void)addr;
+}
+
+static inline void clean_dcache_range(uintptr_t addr, size_t size)
+{
+	(void)addr;
+	(void)size;
+}
+
+#endif /* ARCH_HELPERS_H */
@@ -0,0 +1,17 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Platform definitions of the host harness of the translation tables library.
+ * The contexts are registered by the tests, so nothing else is needed.
+ */
+
+#ifndef PLATFORM_DEF_H
+#define PLATFORM_DEF_H
+
+#define PLATFORM_CACHE_LINE_SIZE	64
+
+#endif /* PLATFORM_DEF_H */
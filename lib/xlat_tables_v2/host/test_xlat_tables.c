@@ -0,0 +1,641 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Randomized property test of the dynamic regions of the translation tables
+ * library.
+ *
+ * The VA space is split in slots, each of them holding at most one region, so
+ * that the expected state of the tables is known. A random sequence of
+ * additions, removals, attribute changes and invalid requests is applied to a
+ * context, and after each of them the test checks that:
+ *  - the pages of the regions translate to the right PA with the right
+ *    attributes, and the pages of the removed regions don't translate;
+ *  - no stale translation is left in the TLB model;
+ *  - the table bookkeeping and the mmap array are consistent.
+ * Every CHECK_ALL_PERIOD operations, and at the end, every block and page
+ * descriptor of the tables is checked against the regions, and against the
+ * profile of a snapshot of the tables.
+ *
+ *   test_xlat_tables [seed [operations]]
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <xlat_tables_defs.h>
+#include <xlat_tables_v2.h>
+
+#include "../xlat_tables_private.h"
+#include "xlat_host.h"
+
+#define VA_SPACE_SIZE		(1ULL << 36)
+#define PA_SPACE_SIZE		(1ULL << 36)
+#define MMAP_REGIONS		96
+#define XLAT_TABLES		128
+
+#define SIZE_2MB		XLAT_BLOCK_SIZE(2U)
+
+#define SLOTS			128U
+#define SLOT_SIZE		(VA_SPACE_SIZE / SLOTS)
+/* Slot 0 holds the static region */
+#define STATIC_SIZE		((64U * SIZE_2MB) + (3U * PAGE_SIZE))
+
+#define SNAPSHOT_SIZE		(64U * 1024U)
+
+#define DEFAULT_OPERATIONS	20000U
+#define CHECK_ALL_PERIOD	16U
+
+#define CHECK(cond)							\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAILED: %s:%d: %s (operation %u)\n",	\
+			       __FILE__, __LINE__, #cond, operation);	\
+			exit(1);					\
+		}							\
+	} while (0)
+
+REGISTER_XLAT_CONTEXT2(host, MMAP_REGIONS, XLAT_TABLES, VA_SPACE_SIZE,
+		       PA_SPACE_SIZE, EL1_EL0_REGIME, "xlat_table");
+
+static xlat_ctx_t *const ctx = &host_xlat_ctx;
+
+/* Region in each slot. A size of 0 means that the slot is free. */
+static mmap_region_t slots[SLOTS];
+static unsigned int live;
+static unsigned int operation;
+
+static uint64_t snapshot_buf[2][SNAPSHOT_SIZE / sizeof(uint64_t)];
+static xlat_snapshot_t *const initial_snap = (void *)snapshot_buf[0];
+static xlat_snapshot_t *const snap = (void *)snapshot_buf[1];
+
+enum op {
+	OP_ADD,
+	OP_REMOVE,
+	OP_CHANGE,
+	OP_INVALID,
+	OP_NUM
+};
+
+static const char *const op_names[OP_NUM] = {
+	"add", "remove", "change attr", "invalid"
+};
+
+static struct {
+	unsigned long count;
+	unsigned long failed;
+	uint64_t ns;
+} op_stats[OP_NUM];
+
+static const unsigned int attrs[] = {
+	MT_DEVICE | MT_RW,
+	MT_DEVICE | MT_RO,
+	MT_NON_CACHEABLE | MT_RW,
+	MT_RW_DATA,
+	MT_RO_DATA,
+	MT_CODE,
+};
+
+static uint64_t rand64(void)
+{
+	return ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+}
+
+static unsigned long long slot_pa(unsigned int slot)
+{
+	return ((slot * 37U) % SLOTS) * SLOT_SIZE;
+}
+
+/* Returns the region that maps `va`, or NULL */
+static const mmap_region_t *find_region(uintptr_t va)
+{
+	const mmap_region_t *mm = &slots[va / SLOT_SIZE];
+
+	if ((mm->size == 0U) || (va < mm->base_va) ||
+	    (va >= (mm->base_va + mm->size))) {
+		return NULL;
+	}
+
+	return mm;
+}
+
+/* Check the attributes of a block or page descriptor of region `mm` */
+static void check_desc(const mmap_region_t *mm, uint64_t desc)
+{
+	uint64_t xn = xlat_arch_regime_get_xn_desc(EL1_EL0_REGIME);
+	unsigned int index = (desc >> 2) & 0x7U;
+	bool want_xn;
+
+	switch (MT_TYPE(mm->attr)) {
+	case MT_DEVICE:
+		CHECK(index == ATTR_DEVICE_INDEX);
+		break;
+	case MT_NON_CACHEABLE:
+		CHECK(index == ATTR_NON_CACHEABLE_INDEX);
+		break;
+	default:
+		CHECK(index == ATTR_IWBWA_OWBWA_NTR_INDEX);
+		break;
+	}
+
+	CHECK(((desc & LOWER_ATTRS(AP_RO)) != 0U) ==
+	      ((mm->attr & MT_RW) == 0U));
+	CHECK(((desc & LOWER_ATTRS(NS)) != 0U) == ((mm->attr & MT_NS) != 0U));
+	CHECK(((desc & LOWER_ATTRS(AP_ACCESS_UNPRIVILEGED)) != 0U) ==
+	      ((mm->attr & MT_USER) != 0U));
+
+	want_xn = (MT_TYPE(mm->attr) == MT_DEVICE) ||
+		  ((mm->attr & (MT_RW | MT_EXECUTE_NEVER)) != 0U);
+	CHECK((desc & xn) == (want_xn ? xn : 0U));
+}
+
+/* Translate `va` through the TLB model and check it against the regions */
+static void check_va(uintptr_t va)
+{
+	const mmap_region_t *mm = find_region(va);
+	struct xlat_host_walk walk;
+
+	if (mm == NULL) {
+		CHECK(xlat_host_translate(ctx, va, &walk) != 0);
+		return;
+	}
+
+	CHECK(xlat_host_translate(ctx, va, &walk) == 0);
+	CHECK(walk.pa == (mm->base_pa + (va - mm->base_va)));
+	check_desc(mm, walk.desc);
+}
+
+/* Check the first, the last and a few random pages of a range */
+static void check_range(uintptr_t base_va, size_t size)
+{
+	size_t pages = size / PAGE_SIZE;
+
+	check_va(base_va);
+	check_va(base_va + size - PAGE_SIZE);
+	for (unsigned int i = 0U; i < 4U; i++) {
+		check_va(base_va + ((rand64() % pages) * PAGE_SIZE));
+	}
+}
+
+struct leaves {
+	size_t mapped[SLOTS];
+	unsigned long long descs[XLAT_TABLE_LEVEL_MAX + 1U];
+};
+
+static void check_leaf(uintptr_t va, size_t size, uint64_t desc,
+		       unsigned int level, void *arg)
+{
+	const mmap_region_t *mm = find_region(va);
+	unsigned long long pa = desc & TABLE_ADDR_MASK & XLAT_ADDR_MASK(level);
+	struct leaves *leaves = arg;
+
+	CHECK(mm != NULL);
+	CHECK((va + size) <= (mm->base_va + mm->size));
+	CHECK(pa == (mm->base_pa + (va - mm->base_va)));
+	check_desc(mm, desc);
+	leaves->mapped[va / SLOT_SIZE] += size;
+	leaves->descs[level]++;
+
+	if ((desc & UPPER_ATTRS(CONT_HINT)) == 0U) {
+		return;
+	}
+
+	/* The whole aligned run must be in the region and have the hint */
+	uintptr_t run_va = va & ~(uintptr_t)(XLAT_CONT_SIZE(level) - 1U);
+
+	CHECK((mm->attr & MT_CONT_HINT) != 0U);
+	CHECK(run_va >= mm->base_va);
+	CHECK((run_va + XLAT_CONT_SIZE(level)) <= (mm->base_va + mm->size));
+	if (va != run_va) {
+		return;
+	}
+
+	for (unsigned int i = 1U; i < XLAT_CONT_ENTRIES; i++) {
+		struct xlat_host_walk walk;
+
+		CHECK(xlat_host_walk(ctx, va + (i * size), &walk) == 0);
+		CHECK(walk.level == level);
+		CHECK(walk.desc == (desc + (i * size)));
+	}
+}
+
+/*
+ * Check every descriptor of the tables against the regions, and the profile of
+ * a snapshot of the tables against the descriptors.
+ */
+static void check_all(void)
+{
+	static struct leaves leaves;
+	xlat_snapshot_profile_t profile;
+	unsigned long long descs = 0U;
+	size_t mapped = 0U;
+
+	memset(&leaves, 0, sizeof(leaves));
+	xlat_host_for_each_leaf(ctx, check_leaf, &leaves);
+
+	for (unsigned int i = 0U; i < SLOTS; i++) {
+		CHECK(leaves.mapped[i] == slots[i].size);
+		mapped += slots[i].size;
+	}
+
+	CHECK(xlat_snapshot_ctx(ctx, snap, SNAPSHOT_SIZE) == 0);
+	CHECK(snap->regions == (live + 1U));
+	xlat_snapshot_get_profile(snap, &profile);
+	for (unsigned int level = 0U; level <= XLAT_TABLE_LEVEL_MAX; level++) {
+		CHECK(profile.descs[level] == leaves.descs[level]);
+		descs += leaves.descs[level];
+	}
+	CHECK(profile.mapped == mapped);
+	CHECK((profile.ideal_descs > 0U) && (profile.ideal_descs <= descs));
+	CHECK(profile.walk_depth >= 100U);
+	CHECK(profile.walk_depth <= (100U * (XLAT_TABLE_LEVEL_MAX + 1U -
+					    ctx->base_level)));
+}
+
+/*
+ * Check the profile of the initial tables, and that a region mapped with
+ * pages while it could use blocks shows up in the profile and in a diff.
+ */
+static void test_snapshot(void)
+{
+	unsigned int slot = SLOTS - 1U;
+	mmap_region_t mm = MAP_REGION_FULL_SPEC(slot_pa(slot), slot * SLOT_SIZE,
+						4U * SIZE_2MB, MT_RW_DATA,
+						PAGE_SIZE);
+	xlat_snapshot_profile_t profile;
+
+	CHECK(xlat_snapshot_ctx(ctx, initial_snap, sizeof(xlat_snapshot_t)) ==
+	      -ENOMEM);
+	CHECK(initial_snap->size > sizeof(xlat_snapshot_t));
+	CHECK(xlat_snapshot_ctx(ctx, initial_snap, initial_snap->size) == 0);
+
+	/* The static region is mapped with 64 level 2 blocks and 3 pages */
+	xlat_snapshot_get_profile(initial_snap, &profile);
+	CHECK(profile.descs[2] == 64U);
+	CHECK(profile.descs[3] == 3U);
+	CHECK(profile.ideal_descs == 67U);
+	CHECK(profile.fragmentation == 0U);
+	/* The 3 pages are too small to change the average walk depth */
+	CHECK(profile.walk_depth == (100U * (3U - ctx->base_level)));
+
+	CHECK(mmap_add_dynamic_region_ctx(ctx, &mm) == 0);
+	CHECK(xlat_snapshot_ctx(ctx, snap, SNAPSHOT_SIZE) == 0);
+	xlat_snapshot_get_profile(snap, &profile);
+	CHECK(profile.descs[3] == (3U + (4U * XLAT_TABLE_ENTRIES)));
+	CHECK(profile.ideal_descs == (67U + 4U));
+	CHECK(profile.fragmentation > 90U);
+	xlat_snapshot_print_profile(snap);
+
+	/* One new region and one new run of pages */
+	CHECK(xlat_snapshot_diff(initial_snap, snap) == 2U);
+
+	CHECK(mmap_remove_dynamic_region_ctx(ctx, mm.base_va, mm.size) == 0);
+	CHECK(xlat_snapshot_ctx(ctx, snap, SNAPSHOT_SIZE) == 0);
+	CHECK(xlat_snapshot_diff(initial_snap, snap) == 0U);
+	CHECK(snap->size == initial_snap->size);
+}
+
+/* Generate a region for a free slot */
+static void gen_region(unsigned int slot, mmap_region_t *mm)
+{
+	size_t offset, size;
+	unsigned long long pa_shift = 0U;
+
+	switch (rand() % 4) {
+	case 0:
+		/* A few pages */
+		size = (1U + (rand() % 64U)) * PAGE_SIZE;
+		offset = (rand() % 16384U) * PAGE_SIZE;
+		break;
+	case 1:
+		/* Level 2 blocks, maybe with contiguous runs */
+		size = (1U + (rand() % 40U)) * SIZE_2MB;
+		offset = (rand() % 32U) * SIZE_2MB;
+		break;
+	case 2:
+		/* Blocks and pages */
+		size = ((1U + (rand() % 8U)) * SIZE_2MB) +
+		       ((1U + (rand() % 511U)) * PAGE_SIZE);
+		offset = (rand() % 16384U) * PAGE_SIZE;
+		break;
+	default:
+		/* Large region, mapped with pages if the PA is shifted */
+		if ((rand() % 2) == 0) {
+			size = (8U + (rand() % 120U)) * SIZE_2MB;
+		} else {
+			size = (1U + (rand() % 16U)) * SIZE_2MB;
+			pa_shift = PAGE_SIZE;
+		}
+		offset = (rand() % 64U) * SIZE_2MB;
+		break;
+	}
+
+	mm->base_va = (slot * SLOT_SIZE) + offset;
+	mm->base_pa = slot_pa(slot) + offset + pa_shift;
+	mm->size = size;
+	mm->granularity = REGION_DEFAULT_GRANULARITY;
+	mm->attr = attrs[rand() % (sizeof(attrs) / sizeof(attrs[0]))];
+	if ((rand() % 2) == 0) {
+		mm->attr |= MT_NS;
+	}
+	if ((rand() % 4) == 0) {
+		mm->attr |= MT_USER;
+	}
+	if ((rand() % 4) != 0) {
+		mm->attr |= MT_CONT_HINT;
+	}
+}
+
+static unsigned int random_slot(bool used)
+{
+	unsigned int slot = 1U + (rand() % (SLOTS - 1U));
+
+	for (unsigned int i = 1U; i < SLOTS; i++) {
+		if ((slots[slot].size != 0U) == used) {
+			return slot;
+		}
+		slot = (slot % (SLOTS - 1U)) + 1U;
+	}
+
+	return 0U;
+}
+
+static int op_add(void)
+{
+	unsigned int slot = random_slot(false);
+	mmap_region_t mm;
+	uint64_t start;
+	int rc;
+
+	if (slot == 0U) {
+		return -1;
+	}
+
+	gen_region(slot, &mm);
+	start = xlat_host_now_ns();
+	rc = mmap_add_dynamic_region_ctx(ctx, &mm);
+	op_stats[OP_ADD].ns += xlat_host_now_ns() - start;
+
+	/* Running out of tables or mmap entries is the only allowed error */
+	CHECK((rc == 0) || (rc == -ENOMEM));
+	if (rc == 0) {
+		CHECK((mm.attr & MT_DYNAMIC) != 0U);
+		slots[slot] = mm;
+		live++;
+	} else {
+		op_stats[OP_ADD].failed++;
+	}
+
+	check_range(mm.base_va, mm.size);
+	return 0;
+}
+
+static int op_remove(void)
+{
+	unsigned int slot = random_slot(true);
+	mmap_region_t mm;
+	uint64_t start;
+
+	if (slot == 0U) {
+		return -1;
+	}
+
+	mm = slots[slot];
+
+	/* Fill the TLB model with translations of the region */
+	check_range(mm.base_va, mm.size);
+
+	start = xlat_host_now_ns();
+	CHECK(mmap_remove_dynamic_region_ctx(ctx, mm.base_va, mm.size) == 0);
+	op_stats[OP_REMOVE].ns += xlat_host_now_ns() - start;
+
+	slots[slot].size = 0U;
+	live--;
+
+	check_range(mm.base_va, mm.size);
+	return 0;
+}
+
+static int op_change(void)
+{
+	static const unsigned int perms[] = {
+		MT_RW | MT_EXECUTE_NEVER,
+		MT_RO | MT_EXECUTE_NEVER,
+		MT_RO | MT_EXECUTE,
+	};
+	unsigned int slot = random_slot(true);
+	struct xlat_host_walk walk;
+	mmap_region_t *mm;
+	unsigned int attr;
+	bool pages = true;
+	uint64_t start;
+	uintptr_t va;
+	int rc;
+
+	if (slot == 0U) {
+		return -1;
+	}
+
+	mm = &slots[slot];
+
+	/* Device memory can't be made executable */
+	do {
+		attr = perms[rand() % (sizeof(perms) / sizeof(perms[0]))];
+	} while ((MT_TYPE(mm->attr) != MT_MEMORY) &&
+		 ((attr & MT_EXECUTE_NEVER) == 0U));
+	if ((rand() % 4) == 0) {
+		attr |= MT_USER;
+	}
+
+	/* Only regions mapped with pages can be changed */
+	for (va = mm->base_va; va < (mm->base_va + mm->size);
+	     va = walk.block_va + XLAT_BLOCK_SIZE(walk.level)) {
+		CHECK(xlat_host_walk(ctx, va, &walk) == 0);
+		if (walk.level != XLAT_TABLE_LEVEL_MAX) {
+			pages = false;
+			break;
+		}
+	}
+
+	check_range(mm->base_va, mm->size);
+
+	/* Part of a contiguous run of pages can't be changed */
+	for (va = mm->base_va; pages && (va < (mm->base_va + mm->size));
+	     va += PAGE_SIZE) {
+		CHECK(xlat_host_walk(ctx, va, &walk) == 0);
+		if ((walk.desc & UPPER_ATTRS(CONT_HINT)) != 0U) {
+			CHECK(xlat_change_mem_attributes_ctx(ctx, va, PAGE_SIZE,
+							     attr) == -EINVAL);
+			check_range(mm->base_va, mm->size);
+			break;
+		}
+	}
+
+	start = xlat_host_now_ns();
+	rc = xlat_change_mem_attributes_ctx(ctx, mm->base_va, mm->size, attr);
+	op_stats[OP_CHANGE].ns += xlat_host_now_ns() - start;
+
+	if (!pages) {
+		CHECK(rc == -EINVAL);
+		op_stats[OP_CHANGE].failed++;
+	} else {
+		CHECK(rc == 0);
+		mm->attr &= ~(MT_RW | MT_EXECUTE_NEVER | MT_USER);
+		mm->attr |= attr;
+	}
+
+	check_range(mm->base_va, mm->size);
+	return 0;
+}
+
+/*
+ * Overlapping additions fail with -EPERM, unless the mmap array is full, which
+ * is checked first.
+ */
+static bool add_rejected(int rc)
+{
+	if (ctx->mmap_regions == ctx->mmap_num) {
+		return rc == -ENOMEM;
+	}
+
+	return rc == -EPERM;
+}
+
+static int op_invalid(void)
+{
+	unsigned int slot = random_slot(true);
+	const mmap_region_t *used;
+	mmap_region_t mm;
+	uint64_t start;
+
+	if (slot == 0U) {
+		return -1;
+	}
+
+	used = &slots[slot];
+	start = xlat_host_now_ns();
+
+	/* Partial VA overlap */
+	mm = *used;
+	mm.base_va += (used->size / 2U) & ~(size_t)PAGE_SIZE_MASK;
+	mm.base_pa = slot_pa(slot) + SLOT_SIZE - used->size - PAGE_SIZE;
+	CHECK(add_rejected(mmap_add_dynamic_region_ctx(ctx, &mm)));
+
+	/* Same region twice */
+	mm = *used;
+	CHECK(add_rejected(mmap_add_dynamic_region_ctx(ctx, &mm)));
+
+	/* PA overlap with a region of another slot */
+	mm = *used;
+	mm.base_va = (0U * SLOT_SIZE) + (SLOT_SIZE - used->size);
+	CHECK(add_rejected(mmap_add_dynamic_region_ctx(ctx, &mm)));
+
+	/* Wrong size, static region */
+	CHECK(mmap_remove_dynamic_region_ctx(ctx, used->base_va,
+					     used->size + PAGE_SIZE) == -EINVAL);
+	CHECK(mmap_remove_dynamic_region_ctx(ctx, slots[0].base_va,
+					     slots[0].size) == -EPERM);
+
+	op_stats[OP_INVALID].ns += xlat_host_now_ns() - start;
+
+	check_range(used->base_va, used->size);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int seed = 1U;
+	unsigned int operations = DEFAULT_OPERATIONS;
+	xlat_tables_stats_t stats;
+	uint64_t start = xlat_host_now_ns();
+	int rc;
+
+	if (argc > 1) {
+		seed = strtoul(argv[1], NULL, 0);
+	}
+	if (argc > 2) {
+		operations = strtoul(argv[2], NULL, 0);
+	}
+	srand(seed);
+
+	slots[0] = (mmap_region_t)MAP_REGION_FLAT(0U, STATIC_SIZE, MT_RW_DATA);
+	mmap_add_region_ctx(ctx, &slots[0]);
+	init_xlat_tables_ctx(ctx);
+	CHECK(xlat_host_check_tables(ctx) == 0);
+	check_all();
+	test_snapshot();
+
+	for (operation = 0U; operation < operations; operation++) {
+		enum op op;
+		int r = rand() % 10;
+
+		if (r < 4) {
+			op = OP_ADD;
+			rc = op_add();
+		} else if (r < 7) {
+			op = OP_REMOVE;
+			rc = op_remove();
+		} else if (r < 9) {
+			op = OP_CHANGE;
+			rc = op_change();
+		} else {
+			op = OP_INVALID;
+			rc = op_invalid();
+		}
+
+		if (rc != 0) {
+			continue;
+		}
+		op_stats[op].count++;
+
+		CHECK(xlat_host_tlb_check(ctx) == 0);
+		CHECK(xlat_host_check_tables(ctx) == 0);
+		if ((operation % CHECK_ALL_PERIOD) == 0U) {
+			check_all();
+		}
+	}
+
+	/* Remove everything */
+	for (unsigned int i = 1U; i < SLOTS; i++) {
+		if (slots[i].size != 0U) {
+			CHECK(mmap_remove_dynamic_region_ctx(ctx,
+					slots[i].base_va, slots[i].size) == 0);
+			slots[i].size = 0U;
+			live--;
+		}
+	}
+	check_all();
+	CHECK(xlat_host_tlb_check(ctx) == 0);
+	CHECK(xlat_host_check_tables(ctx) == 0);
+
+	xlat_get_tables_stats_ctx(ctx, &stats);
+	CHECK(stats.regions == 1U);
+
+	/* The tables must be back to their initial state */
+	CHECK(xlat_snapshot_ctx(ctx, snap, SNAPSHOT_SIZE) == 0);
+	CHECK(xlat_snapshot_diff(initial_snap, snap) == 0U);
+
+	printf("  seed %u: %u operations in %.2f s, peak %u/%u tables\n",
+	       seed, operations,
+	       (double)(xlat_host_now_ns() - start) / 1000000000.0,
+	       stats.tables_peak, stats.tables_num);
+	for (unsigned int i = 0U; i < OP_NUM; i++) {
+		printf("  %-12s %6lu (%lu failed) %8.1f us/op\n", op_names[i],
+		       op_stats[i].count, op_stats[i].failed,
+		       (op_stats[i].count == 0U) ? 0.0 :
+		       (double)op_stats[i].ns / (1000.0 * op_stats[i].count));
+	}
+	printf("  TLBI: %lu by VA, %lu by range (%llu pages), %lu syncs\n",
+	       xlat_host_counters.tlbi_va, xlat_host_counters.tlbi_range,
+	       xlat_host_counters.tlbi_range_pages,
+	       xlat_host_counters.tlbi_sync);
+
+	printf("PASSED\n");
+	return 0;
+}
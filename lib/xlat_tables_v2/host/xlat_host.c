@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <xlat_tables_defs.h>
+#include <xlat_tables_v2.h>
+
+#include "../xlat_tables_private.h"
+#include "xlat_host.h"
+
+/*
+ * Number of translations cached by the TLB model. It is small so that the
+ * entries get replaced, as in a real TLB.
+ */
+#define XLAT_HOST_TLB_ENTRIES	64U
+
+struct xlat_host_counters xlat_host_counters;
+
+static struct {
+	bool valid;
+	uintptr_t va;
+	size_t size;
+	uint64_t desc;
+	unsigned int level;
+} tlb[XLAT_HOST_TLB_ENTRIES];
+
+static unsigned int tlb_next;
+
+/* Set by the invalidations, cleared by xlat_arch_tlbi_va_sync() */
+static bool tlbi_pending;
+
+/*
+ * Stubs of the hooks of the library
+ */
+
+void mp_printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+}
+
+void do_panic(const char *file, int line)
+{
+	printf("PANIC: %s:%d\n", file, line);
+	abort();
+}
+
+unsigned int xlat_arch_current_el(void)
+{
+	return 1U;
+}
+
+bool is_mmu_enabled_ctx(const xlat_ctx_t *ctx)
+{
+	(void)ctx;
+	return false;
+}
+
+bool is_dcache_enabled(void)
+{
+	return true;
+}
+
+unsigned long long xlat_arch_get_max_supported_pa(void)
+{
+	return (1ULL << 48) - 1ULL;
+}
+
+uintptr_t xlat_get_min_virt_addr_space_size(void)
+{
+	return MIN_VIRT_ADDR_SPACE_SIZE;
+}
+
+uint64_t xlat_arch_regime_get_xn_desc(int xlat_regime)
+{
+	if (xlat_regime == EL1_EL0_REGIME) {
+		return UPPER_ATTRS(UXN) | UPPER_ATTRS(PXN);
+	} else {
+		return UPPER_ATTRS(XN);
+	}
+}
+
+/* Invalidate the cached translations that overlap [va, va + size) */
+static void tlb_invalidate(uintptr_t va, size_t size)
+{
+	for (unsigned int i = 0U; i < XLAT_HOST_TLB_ENTRIES; i++) {
+		if (tlb[i].valid && (tlb[i].va < (va + size)) &&
+		    (va < (tlb[i].va + tlb[i].size))) {
+			tlb[i].valid = false;
+		}
+	}
+	tlbi_pending = true;
+}
+
+void xlat_arch_tlbi_va(uintptr_t va, int xlat_regime)
+{
+	(void)xlat_regime;
+
+	xlat_host_counters.tlbi_va++;
+	tlb_invalidate(va & ~(uintptr_t)PAGE_SIZE_MASK, PAGE_SIZE);
+}
+
+void xlat_arch_tlbi_va_range(uintptr_t va, size_t size, int xlat_regime)
+{
+	(void)xlat_regime;
+
+	xlat_host_counters.tlbi_range++;
+	xlat_host_counters.tlbi_range_pages += size / PAGE_SIZE;
+	tlb_invalidate(va, size);
+}
+
+void xlat_arch_tlbi_va_sync(void)
+{
+	xlat_host_counters.tlbi_sync++;
+	tlbi_pending = false;
+}
+
+/*
+ * Software walker
+ */
+
+static uint64_t *table_of(uint64_t desc)
+{
+	return (uint64_t *)(uintptr_t)(desc & TABLE_ADDR_MASK);
+}
+
+int xlat_host_walk(const xlat_ctx_t *ctx, uintptr_t va,
+		   struct xlat_host_walk *walk)
+{
+	const uint64_t *table = ctx->base_table;
+	unsigned int level = ctx->base_level;
+	unsigned int idx;
+	uint64_t desc;
+
+	if (va > ctx->va_max_address) {
+		return -1;
+	}
+
+	idx = va >> XLAT_ADDR_SHIFT(level);
+	for (;;) {
+		desc = table[idx];
+
+		if ((level < XLAT_TABLE_LEVEL_MAX) &&
+		    ((desc & DESC_MASK) == TABLE_DESC)) {
+			table = table_of(desc);
+			level++;
+			idx = XLAT_TABLE_IDX(va, level);
+			continue;
+		}
+
+		if (((level < XLAT_TABLE_LEVEL_MAX) &&
+		     ((desc & DESC_MASK) != BLOCK_DESC)) ||
+		    ((level == XLAT_TABLE_LEVEL_MAX) &&
+		     ((desc & DESC_MASK) != PAGE_DESC))) {
+			return -1;
+		}
+
+		walk->desc = desc;
+		walk->level = level;
+		walk->block_va = va & ~(uintptr_t)XLAT_BLOCK_MASK(level);
+		walk->pa = (desc & TABLE_ADDR_MASK & XLAT_ADDR_MASK(level)) +
+			   (va & XLAT_BLOCK_MASK(level));
+		return 0;
+	}
+}
+
+int xlat_host_translate(const xlat_ctx_t *ctx, uintptr_t va,
+			struct xlat_host_walk *walk)
+{
+	for (unsigned int i = 0U; i < XLAT_HOST_TLB_ENTRIES; i++) {
+		if (tlb[i].valid && (va >= tlb[i].va) &&
+		    (va < (tlb[i].va + tlb[i].size))) {
+			walk->desc = tlb[i].desc;
+			walk->level = tlb[i].level;
+			walk->block_va = tlb[i].va;
+			walk->pa = (tlb[i].desc & TABLE_ADDR_MASK &
+				    XLAT_ADDR_MASK(tlb[i].level)) +
+				   (va - tlb[i].va);
+			return 0;
+		}
+	}
+
+	if (xlat_host_walk(ctx, va, walk) != 0) {
+		return -1;
+	}
+
+	tlb[tlb_next].valid = true;
+	tlb[tlb_next].va = walk->block_va;
+	tlb[tlb_next].size = XLAT_BLOCK_SIZE(walk->level);
+	tlb[tlb_next].desc = walk->desc;
+	tlb[tlb_next].level = walk->level;
+	tlb_next = (tlb_next + 1U) % XLAT_HOST_TLB_ENTRIES;
+
+	return 0;
+}
+
+void xlat_host_tlb_flush(void)
+{
+	memset(tlb, 0, sizeof(tlb));
+	tlbi_pending = false;
+}
+
+int xlat_host_tlb_check(const xlat_ctx_t *ctx)
+{
+	struct xlat_host_walk walk;
+	int errors = 0;
+
+	if (tlbi_pending) {
+		printf("TLB invalidation not synchronised\n");
+		errors++;
+	}
+
+	for (unsigned int i = 0U; i < XLAT_HOST_TLB_ENTRIES; i++) {
+		if (!tlb[i].valid) {
+			continue;
+		}
+
+		if ((xlat_host_walk(ctx, tlb[i].va, &walk) != 0) ||
+		    (walk.desc != tlb[i].desc) ||
+		    (walk.level != tlb[i].level)) {
+			printf("Stale TLB entry: VA 0x%lx level %u desc 0x%llx\n",
+			       (unsigned long)tlb[i].va, tlb[i].level,
+			       (unsigned long long)tlb[i].desc);
+			errors++;
+		}
+	}
+
+	return errors;
+}
+
+static void for_each_leaf(const uint64_t *table, unsigned int entries,
+			  uintptr_t table_va, unsigned int level,
+			  xlat_host_leaf_fn fn, void *arg)
+{
+	for (unsigned int i = 0U; i < entries; i++) {
+		uintptr_t va = table_va + (i * XLAT_BLOCK_SIZE(level));
+		uint64_t desc = table[i];
+
+		if ((level < XLAT_TABLE_LEVEL_MAX) &&
+		    ((desc & DESC_MASK) == TABLE_DESC)) {
+			for_each_leaf(table_of(desc), XLAT_TABLE_ENTRIES, va,
+				      level + 1U, fn, arg);
+		} else if (((level < XLAT_TABLE_LEVEL_MAX) &&
+			    ((desc & DESC_MASK) == BLOCK_DESC)) ||
+			   ((level == XLAT_TABLE_LEVEL_MAX) &&
+			    ((desc & DESC_MASK) == PAGE_DESC))) {
+			fn(va, XLAT_BLOCK_SIZE(level), desc, level, arg);
+		}
+	}
+}
+
+void xlat_host_for_each_leaf(const xlat_ctx_t *ctx, xlat_host_leaf_fn fn,
+			     void *arg)
+{
+	for_each_leaf(ctx->base_table, ctx->base_table_entries, 0U,
+		      ctx->base_level, fn, arg);
+}
+
+/*
+ * Mark the sub-tables referenced from `table` in `reachable`. Returns the
+ * number of errors found.
+ */
+static int mark_tables(const xlat_ctx_t *ctx, const uint64_t *table,
+		       unsigned int entries, unsigned int level,
+		       bool *reachable)
+{
+	int errors = 0;
+
+	if (level == XLAT_TABLE_LEVEL_MAX) {
+		return 0;
+	}
+
+	for (unsigned int i = 0U; i < entries; i++) {
+		const uint64_t *subtable;
+		ptrdiff_t idx;
+
+		if ((table[i] & DESC_MASK) != TABLE_DESC) {
+			continue;
+		}
+
+		subtable = table_of(table[i]);
+		idx = (subtable - ctx->tables[0]) / XLAT_TABLE_ENTRIES;
+		if ((subtable < ctx->tables[0]) || (idx >= ctx->tables_num) ||
+		    (ctx->tables[idx] != subtable)) {
+			printf("Table descriptor to 0x%llx outside of the tables\n",
+			       (unsigned long long)table[i]);
+			errors++;
+			continue;
+		}
+		if (reachable[idx]) {
+			printf("Table %d referenced twice\n", (int)idx);
+			errors++;
+			continue;
+		}
+
+		reachable[idx] = true;
+		errors += mark_tables(ctx, subtable, XLAT_TABLE_ENTRIES,
+				      level + 1U, reachable);
+	}
+
+	return errors;
+}
+
+int xlat_host_check_tables(const xlat_ctx_t *ctx)
+{
+	bool *reachable = calloc(ctx->tables_num, sizeof(bool));
+	xlat_tables_stats_t stats;
+	int errors, used = 0;
+
+	if (reachable == NULL) {
+		printf("Out of memory\n");
+		return 1;
+	}
+
+	errors = mark_tables(ctx, ctx->base_table, ctx->base_table_entries,
+			     ctx->base_level, reachable);
+
+	for (int i = 0; i < ctx->tables_num; i++) {
+		bool is_free = (ctx->tables_free_map[i / 64] &
+				(1ULL << (63 - (i % 64)))) != 0ULL;
+
+		if (reachable[i]) {
+			used++;
+		}
+		if (reachable[i] != (ctx->tables_mapped_regions[i] > 0)) {
+			printf("Table %d: reachable %d, mapped regions %d\n", i,
+			       reachable[i], ctx->tables_mapped_regions[i]);
+			errors++;
+		}
+		if (reachable[i] == is_free) {
+			printf("Table %d: reachable %d, free %d\n", i,
+			       reachable[i], is_free);
+			errors++;
+		}
+	}
+	free(reachable);
+
+	xlat_get_tables_stats_ctx(ctx, &stats);
+	if ((stats.tables_used != (unsigned int)used) ||
+	    (stats.tables_peak < stats.tables_used)) {
+		printf("Tables in use %d, stats say %u, peak %u\n", used,
+		       stats.tables_used, stats.tables_peak);
+		errors++;
+	}
+
+	for (int i = 0; i <= ctx->mmap_num; i++) {
+		const mmap_region_t *mm = &ctx->mmap[i];
+
+		if ((i < ctx->mmap_regions) != (mm->size != 0U)) {
+			printf("mmap entry %d: size 0x%zx, %d regions\n", i,
+			       mm->size, ctx->mmap_regions);
+			errors++;
+		}
+		if ((i > 0) && (i < ctx->mmap_regions)) {
+			uintptr_t prev_end = mm[-1].base_va + mm[-1].size - 1U;
+			uintptr_t end = mm->base_va + mm->size - 1U;
+
+			if ((prev_end > end) ||
+			    ((prev_end == end) && (mm[-1].size >= mm->size))) {
+				printf("mmap entries %d and %d out of order\n",
+				       i - 1, i);
+				errors++;
+			}
+		}
+	}
+
+	return errors;
+}
+
+uint64_t xlat_host_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000U) + ts.tv_nsec;
+}
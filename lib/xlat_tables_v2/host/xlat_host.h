@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host harness of the translation tables library: stubs of the architectural
+ * hooks, a software translation table walker, a model of a TLB used to detect
+ * missing invalidations, and checks of the table bookkeeping of a context.
+ */
+
+#ifndef XLAT_HOST_H
+#define XLAT_HOST_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <xlat_tables_v2.h>
+
+/* Calls made by the library to the TLB maintenance hooks */
+struct xlat_host_counters {
+	unsigned long tlbi_va;
+	unsigned long tlbi_range;
+	unsigned long long tlbi_range_pages;
+	unsigned long tlbi_sync;
+};
+
+extern struct xlat_host_counters xlat_host_counters;
+
+/* Block or page descriptor found by the software walker for a VA */
+struct xlat_host_walk {
+	uint64_t desc;
+	unsigned int level;
+	/* Base VA of the block or page, and PA of the translated VA */
+	uintptr_t block_va;
+	unsigned long long pa;
+};
+
+/*
+ * Walk the translation tables of `ctx` to translate `va`. Returns 0 and fills
+ * `walk` if `va` is mapped, -1 otherwise.
+ */
+int xlat_host_walk(const xlat_ctx_t *ctx, uintptr_t va,
+		   struct xlat_host_walk *walk);
+
+/*
+ * Translate `va` through the TLB model. Translations that miss in it are done
+ * with xlat_host_walk() and cached.
+ */
+int xlat_host_translate(const xlat_ctx_t *ctx, uintptr_t va,
+			struct xlat_host_walk *walk);
+
+/* Empty the TLB model */
+void xlat_host_tlb_flush(void);
+
+/*
+ * Check that every translation cached by the TLB model is still the one in
+ * the translation tables of `ctx`, and that every invalidation has been
+ * completed with xlat_arch_tlbi_va_sync(). Returns the number of errors found.
+ */
+int xlat_host_tlb_check(const xlat_ctx_t *ctx);
+
+/* Called for each block or page descriptor of a set of translation tables */
+typedef void (*xlat_host_leaf_fn)(uintptr_t va, size_t size, uint64_t desc,
+				  unsigned int level, void *arg);
+
+/*
+ * Call `fn` for each block and page descriptor of the translation tables of
+ * `ctx`, in ascending VA order.
+ */
+void xlat_host_for_each_leaf(const xlat_ctx_t *ctx, xlat_host_leaf_fn fn,
+			     void *arg);
+
+/*
+ * Check the bookkeeping of the tables and of the mmap array of `ctx`:
+ *  - a sub-table maps regions and isn't in the free bitmap if and only if it
+ *    is referenced by a table descriptor;
+ *  - the table statistics match the tables in use;
+ *  - the mmap array is sorted and holds as many regions as counted.
+ * Returns the number of errors found.
+ */
+int xlat_host_check_tables(const xlat_ctx_t *ctx);
+
+/* Monotonic time in nanoseconds */
+uint64_t xlat_host_now_ns(void);
+
+#endif /* XLAT_HOST_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -117,6 +117,16 @@ int xlat_change_mem_attributes(uintptr_t base_va, size_t size, uint32_t attr)
 	return xlat_change_mem_attributes_ctx(&tf_xlat_ctx, base_va, size, attr);
 }
 
+void xlat_get_tables_stats(xlat_tables_stats_t *stats)
+{
+	xlat_get_tables_stats_ctx(&tf_xlat_ctx, stats);
+}
+
+int xlat_snapshot(xlat_snapshot_t *snap, size_t size)
+{
+	return xlat_snapshot_ctx(&tf_xlat_ctx, snap, size);
+}
+
 /*
  * If dynamic allocation of new regions is disabled then by the time we call the
  * function enabling the MMU, we'll have registered all the memory regions to
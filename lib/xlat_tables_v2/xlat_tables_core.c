@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -40,45 +40,92 @@ static inline __attribute__((unused)) void xlat_clean_dcache_range(uintptr_t add
  */
 static int xlat_table_get_index(const xlat_ctx_t *ctx, const uint64_t *table)
 {
-	for (int i = 0; i < ctx->tables_num; i++)
-		if (ctx->tables[i] == table)
-			return i;
+	ptrdiff_t offset = table - ctx->tables[0];
 
 	/*
 	 * Maybe we were asked to get the index of the base level table, which
 	 * should never happen.
 	 */
-	assert(false);
+	assert((offset >= 0) &&
+	       (offset < ((ptrdiff_t)ctx->tables_num * XLAT_TABLE_ENTRIES)));
+	assert((offset % XLAT_TABLE_ENTRIES) == 0);
 
-	return -1;
+	return (int)(offset / XLAT_TABLE_ENTRIES);
+}
+
+/* Bit of the free tables bitmap of the table with the given index. */
+static inline uint64_t xlat_table_free_bit(int idx)
+{
+	return 1ULL << (63 - (idx % 64));
+}
+
+/* Marks all the tables of the context as free. */
+static void xlat_tables_free_map_init(xlat_ctx_t *ctx)
+{
+	int words = (ctx->tables_num + 63) / 64;
+
+	for (int i = 0; i < words; i++)
+		ctx->tables_free_map[i] = ~0ULL;
+
+	/* Clear the bits of the tables that don't exist */
+	if ((ctx->tables_num % 64) != 0)
+		ctx->tables_free_map[words - 1] =
+			~(~0ULL >> (ctx->tables_num % 64));
+
+	ctx->tables_used = 0;
+	ctx->tables_peak = 0;
 }
 
 /* Returns a pointer to an empty translation table. */
 static uint64_t *xlat_table_get_empty(const xlat_ctx_t *ctx)
 {
-	for (int i = 0; i < ctx->tables_num; i++)
-		if (ctx->tables_mapped_regions[i] == 0)
-			return ctx->tables[i];
+	int words = (ctx->tables_num + 63) / 64;
+
+	for (int i = 0; i < words; i++) {
+		if (ctx->tables_free_map[i] != 0ULL) {
+			int idx = (i * 64) +
+				  __builtin_clzll(ctx->tables_free_map[i]);
+
+			assert(ctx->tables_mapped_regions[idx] == 0);
+			return ctx->tables[idx];
+		}
+	}
 
 	return NULL;
 }
 
-/* Increments region count for a given table. */
-static void xlat_table_inc_regions_count(const xlat_ctx_t *ctx,
+/*
+ * Increments region count for a given table. The table stops being free when
+ * it maps its first region.
+ */
+static void xlat_table_inc_regions_count(xlat_ctx_t *ctx,
 					 const uint64_t *table)
 {
 	int idx = xlat_table_get_index(ctx, table);
 
-	ctx->tables_mapped_regions[idx]++;
+	if (ctx->tables_mapped_regions[idx]++ == 0) {
+		ctx->tables_free_map[idx / 64] &= ~xlat_table_free_bit(idx);
+		ctx->tables_used++;
+		if (ctx->tables_used > ctx->tables_peak)
+			ctx->tables_peak = ctx->tables_used;
+	}
 }
 
-/* Decrements region count for a given table. */
-static void xlat_table_dec_regions_count(const xlat_ctx_t *ctx,
+/*
+ * Decrements region count for a given table. The table becomes free when it
+ * doesn't map any region anymore.
+ */
+static void xlat_table_dec_regions_count(xlat_ctx_t *ctx,
 					 const uint64_t *table)
 {
 	int idx = xlat_table_get_index(ctx, table);
 
-	ctx->tables_mapped_regions[idx]--;
+	assert(ctx->tables_mapped_regions[idx] > 0);
+
+	if (--ctx->tables_mapped_regions[idx] == 0) {
+		ctx->tables_free_map[idx / 64] |= xlat_table_free_bit(idx);
+		ctx->tables_used--;
+	}
 }
 
 /* Returns 0 if the specified table isn't empty, otherwise 1. */
@@ -335,7 +382,8 @@ static action_t xlat_tables_unmap_region_action(const mmap_region_t *mm,
 }
 /*
  * Recursive function that writes to the translation tables and unmaps the
- * specified region.
+ * specified region. The caller must invalidate the TLB entries of the region
+ * afterwards, with a single call to xlat_arch_tlbi_va_range().
  */
 static void xlat_tables_unmap_region(xlat_ctx_t *ctx, mmap_region_t *mm,
 				     const uintptr_t table_base_va,
@@ -372,7 +420,6 @@ static void xlat_tables_unmap_region(xlat_ctx_t *ctx, mmap_region_t *mm,
 		if (action == ACTION_WRITE_BLOCK_ENTRY) {
 
 			table_base[table_idx] = INVALID_DESC;
-			xlat_arch_tlbi_va(table_idx_va, ctx->xlat_regime);
 
 		} else if (action == ACTION_RECURSE_INTO_TABLE) {
 
@@ -391,8 +438,6 @@ static void xlat_tables_unmap_region(xlat_ctx_t *ctx, mmap_region_t *mm,
 			 */
 			if (xlat_table_is_empty(ctx, subtable)) {
 				table_base[table_idx] = INVALID_DESC;
-				xlat_arch_tlbi_va(table_idx_va,
-						  ctx->xlat_regime);
 			}
 
 		} else {
@@ -544,6 +589,73 @@ static action_t xlat_tables_map_region_action(const mmap_region_t *mm,
 	}
 }
 
+/*
+ * Function that writes the block or page descriptors of a run of entries of a
+ * table, starting with the entry at `table_idx`, which must be one for which
+ * xlat_tables_map_region_action() returned ACTION_WRITE_BLOCK_ENTRY. The run
+ * goes on while the entries are invalid and fully covered by the region, as
+ * the next descriptors only differ from the first one by their output address.
+ *
+ * Groups of XLAT_CONT_ENTRIES entries of the run that are aligned in VA and PA
+ * to XLAT_CONT_SIZE() get the contiguous hint if the region is mapped with
+ * MT_CONT_HINT.
+ *
+ * Returns the number of entries written.
+ */
+static unsigned int xlat_tables_write_blocks(const xlat_ctx_t *ctx,
+				const mmap_region_t *mm, uint64_t *table_base,
+				unsigned int table_idx, unsigned int table_entries,
+				uintptr_t table_idx_va,
+				unsigned long long table_idx_pa, unsigned int level)
+{
+	uintptr_t mm_end_va = mm->base_va + mm->size - 1U;
+	size_t block_size = XLAT_BLOCK_SIZE(level);
+	size_t cont_size = XLAT_CONT_SIZE(level);
+	uint64_t desc;
+	unsigned int count = 1U;
+	unsigned int i = 0U;
+
+	/* Length of the run */
+	while (((table_idx + count) < table_entries) &&
+	       ((table_idx_va + ((count + 1U) * block_size) - 1U) <= mm_end_va) &&
+	       (table_base[table_idx + count] == INVALID_DESC)) {
+		count++;
+	}
+
+	desc = xlat_desc(ctx, (uint32_t)mm->attr, table_idx_pa, level);
+
+	/*
+	 * The contiguous hint needs the same VA to PA offset modulo the size of
+	 * a group of entries.
+	 */
+	if (((mm->attr & MT_CONT_HINT) != 0U) &&
+	    (((table_idx_va - table_idx_pa) & (cont_size - 1U)) == 0U)) {
+		while (i < count) {
+			uintptr_t va = table_idx_va + (i * block_size);
+
+			if (((va & (cont_size - 1U)) == 0U) &&
+			    ((count - i) >= XLAT_CONT_ENTRIES)) {
+				for (unsigned int j = 0U; j < XLAT_CONT_ENTRIES;
+				     j++, i++) {
+					table_base[table_idx + i] =
+						(desc + (i * block_size)) |
+						UPPER_ATTRS(CONT_HINT);
+				}
+			} else {
+				table_base[table_idx + i] =
+					desc + (i * block_size);
+				i++;
+			}
+		}
+	} else {
+		for (; i < count; i++) {
+			table_base[table_idx + i] = desc + (i * block_size);
+		}
+	}
+
+	return count;
+}
+
 /*
  * Recursive function that writes to the translation tables and maps the
  * specified region. On success, it returns the VA of the last byte that was
@@ -587,10 +699,15 @@ static uintptr_t xlat_tables_map_region(xlat_ctx_t *ctx, mmap_region_t *mm,
 			table_idx_va, level);
 
 		if (action == ACTION_WRITE_BLOCK_ENTRY) {
+			unsigned int count;
 
-			table_base[table_idx] =
-				xlat_desc(ctx, (uint32_t)mm->attr, table_idx_pa,
-					  level);
+			count = xlat_tables_write_blocks(ctx, mm, table_base,
+					table_idx, table_entries, table_idx_va,
+					table_idx_pa, level);
+
+			/* Move to the last entry written */
+			table_idx += count - 1U;
+			table_idx_va += (count - 1U) * XLAT_BLOCK_SIZE(level);
 
 		} else if (action == ACTION_CREATE_NEW_TABLE) {
 			uintptr_t end_va;
@@ -753,9 +870,37 @@ static int mmap_add_region_check(const xlat_ctx_t *ctx, const mmap_region_t *mm)
 	return 0;
 }
 
+/*
+ * Returns the entry of the mmap array of the context where a region that ends
+ * at `end_va` and has the given size goes, keeping the order described in
+ * mmap_add_region_ctx(). It is either the region itself, if it is already in
+ * the array, or the first region that goes after it. The array is sorted, so
+ * this is a binary search.
+ */
+static mmap_region_t *mmap_find_region_pos(const xlat_ctx_t *ctx,
+					   uintptr_t end_va, size_t size)
+{
+	unsigned int low = 0U;
+	unsigned int high = (unsigned int)ctx->mmap_regions;
+
+	while (low < high) {
+		unsigned int mid = low + ((high - low) / 2U);
+		const mmap_region_t *mm = &ctx->mmap[mid];
+		uintptr_t mm_end_va = mm->base_va + mm->size - 1U;
+
+		if ((mm_end_va < end_va) ||
+		    ((mm_end_va == end_va) && (mm->size < size)))
+			low = mid + 1U;
+		else
+			high = mid;
+	}
+
+	return &ctx->mmap[low];
+}
+
 void mmap_add_region_ctx(xlat_ctx_t *ctx, const mmap_region_t *mm)
 {
-	mmap_region_t *mm_cursor = ctx->mmap, *mm_destination;
+	mmap_region_t *mm_cursor, *mm_destination;
 	const mmap_region_t *mm_end = ctx->mmap + ctx->mmap_num;
 	const mmap_region_t *mm_last;
 	unsigned long long end_pa = mm->base_pa + mm->size - 1U;
@@ -799,24 +944,10 @@ void mmap_add_region_ctx(xlat_ctx_t *ctx, const mmap_region_t *mm)
 	 *
 	 * Overlapping is only allowed for static regions.
 	 */
+	mm_cursor = mmap_find_region_pos(ctx, end_va, mm->size);
 
-	while (((mm_cursor->base_va + mm_cursor->size - 1U) < end_va)
-	       && (mm_cursor->size != 0U)) {
-		++mm_cursor;
-	}
-
-	while (((mm_cursor->base_va + mm_cursor->size - 1U) == end_va) &&
-	       (mm_cursor->size != 0U) && (mm_cursor->size < mm->size)) {
-		++mm_cursor;
-	}
-
-	/*
-	 * Find the last entry marker in the mmap
-	 */
-	mm_last = ctx->mmap;
-	while ((mm_last->size != 0U) && (mm_last < mm_end)) {
-		++mm_last;
-	}
+	/* The last entry marker in the mmap */
+	mm_last = ctx->mmap + ctx->mmap_regions;
 
 	/*
 	 * Check if we have enough space in the memory mapping table.
@@ -838,6 +969,7 @@ void mmap_add_region_ctx(xlat_ctx_t *ctx, const mmap_region_t *mm)
 	assert(mm_end->size == 0U);
 
 	*mm_cursor = *mm;
+	ctx->mmap_regions++;
 
 	if (end_pa > ctx->max_pa)
 		ctx->max_pa = end_pa;
@@ -933,8 +1065,8 @@ void mmap_add_ctx(xlat_ctx_t *ctx, const mmap_region_t *mm)
 
 int mmap_add_dynamic_region_ctx(xlat_ctx_t *ctx, mmap_region_t *mm)
 {
-	mmap_region_t *mm_cursor = ctx->mmap;
-	const mmap_region_t *mm_last = mm_cursor + ctx->mmap_num;
+	mmap_region_t *mm_cursor;
+	const mmap_region_t *mm_last = ctx->mmap + ctx->mmap_regions;
 	unsigned long long end_pa = mm->base_pa + mm->size - 1U;
 	uintptr_t end_va = mm->base_va + mm->size - 1U;
 	int ret;
@@ -954,18 +1086,13 @@ int mmap_add_dynamic_region_ctx(xlat_ctx_t *ctx, mmap_region_t *mm)
 	 * Find the adequate entry in the mmap array in the same way done for
 	 * static regions in mmap_add_region_ctx().
 	 */
+	mm_cursor = mmap_find_region_pos(ctx, end_va, mm->size);
 
-	while (((mm_cursor->base_va + mm_cursor->size - 1U) < end_va)
-	       && (mm_cursor->size != 0U)) {
-		++mm_cursor;
-	}
-
-	while (((mm_cursor->base_va + mm_cursor->size - 1U) == end_va) &&
-	       (mm_cursor->size != 0U) && (mm_cursor->size < mm->size)) {
-		++mm_cursor;
-	}
-
-	/* Make room for new region by moving other regions up by one place */
+	/*
+	 * Make room for new region by moving other regions up by one place.
+	 * The regions after the last one are all empty, so there is no need to
+	 * move them.
+	 */
 	(void)memmove(mm_cursor + 1U, mm_cursor,
 		     (uintptr_t)mm_last - (uintptr_t)mm_cursor);
 
@@ -974,9 +1101,10 @@ int mmap_add_dynamic_region_ctx(xlat_ctx_t *ctx, mmap_region_t *mm)
 	 * This shouldn't happen as we have checked in mmap_add_region_check
 	 * that there is free space.
 	 */
-	assert(mm_last->size == 0U);
+	assert(ctx->mmap[ctx->mmap_num].size == 0U);
 
 	*mm_cursor = *mm;
+	ctx->mmap_regions++;
 
 	/*
 	 * Update the translation tables if the xlat tables are initialized. If
@@ -994,6 +1122,9 @@ int mmap_add_dynamic_region_ctx(xlat_ctx_t *ctx, mmap_region_t *mm)
 		if (end_va != (mm_cursor->base_va + mm_cursor->size - 1U)) {
 			(void)memmove(mm_cursor, mm_cursor + 1U,
 				(uintptr_t)mm_last - (uintptr_t)mm_cursor);
+			ctx->mmap_regions--;
+			(void)memset(&ctx->mmap[ctx->mmap_regions], 0,
+				     sizeof(mmap_region_t));
 
 			/*
 			 * Check if the mapping function actually managed to map
@@ -1019,6 +1150,9 @@ int mmap_add_dynamic_region_ctx(xlat_ctx_t *ctx, mmap_region_t *mm)
 			xlat_clean_dcache_range((uintptr_t)ctx->base_table,
 				ctx->base_table_entries * sizeof(uint64_t));
 #endif
+			xlat_arch_tlbi_va_range(unmap_mm.base_va, unmap_mm.size,
+						ctx->xlat_regime);
+			xlat_arch_tlbi_va_sync();
 			return -ENOMEM;
 		}
 
@@ -1068,22 +1202,20 @@ int mmap_add_dynamic_region_alloc_va_ctx(xlat_ctx_t *ctx, mmap_region_t *mm)
 int mmap_remove_dynamic_region_ctx(xlat_ctx_t *ctx, uintptr_t base_va,
 				   size_t size)
 {
-	mmap_region_t *mm = ctx->mmap;
-	const mmap_region_t *mm_last = mm + ctx->mmap_num;
+	mmap_region_t *mm;
+	const mmap_region_t *mm_last = ctx->mmap + ctx->mmap_regions;
 	int update_max_va_needed = 0;
 	int update_max_pa_needed = 0;
 
 	/* Check sanity of mmap array. */
-	assert(mm[ctx->mmap_num].size == 0U);
+	assert(ctx->mmap[ctx->mmap_num].size == 0U);
 
-	while (mm->size != 0U) {
-		if ((mm->base_va == base_va) && (mm->size == size))
-			break;
-		++mm;
-	}
+	if (size == 0U)
+		return -EINVAL;
 
 	/* Check that the region was found */
-	if (mm->size == 0U)
+	mm = mmap_find_region_pos(ctx, base_va + size - 1U, size);
+	if ((mm == mm_last) || (mm->base_va != base_va) || (mm->size != size))
 		return -EINVAL;
 
 	/* If the region is static it can't be removed */
@@ -1105,20 +1237,26 @@ int mmap_remove_dynamic_region_ctx(xlat_ctx_t *ctx, uintptr_t base_va,
 		xlat_clean_dcache_range((uintptr_t)ctx->base_table,
 			ctx->base_table_entries * sizeof(uint64_t));
 #endif
+		xlat_arch_tlbi_va_range(mm->base_va, mm->size,
+					ctx->xlat_regime);
 		xlat_arch_tlbi_va_sync();
 	}
 
 	/* Remove this region by moving the rest down by one place. */
-	(void)memmove(mm, mm + 1U, (uintptr_t)mm_last - (uintptr_t)mm);
+	(void)memmove(mm, mm + 1U,
+		      (uintptr_t)mm_last - (uintptr_t)(mm + 1U));
+	ctx->mmap_regions--;
+	(void)memset(&ctx->mmap[ctx->mmap_regions], 0, sizeof(mmap_region_t));
 
-	/* Check if we need to update the max VAs and PAs */
+	/*
+	 * Check if we need to update the max VAs and PAs. The regions are
+	 * sorted by end VA, so the last one is using the top VA.
+	 */
 	if (update_max_va_needed == 1) {
 		ctx->max_va = 0U;
-		mm = ctx->mmap;
-		while (mm->size != 0U) {
-			if ((mm->base_va + mm->size - 1U) > ctx->max_va)
-				ctx->max_va = mm->base_va + mm->size - 1U;
-			++mm;
+		if (ctx->mmap_regions > 0) {
+			mm = &ctx->mmap[ctx->mmap_regions - 1];
+			ctx->max_va = mm->base_va + mm->size - 1U;
 		}
 	}
 
@@ -1139,7 +1277,8 @@ void xlat_setup_dynamic_ctx(xlat_ctx_t *ctx, unsigned long long pa_max,
 			    uintptr_t va_max, struct mmap_region *mmap,
 			    unsigned int mmap_num, uint64_t **tables,
 			    unsigned int tables_num, uint64_t *base_table,
-			    int xlat_regime, int *mapped_regions)
+			    int xlat_regime, int *mapped_regions,
+			    uint64_t *tables_free_map)
 {
 	ctx->xlat_regime = xlat_regime;
 
@@ -1148,6 +1287,7 @@ void xlat_setup_dynamic_ctx(xlat_ctx_t *ctx, unsigned long long pa_max,
 
 	ctx->mmap = mmap;
 	ctx->mmap_num = mmap_num;
+	ctx->mmap_regions = 0;
 	memset(ctx->mmap, 0, sizeof(struct mmap_region) * mmap_num);
 
 	ctx->tables = (void *) tables;
@@ -1159,6 +1299,7 @@ void xlat_setup_dynamic_ctx(xlat_ctx_t *ctx, unsigned long long pa_max,
 	ctx->base_table_entries = GET_NUM_BASE_LEVEL_ENTRIES(va_space_size);
 
 	ctx->tables_mapped_regions = mapped_regions;
+	ctx->tables_free_map = tables_free_map;
 
 	ctx->max_pa = 0;
 	ctx->max_va = 0;
@@ -1197,6 +1338,9 @@ void __init init_xlat_tables_ctx(xlat_ctx_t *ctx)
 		for (unsigned int i = 0U; i < XLAT_TABLE_ENTRIES; i++)
 			ctx->tables[j][i] = INVALID_DESC;
 	}
+#if PLAT_XLAT_TABLES_DYNAMIC
+	xlat_tables_free_map_init(ctx);
+#endif
 
 	while (mm->size != 0U) {
 		uintptr_t end_va = xlat_tables_map_region(ctx, mm, 0U,
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2018, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -57,9 +57,24 @@ uint64_t xlat_arch_regime_get_xn_desc(int xlat_regime);
  */
 void xlat_arch_tlbi_va(uintptr_t va, int xlat_regime);
 
+/*
+ * Above this number of pages, xlat_arch_tlbi_va_range() invalidates all the
+ * TLB entries of the translation regime rather than one page at a time.
+ */
+#define XLAT_TLBI_RANGE_MAX_PAGES	U(512)
+
+/*
+ * Invalidate all TLB entries that match the virtual addresses from `va` to
+ * `va + size - 1`, with the same constraints as xlat_arch_tlbi_va(). When the
+ * range TLBI instructions (FEAT_TLBIRANGE) are implemented, a few of them cover
+ * the whole range. Otherwise, the pages are invalidated one by one, or the
+ * whole translation regime if there are more than XLAT_TLBI_RANGE_MAX_PAGES.
+ */
+void xlat_arch_tlbi_va_range(uintptr_t va, size_t size, int xlat_regime);
+
 /*
  * This function has to be called at the end of any code that uses the function
- * xlat_arch_tlbi_va().
+ * xlat_arch_tlbi_va() or xlat_arch_tlbi_va_range().
  */
 void xlat_arch_tlbi_va_sync(void);
 
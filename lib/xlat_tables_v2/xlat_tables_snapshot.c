@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <xlat_tables_defs.h>
+#include <xlat_tables_v2.h>
+
+#include "xlat_tables_private.h"
+
+/* Used as the end of the VA space when comparing runs */
+#define VA_END		(~0ULL)
+
+static const mmap_region_t *snapshot_regions(const xlat_snapshot_t *snap)
+{
+	return (const mmap_region_t *)(const void *)(snap + 1);
+}
+
+static const xlat_snapshot_run_t *snapshot_runs(const xlat_snapshot_t *snap)
+{
+	return (const xlat_snapshot_run_t *)(const void *)
+		(snapshot_regions(snap) + snap->regions);
+}
+
+static unsigned long long run_end_va(const xlat_snapshot_run_t *run)
+{
+	return (unsigned long long)run->base_va +
+	       ((unsigned long long)run->count * XLAT_BLOCK_SIZE(run->level));
+}
+
+/* State of a snapshot while the translation tables are walked */
+struct snapshot_state {
+	/* Where to store the runs, and how many of them fit */
+	xlat_snapshot_run_t *runs;
+	unsigned int runs_max;
+	/* Number of runs found, including the current one */
+	unsigned int runs_num;
+	xlat_snapshot_run_t cur;
+};
+
+static void snapshot_flush_run(struct snapshot_state *st)
+{
+	if ((st->runs_num > 0U) && (st->runs_num <= st->runs_max)) {
+		st->runs[st->runs_num - 1U] = st->cur;
+	}
+}
+
+static void snapshot_add_desc(struct snapshot_state *st, uintptr_t va,
+			      uint64_t desc, unsigned int level)
+{
+	unsigned long long size = XLAT_BLOCK_SIZE(level);
+	unsigned long long pa = desc & TABLE_ADDR_MASK & XLAT_ADDR_MASK(level);
+	uint64_t attr = desc & ~(TABLE_ADDR_MASK | DESC_MASK);
+	xlat_snapshot_run_t *cur = &st->cur;
+
+	if ((st->runs_num > 0U) && (cur->level == level) &&
+	    (cur->attr == attr) &&
+	    (run_end_va(cur) == va) &&
+	    ((cur->base_pa + (cur->count * size)) == pa)) {
+		cur->count++;
+		return;
+	}
+
+	snapshot_flush_run(st);
+
+	cur->base_va = va;
+	cur->base_pa = pa;
+	cur->attr = attr;
+	cur->level = level;
+	cur->count = 1U;
+	st->runs_num++;
+}
+
+/*
+ * Recursive function that walks the translation tables passed as an argument
+ * and adds their block and page descriptors to the snapshot.
+ */
+static void snapshot_walk(struct snapshot_state *st, uintptr_t table_base_va,
+			  const uint64_t *table_base, unsigned int table_entries,
+			  unsigned int level)
+{
+	assert(level <= XLAT_TABLE_LEVEL_MAX);
+
+	size_t level_size = XLAT_BLOCK_SIZE(level);
+	uintptr_t table_idx_va = table_base_va;
+
+	for (unsigned int i = 0U; i < table_entries; i++) {
+		uint64_t desc = table_base[i];
+		uint64_t desc_type = desc & DESC_MASK;
+
+		if (level < XLAT_TABLE_LEVEL_MAX) {
+			if (desc_type == TABLE_DESC) {
+				uintptr_t addr_inner = desc & TABLE_ADDR_MASK;
+
+				snapshot_walk(st, table_idx_va,
+					      (uint64_t *)addr_inner,
+					      XLAT_TABLE_ENTRIES, level + 1U);
+			} else if (desc_type == BLOCK_DESC) {
+				snapshot_add_desc(st, table_idx_va, desc, level);
+			}
+		} else if (desc_type == PAGE_DESC) {
+			snapshot_add_desc(st, table_idx_va, desc, level);
+		}
+
+		table_idx_va += level_size;
+	}
+}
+
+int xlat_snapshot_ctx(const xlat_ctx_t *ctx, xlat_snapshot_t *snap,
+		      size_t size)
+{
+	struct snapshot_state st;
+	size_t regions_size, needed;
+
+	assert(ctx != NULL);
+	assert(ctx->initialized);
+	assert(snap != NULL);
+	assert(((uintptr_t)snap % sizeof(uint64_t)) == 0U);
+
+	if (size < sizeof(*snap)) {
+		return -ENOMEM;
+	}
+
+	snap->magic = XLAT_SNAPSHOT_MAGIC;
+	snap->xlat_regime = ctx->xlat_regime;
+	snap->base_level = ctx->base_level;
+	snap->regions = (unsigned int)ctx->mmap_regions;
+
+	regions_size = snap->regions * sizeof(mmap_region_t);
+	(void)memset(&st, 0, sizeof(st));
+	if ((size - sizeof(*snap)) >= regions_size) {
+		mmap_region_t *regions = (mmap_region_t *)(void *)(snap + 1);
+
+		(void)memcpy(regions, ctx->mmap, regions_size);
+		st.runs = (xlat_snapshot_run_t *)(void *)
+			  (regions + snap->regions);
+		st.runs_max = (size - sizeof(*snap) - regions_size) /
+			      sizeof(xlat_snapshot_run_t);
+	}
+
+	snapshot_walk(&st, 0U, ctx->base_table, ctx->base_table_entries,
+		      ctx->base_level);
+	snapshot_flush_run(&st);
+
+	snap->runs = st.runs_num;
+	needed = sizeof(*snap) + regions_size +
+		 (st.runs_num * sizeof(xlat_snapshot_run_t));
+	snap->size = needed;
+
+	return (needed > size) ? -ENOMEM : 0;
+}
+
+/* Compare two regions by end VA and then size, which is the mmap array order */
+static int region_cmp(const mmap_region_t *a, const mmap_region_t *b)
+{
+	uintptr_t a_end_va = a->base_va + a->size - 1U;
+	uintptr_t b_end_va = b->base_va + b->size - 1U;
+
+	if (a_end_va != b_end_va) {
+		return (a_end_va < b_end_va) ? -1 : 1;
+	}
+	if (a->size != b->size) {
+		return (a->size < b->size) ? -1 : 1;
+	}
+
+	return 0;
+}
+
+static void region_print(char prefix, const mmap_region_t *mm)
+{
+	printf(" %c VA:0x%lx  PA:0x%llx  size:0x%zx  attr:0x%x  granularity:0x%zx\n",
+	       prefix, mm->base_va, mm->base_pa, mm->size, mm->attr,
+	       mm->granularity);
+}
+
+static unsigned int regions_diff(const xlat_snapshot_t *before,
+				 const xlat_snapshot_t *after)
+{
+	const mmap_region_t *a = snapshot_regions(before);
+	const mmap_region_t *b = snapshot_regions(after);
+	unsigned int i = 0U, j = 0U, diffs = 0U;
+
+	while ((i < before->regions) || (j < after->regions)) {
+		int cmp;
+
+		if (i == before->regions) {
+			cmp = 1;
+		} else if (j == after->regions) {
+			cmp = -1;
+		} else {
+			cmp = region_cmp(&a[i], &b[j]);
+		}
+
+		if (cmp < 0) {
+			region_print('-', &a[i++]);
+			diffs++;
+		} else if (cmp > 0) {
+			region_print('+', &b[j++]);
+			diffs++;
+		} else {
+			if ((a[i].base_pa != b[j].base_pa) ||
+			    (a[i].attr != b[j].attr) ||
+			    (a[i].granularity != b[j].granularity)) {
+				region_print('-', &a[i]);
+				region_print('+', &b[j]);
+				diffs++;
+			}
+			i++;
+			j++;
+		}
+	}
+
+	return diffs;
+}
+
+static void run_print(const xlat_snapshot_run_t *run, unsigned long long va)
+{
+	if (run == NULL) {
+		printf("unmapped");
+		return;
+	}
+
+	printf("PA:0x%llx L%u attr:0x%llx",
+	       run->base_pa + (va - run->base_va), run->level,
+	       (unsigned long long)run->attr);
+}
+
+/*
+ * Walk the runs of both snapshots in VA order, split in segments in which
+ * the run that maps the VAs, if any, doesn't change on either side.
+ */
+static unsigned int runs_diff(const xlat_snapshot_t *before,
+			      const xlat_snapshot_t *after)
+{
+	const xlat_snapshot_run_t *a = snapshot_runs(before);
+	const xlat_snapshot_run_t *b = snapshot_runs(after);
+	unsigned int i = 0U, j = 0U, diffs = 0U;
+	unsigned long long va = 0U;
+
+	while ((i < before->runs) || (j < after->runs)) {
+		const xlat_snapshot_run_t *ra = NULL, *rb = NULL;
+		unsigned long long a_next = VA_END, b_next = VA_END;
+		unsigned long long end;
+		bool differ;
+
+		if (i < before->runs) {
+			if (va >= a[i].base_va) {
+				ra = &a[i];
+				a_next = run_end_va(ra);
+			} else {
+				a_next = a[i].base_va;
+			}
+		}
+		if (j < after->runs) {
+			if (va >= b[j].base_va) {
+				rb = &b[j];
+				b_next = run_end_va(rb);
+			} else {
+				b_next = b[j].base_va;
+			}
+		}
+		end = (a_next < b_next) ? a_next : b_next;
+
+		if ((ra == NULL) || (rb == NULL)) {
+			differ = ra != rb;
+		} else {
+			differ = ((ra->base_pa + (va - ra->base_va)) !=
+				  (rb->base_pa + (va - rb->base_va))) ||
+				 (ra->attr != rb->attr) ||
+				 (ra->level != rb->level);
+		}
+
+		if (differ) {
+			printf("   VA:0x%llx-0x%llx  ", va, end - 1U);
+			run_print(ra, va);
+			printf(" -> ");
+			run_print(rb, va);
+			printf("\n");
+			diffs++;
+		}
+
+		va = end;
+		if ((ra != NULL) && (va == a_next)) {
+			i++;
+		}
+		if ((rb != NULL) && (va == b_next)) {
+			j++;
+		}
+	}
+
+	return diffs;
+}
+
+unsigned int xlat_snapshot_diff(const xlat_snapshot_t *before,
+				const xlat_snapshot_t *after)
+{
+	assert((before != NULL) && (before->magic == XLAT_SNAPSHOT_MAGIC));
+	assert((after != NULL) && (after->magic == XLAT_SNAPSHOT_MAGIC));
+
+	return regions_diff(before, after) + runs_diff(before, after);
+}
+
+/*
+ * Return the number of descriptors needed to map `size` bytes from `va` to
+ * `pa` with the largest blocks that their alignment allows, without going
+ * above `min_level`.
+ */
+static unsigned long long ideal_descs(unsigned long long va,
+				      unsigned long long pa,
+				      unsigned long long size,
+				      unsigned int min_level)
+{
+	unsigned long long descs = 0U;
+
+	while (size > 0U) {
+		unsigned long long block_size, count;
+		unsigned int level;
+
+		for (level = min_level; level < XLAT_TABLE_LEVEL_MAX; level++) {
+			block_size = XLAT_BLOCK_SIZE(level);
+			if ((((va | pa) & (block_size - 1U)) == 0U) &&
+			    (size >= block_size)) {
+				break;
+			}
+		}
+		block_size = XLAT_BLOCK_SIZE(level);
+
+		/*
+		 * Map as many blocks of this size as possible before the VA
+		 * gets aligned to a block of the level above.
+		 */
+		count = size / block_size;
+		if (level > min_level) {
+			unsigned long long upper_size =
+				XLAT_BLOCK_SIZE(level - 1U);
+			unsigned long long to_upper = (upper_size -
+				(va & (upper_size - 1U))) / block_size;
+
+			if (count > to_upper) {
+				count = to_upper;
+			}
+		}
+
+		descs += count;
+		va += count * block_size;
+		pa += count * block_size;
+		size -= count * block_size;
+	}
+
+	return descs;
+}
+
+void xlat_snapshot_get_profile(const xlat_snapshot_t *snap,
+			       xlat_snapshot_profile_t *profile)
+{
+	const xlat_snapshot_run_t *runs = snapshot_runs(snap);
+	unsigned int min_level = snap->base_level;
+	unsigned long long descs = 0U, depth_sum = 0U;
+	/* Group of runs that could be mapped as a single run */
+	unsigned long long ext_va = 0U, ext_pa = 0U, ext_size = 0U;
+	uint64_t ext_attr = 0U;
+
+	assert(snap->magic == XLAT_SNAPSHOT_MAGIC);
+	assert(profile != NULL);
+
+	(void)memset(profile, 0, sizeof(*profile));
+
+	if (min_level < MIN_LVL_BLOCK_DESC) {
+		min_level = MIN_LVL_BLOCK_DESC;
+	}
+
+	for (unsigned int i = 0U; i < snap->runs; i++) {
+		const xlat_snapshot_run_t *run = &runs[i];
+		unsigned long long size = run_end_va(run) - run->base_va;
+		/* The contiguous hint doesn't change the blocks used */
+		uint64_t attr = run->attr & ~UPPER_ATTRS(CONT_HINT);
+
+		profile->descs[run->level] += run->count;
+		profile->mapped += size;
+		descs += run->count;
+		depth_sum += size * (run->level - snap->base_level + 1U);
+
+		if ((ext_size != 0U) && (attr == ext_attr) &&
+		    ((ext_va + ext_size) == run->base_va) &&
+		    ((ext_pa + ext_size) == run->base_pa)) {
+			ext_size += size;
+			continue;
+		}
+
+		if (ext_size != 0U) {
+			profile->ideal_descs += ideal_descs(ext_va, ext_pa,
+							    ext_size, min_level);
+		}
+		ext_va = run->base_va;
+		ext_pa = run->base_pa;
+		ext_size = size;
+		ext_attr = attr;
+	}
+
+	if (ext_size != 0U) {
+		profile->ideal_descs += ideal_descs(ext_va, ext_pa, ext_size,
+						    min_level);
+	}
+
+	if (descs != 0U) {
+		profile->fragmentation = (unsigned int)
+			(((descs - profile->ideal_descs) * 100U) / descs);
+		profile->walk_depth = (unsigned int)
+			((depth_sum * 100U) / profile->mapped);
+	}
+}
+
+void xlat_snapshot_print_profile(const xlat_snapshot_t *snap)
+{
+	xlat_snapshot_profile_t profile;
+	unsigned long long descs = 0U;
+
+	xlat_snapshot_get_profile(snap, &profile);
+
+	printf("Translation tables profile:\n");
+	printf("  Mapped 0x%llx bytes, %u regions, %u runs of descriptors\n",
+	       profile.mapped, snap->regions, snap->runs);
+	for (unsigned int level = snap->base_level;
+	     level <= XLAT_TABLE_LEVEL_MAX; level++) {
+		printf("  Level %u: %llu %s\n", level, profile.descs[level],
+		       (level == XLAT_TABLE_LEVEL_MAX) ? "pages" : "blocks");
+		descs += profile.descs[level];
+	}
+	printf("  Descriptors: %llu, %llu with the largest blocks\n", descs,
+	       profile.ideal_descs);
+	printf("  Fragmentation: %u out of 100\n", profile.fragmentation);
+	printf("  Average walk depth: %u.%02u levels\n",
+	       profile.walk_depth / 100U, profile.walk_depth % 100U);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2020, ARM Limited and Contributors. All rights reserved.
+ * Copyright (c) 2017-2023, ARM Limited and Contributors. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -18,6 +18,12 @@
 
 #include "xlat_tables_private.h"
 
+/*
+ * Number of pages whose attributes are changed with a single break-before-make
+ * sequence by xlat_change_mem_attributes_ctx().
+ */
+#define XLAT_CHANGE_ATTR_BATCH	U(32)
+
 #if LOG_LEVEL < LOG_LEVEL_VERBOSE
 
 void xlat_mmap_print(__unused const mmap_region_t *mmap)
@@ -95,6 +101,10 @@ static void xlat_desc_print(const xlat_ctx_t *ctx, uint64_t desc)
 
 	printf(((LOWER_ATTRS(NS) & desc) != 0ULL) ? "-NS" : "-S");
 
+	if ((desc & UPPER_ATTRS(CONT_HINT)) != 0ULL) {
+		printf("-CONT");
+	}
+
 #ifdef __aarch64__
 	/* Check Guarded Page bit */
 	if ((desc & GP) != 0ULL) {
@@ -225,11 +235,7 @@ void xlat_tables_print(xlat_ctx_t *ctx)
 		ctx->base_table_entries);
 
 #if PLAT_XLAT_TABLES_DYNAMIC
-	used_page_tables = 0;
-	for (int i = 0; i < ctx->tables_num; ++i) {
-		if (ctx->tables_mapped_regions[i] != 0)
-			++used_page_tables;
-	}
+	used_page_tables = ctx->tables_used;
 #else
 	used_page_tables = ctx->next_table;
 #endif
@@ -424,12 +430,64 @@ int xlat_get_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 				NULL, NULL, NULL);
 }
 
+void xlat_get_tables_stats_ctx(const xlat_ctx_t *ctx,
+			       xlat_tables_stats_t *stats)
+{
+	assert(ctx != NULL);
+	assert(stats != NULL);
+
+#if PLAT_XLAT_TABLES_DYNAMIC
+	stats->tables_used = (unsigned int)ctx->tables_used;
+	stats->tables_peak = (unsigned int)ctx->tables_peak;
+#else
+	stats->tables_used = (unsigned int)ctx->next_table;
+	stats->tables_peak = (unsigned int)ctx->next_table;
+#endif
+	stats->tables_num = (unsigned int)ctx->tables_num;
+	stats->regions = (unsigned int)ctx->mmap_regions;
+	stats->regions_num = (unsigned int)ctx->mmap_num;
+}
+
+
+/*
+ * Remove the contiguous hint from the run of page descriptors that contains
+ * `entry`, the descriptor of `va`. All the pages of a run must have the same
+ * attributes, so this must be done before changing the attributes of any of
+ * them. The hint can only be changed with a break-before-make sequence, so the
+ * whole run is unmapped while doing so: the caller must have checked that the
+ * run is within the region whose attributes are changed.
+ */
+static void xlat_clear_cont_hint(const xlat_ctx_t *ctx, uint64_t *entry,
+				 uintptr_t va)
+{
+	unsigned int first = (va >> PAGE_SIZE_SHIFT) & (XLAT_CONT_ENTRIES - 1U);
+	uint64_t *run = entry - first;
+	uintptr_t run_va = va - (first * PAGE_SIZE);
+	uint64_t descs[XLAT_CONT_ENTRIES];
+
+	for (unsigned int i = 0U; i < XLAT_CONT_ENTRIES; i++) {
+		descs[i] = run[i];
+		run[i] = INVALID_DESC;
+	}
+#if !(HW_ASSISTED_COHERENCY || WARMBOOT_ENABLE_DCACHE_EARLY)
+	clean_dcache_range((uintptr_t)run, sizeof(descs));
+#endif
+
+	xlat_arch_tlbi_va_range(run_va, XLAT_CONT_SIZE(XLAT_TABLE_LEVEL_MAX),
+				ctx->xlat_regime);
+	xlat_arch_tlbi_va_sync();
+
+	for (unsigned int i = 0U; i < XLAT_CONT_ENTRIES; i++) {
+		run[i] = descs[i] & ~UPPER_ATTRS(CONT_HINT);
+	}
+#if !(HW_ASSISTED_COHERENCY || WARMBOOT_ENABLE_DCACHE_EARLY)
+	clean_dcache_range((uintptr_t)run, sizeof(descs));
+#endif
+}
 
 int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 				   size_t size, uint32_t attr)
 {
-	/* Note: This implementation isn't optimized. */
-
 	assert(ctx != NULL);
 	assert(ctx->initialized);
 
@@ -500,6 +558,23 @@ int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 			return -EINVAL;
 		}
 
+		/*
+		 * The contiguous hint can only be removed from a whole run of
+		 * pages, which must therefore be within the region.
+		 */
+		if ((desc & UPPER_ATTRS(CONT_HINT)) != 0ULL) {
+			uintptr_t run_va = base_va &
+				~(uintptr_t)(XLAT_CONT_SIZE(level) - 1U);
+
+			if ((run_va < base_va_original) ||
+			    ((run_va + XLAT_CONT_SIZE(level)) >
+			     (base_va_original + size))) {
+				WARN("Address 0x%lx is part of a contiguous run of pages not entirely in the region.\n",
+				     base_va);
+				return -EINVAL;
+			}
+		}
+
 		/*
 		 * If the region type is device, it shouldn't be executable.
 		 */
@@ -518,52 +593,77 @@ int xlat_change_mem_attributes_ctx(const xlat_ctx_t *ctx, uintptr_t base_va,
 	/* Restore original value. */
 	base_va = base_va_original;
 
-	for (unsigned int i = 0U; i < pages_count; ++i) {
+	while (pages_count > 0U) {
+		uint64_t *entries[XLAT_CHANGE_ATTR_BATCH];
+		uint64_t descs[XLAT_CHANGE_ATTR_BATCH];
+		unsigned int batch = (pages_count < XLAT_CHANGE_ATTR_BATCH) ?
+				     pages_count : XLAT_CHANGE_ATTR_BATCH;
 
-		uint32_t old_attr = 0U, new_attr;
-		uint64_t *entry = NULL;
-		unsigned int level = 0U;
-		unsigned long long addr_pa = 0ULL;
+		for (unsigned int i = 0U; i < batch; ++i) {
 
-		(void) xlat_get_mem_attributes_internal(ctx, base_va, &old_attr,
-					    &entry, &addr_pa, &level);
+			uintptr_t va = base_va + (i * PAGE_SIZE);
+			uint32_t old_attr = 0U, new_attr;
+			uint64_t *entry = NULL;
+			unsigned int level = 0U;
+			unsigned long long addr_pa = 0ULL;
 
-		/*
-		 * From attr, only MT_RO/MT_RW, MT_EXECUTE/MT_EXECUTE_NEVER and
-		 * MT_USER/MT_PRIVILEGED are taken into account. Any other
-		 * information is ignored.
-		 */
+			(void) xlat_get_mem_attributes_internal(ctx, va,
+					&old_attr, &entry, &addr_pa, &level);
 
-		/* Clean the old attributes so that they can be rebuilt. */
-		new_attr = old_attr & ~(MT_RW | MT_EXECUTE_NEVER | MT_USER);
+			if ((*entry & UPPER_ATTRS(CONT_HINT)) != 0ULL) {
+				xlat_clear_cont_hint(ctx, entry, va);
+			}
 
-		/*
-		 * Update attributes, but filter out the ones this function
-		 * isn't allowed to change.
-		 */
-		new_attr |= attr & (MT_RW | MT_EXECUTE_NEVER | MT_USER);
+			/*
+			 * From attr, only MT_RO/MT_RW,
+			 * MT_EXECUTE/MT_EXECUTE_NEVER and MT_USER/MT_PRIVILEGED
+			 * are taken into account. Any other information is
+			 * ignored.
+			 */
+
+			/* Clean the old attributes so that they can be rebuilt. */
+			new_attr = old_attr & ~(MT_RW | MT_EXECUTE_NEVER | MT_USER);
+
+			/*
+			 * Update attributes, but filter out the ones this
+			 * function isn't allowed to change.
+			 */
+			new_attr |= attr & (MT_RW | MT_EXECUTE_NEVER | MT_USER);
+
+			entries[i] = entry;
+			descs[i] = xlat_desc(ctx, new_attr, addr_pa, level);
+		}
 
 		/*
-		 * The break-before-make sequence requires writing an invalid
-		 * descriptor and making sure that the system sees the change
-		 * before writing the new descriptor.
+		 * The break-before-make sequence requires writing invalid
+		 * descriptors and making sure that the system sees the change
+		 * before writing the new descriptors. It is done for the whole
+		 * batch of pages at once.
 		 */
-		*entry = INVALID_DESC;
+		for (unsigned int i = 0U; i < batch; ++i) {
+			*entries[i] = INVALID_DESC;
 #if !(HW_ASSISTED_COHERENCY || WARMBOOT_ENABLE_DCACHE_EARLY)
-		dccvac((uintptr_t)entry);
+			dccvac((uintptr_t)entries[i]);
 #endif
-		/* Invalidate any cached copy of this mapping in the TLBs. */
-		xlat_arch_tlbi_va(base_va, ctx->xlat_regime);
+		}
+
+		/* Invalidate any cached copy of these mappings in the TLBs. */
+		xlat_arch_tlbi_va_range(base_va, batch * PAGE_SIZE,
+					ctx->xlat_regime);
 
 		/* Ensure completion of the invalidation. */
 		xlat_arch_tlbi_va_sync();
 
-		/* Write new descriptor */
-		*entry = xlat_desc(ctx, new_attr, addr_pa, level);
+		/* Write new descriptors */
+		for (unsigned int i = 0U; i < batch; ++i) {
+			*entries[i] = descs[i];
 #if !(HW_ASSISTED_COHERENCY || WARMBOOT_ENABLE_DCACHE_EARLY)
-		dccvac((uintptr_t)entry);
+			dccvac((uintptr_t)entries[i]);
 #endif
-		base_va += PAGE_SIZE;
+		}
+
+		base_va += batch * PAGE_SIZE;
+		pages_count -= batch;
 	}
 
 	/* Ensure that the last descriptor writen is seen by the system. */
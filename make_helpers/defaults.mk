@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -40,6 +40,18 @@ FWU_BL_TEST := 1
 # framework should try to resume a previous one if it was interrupted
 NEW_TEST_SESSION	:= 1
 
+# Whether consecutive single-core tests should run concurrently on different
+# CPUs
+PARALLEL_SINGLE_CORE_TESTS	:= 0
+
+# Size in bytes of the buffer of each CPU for the output of a test. By default,
+# a single CPU can write the whole output of a test.
+TESTCASE_CPU_OUTPUT_SIZE	= $(TESTCASE_OUTPUT_MAX_SIZE)
+
+# Maximum size in bytes of the output of a test once the output of all CPUs is
+# merged and saved with the test result
+TESTCASE_OUTPUT_MAX_SIZE	:= 2048
+
 # Use non volatile memory for storing results
 USE_NVM			:= 0
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -41,6 +41,7 @@
 #define GICD_BASE		0x2f000000
 #define GICR_BASE		0x2f100000
 #define GICC_BASE		0x2c000000
+#define GITS_BASE		0x2f020000
 
 /*******************************************************************************
  * PL011 related constants
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -47,3 +47,8 @@ void plat_arm_gic_init(void)
 {
 	arm_gic_init(GICC_BASE, GICD_BASE, GICR_BASE);
 }
+
+uintptr_t plat_get_gits_base(void)
+{
+	return GITS_BASE;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -24,6 +24,7 @@
 #pragma weak tftf_plat_enable_mmu
 #pragma weak tftf_plat_reset
 #pragma weak plat_get_prot_regions
+#pragma weak plat_get_gits_base
 
 #if IMAGE_TFTF
 
@@ -148,3 +149,8 @@ const mem_region_t *plat_get_prot_regions(int *nelem)
 	*nelem = 0;
 	return NULL;
 }
+
+uintptr_t plat_get_gits_base(void)
+{
+	return 0U;
+}
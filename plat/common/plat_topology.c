@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -34,6 +34,24 @@ unsigned int tftf_pwr_domain_start_idx[PLATFORM_MAX_AFFLVL + 1];
 /* The grand array to store the platform power domain topology */
 tftf_pwr_domain_node_t tftf_pd_nodes[PLATFORM_NUM_AFFS];
 
+/*
+ * Lookup tables built from tftf_pd_nodes[] once the topology is set up, so that
+ * the topology helpers do not need to walk the nodes:
+ * - the number of present power domains at each level;
+ * - the first present power domain at each level and, for each node, the next
+ *   present one at the same level;
+ * - the cluster of each CPU;
+ * - an open addressing hash table of the core positions of the present CPUs,
+ *   indexed by MPIDR.
+ */
+#define MPIDR_HASH_SIZE		(4 * PLATFORM_CORE_COUNT)
+
+static unsigned int aff_count[PLATFORM_MAX_AFFLVL + 1];
+static unsigned int first_present_node[PLATFORM_MAX_AFFLVL + 1];
+static unsigned int next_present_node[PLATFORM_NUM_AFFS];
+static unsigned int cpu_cluster_node[PLATFORM_CORE_COUNT];
+static unsigned int mpidr_hash[MPIDR_HASH_SIZE];
+
 #if DEBUG
 /*
  * Debug function to display the platform topology.
@@ -76,24 +94,12 @@ static void dump_topology(void)
 
 unsigned int tftf_get_total_aff_count(unsigned int aff_lvl)
 {
-	unsigned int count = 0;
-	unsigned int node_idx;
-
 	assert(topology_setup_done == 1);
 
 	if (aff_lvl > PLATFORM_MAX_AFFLVL)
-		return count;
-
-	node_idx = tftf_pwr_domain_start_idx[aff_lvl];
-
-	while ((node_idx < PLATFORM_NUM_AFFS) &&
-	       (tftf_pd_nodes[node_idx].level == aff_lvl)) {
-		if (tftf_pd_nodes[node_idx].is_present)
-			count++;
-		node_idx++;
-	}
+		return 0;
 
-	return count;
+	return aff_count[aff_lvl];
 }
 
 unsigned int tftf_get_next_peer_domain(unsigned int pwr_domain_idx,
@@ -103,23 +109,13 @@ unsigned int tftf_get_next_peer_domain(unsigned int pwr_domain_idx,
 
 	assert(pwr_lvl <= PLATFORM_MAX_AFFLVL);
 
-	if (pwr_domain_idx == PWR_DOMAIN_INIT) {
-		pwr_domain_idx = tftf_pwr_domain_start_idx[pwr_lvl];
-		if (tftf_pd_nodes[pwr_domain_idx].is_present)
-			return pwr_domain_idx;
-	}
+	if (pwr_domain_idx == PWR_DOMAIN_INIT)
+		return first_present_node[pwr_lvl];
 
 	assert(pwr_domain_idx < PLATFORM_NUM_AFFS &&
 			tftf_pd_nodes[pwr_domain_idx].level == pwr_lvl);
 
-	for (++pwr_domain_idx; (pwr_domain_idx < PLATFORM_NUM_AFFS)
-				&& (tftf_pd_nodes[pwr_domain_idx].level == pwr_lvl);
-				pwr_domain_idx++) {
-		if (tftf_pd_nodes[pwr_domain_idx].is_present)
-			return pwr_domain_idx;
-	}
-
-	return PWR_DOMAIN_INIT;
+	return next_present_node[pwr_domain_idx];
 }
 
 unsigned int tftf_get_next_cpu_in_pwr_domain(unsigned int pwr_domain_idx,
@@ -144,12 +140,12 @@ unsigned int tftf_get_next_cpu_in_pwr_domain(unsigned int pwr_domain_idx,
 
 	assert(cpu_end_node < PLATFORM_NUM_AFFS);
 
-	for (++cpu_node; cpu_node <= cpu_end_node; cpu_node++) {
-		if (tftf_pd_nodes[cpu_node].is_present)
-			return cpu_node;
-	}
+	/* The next present CPU may belong to another power domain */
+	cpu_node = next_present_node[cpu_node];
+	if (cpu_node > cpu_end_node)
+		return PWR_DOMAIN_INIT;
 
-	return PWR_DOMAIN_INIT;
+	return cpu_node;
 }
 
 /*
@@ -291,10 +287,61 @@ static void populate_power_domain_tree(void)
 }
 
 
+static unsigned int mpidr_hash_index(unsigned int mpidr)
+{
+	return ((mpidr & MPID_MASK) * 0x9e3779b1U) % MPIDR_HASH_SIZE;
+}
+
+/*******************************************************************************
+ * This function builds the lookup tables used by the topology helpers from the
+ * populated tftf_pd_nodes[].
+ ******************************************************************************/
+static void build_lookup_tables(void)
+{
+	unsigned int lvl, node, next, end_node, core_pos, i;
+
+	for (lvl = 0; lvl <= PLATFORM_MAX_AFFLVL; lvl++) {
+		aff_count[lvl] = 0;
+		next = PWR_DOMAIN_INIT;
+
+		/* Levels are stored from the highest down to the CPUs */
+		end_node = (lvl == 0) ? PLATFORM_NUM_AFFS :
+			tftf_pwr_domain_start_idx[lvl - 1];
+
+		/* Walk the nodes of the level backwards to find the next ones */
+		for (node = end_node; node-- > tftf_pwr_domain_start_idx[lvl];) {
+			next_present_node[node] = next;
+			if (tftf_pd_nodes[node].is_present) {
+				next = node;
+				aff_count[lvl]++;
+			}
+		}
+
+		first_present_node[lvl] = next;
+	}
+
+	for (i = 0; i < MPIDR_HASH_SIZE; i++)
+		mpidr_hash[i] = PWR_DOMAIN_INIT;
+
+	for (core_pos = 0; core_pos < PLATFORM_CORE_COUNT; core_pos++) {
+		node = tftf_pwr_domain_start_idx[0] + core_pos;
+		cpu_cluster_node[core_pos] = tftf_pd_nodes[node].parent_node;
+
+		if (!tftf_pd_nodes[node].is_present)
+			continue;
+
+		i = mpidr_hash_index(tftf_pd_nodes[node].mpidr);
+		while (mpidr_hash[i] != PWR_DOMAIN_INIT)
+			i = (i + 1) % MPIDR_HASH_SIZE;
+		mpidr_hash[i] = core_pos;
+	}
+}
+
 void tftf_init_topology(void)
 {
 	populate_power_domain_tree();
 	update_pwrlvl_limits();
+	build_lookup_tables();
 	topology_setup_done = 1;
 #if DEBUG
 	dump_topology();
@@ -305,20 +352,12 @@ unsigned int tftf_topology_next_cpu(unsigned int cpu_node)
 {
 	assert(topology_setup_done == 1);
 
-	if (cpu_node == PWR_DOMAIN_INIT) {
-		cpu_node = tftf_pwr_domain_start_idx[0];
-		if (tftf_pd_nodes[cpu_node].is_present)
-			return cpu_node;
-	}
+	if (cpu_node == PWR_DOMAIN_INIT)
+		return first_present_node[0];
 
 	assert(CPU_NODE_IS_VALID(cpu_node));
 
-	for (++cpu_node; cpu_node < PLATFORM_NUM_AFFS; cpu_node++) {
-		if (tftf_pd_nodes[cpu_node].is_present)
-			return cpu_node;
-	}
-
-	return PWR_DOMAIN_INIT;
+	return next_present_node[cpu_node];
 }
 
 unsigned int tftf_get_parent_node_from_mpidr(unsigned int mpidr, unsigned int pwrlvl)
@@ -340,6 +379,32 @@ unsigned int tftf_get_parent_node_from_mpidr(unsigned int mpidr, unsigned int pw
 	return node;
 }
 
+unsigned int tftf_get_core_pos_from_mpidr(unsigned int mpidr)
+{
+	unsigned int i, core_pos;
+
+	assert(topology_setup_done == 1);
+
+	mpidr &= MPID_MASK;
+
+	for (i = mpidr_hash_index(mpidr); mpidr_hash[i] != PWR_DOMAIN_INIT;
+	     i = (i + 1) % MPIDR_HASH_SIZE) {
+		core_pos = mpidr_hash[i];
+		if ((tftf_core_pos_to_mpidr(core_pos) & MPID_MASK) == mpidr)
+			return core_pos;
+	}
+
+	return PWR_DOMAIN_INIT;
+}
+
+unsigned int tftf_core_pos_to_cluster_node(unsigned int core_pos)
+{
+	assert(topology_setup_done == 1);
+	assert(core_pos < PLATFORM_CORE_COUNT);
+
+	return cpu_cluster_node[core_pos];
+}
+
 unsigned int tftf_get_mpidr_from_node(unsigned int cpu_node)
 {
 	assert(topology_setup_done == 1);
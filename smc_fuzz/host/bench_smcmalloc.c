@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Micro-benchmark of the SMC fuzzer pool allocator.
+ *
+ * It is built once with the slab allocator and once with the legacy first-fit
+ * allocator (SMC_FUZZ_LEGACY_MALLOC=1), and times the same workloads on both:
+ *  - many small allocations, as done by a tree loader allocating one string
+ *    per node, all freed at the end;
+ *  - a random mix of allocations and frees of mixed sizes, kept small enough
+ *    for the legacy allocator not to run out of blocks.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "smcmalloc.h"
+
+#define ROUNDS		200U
+#define SMALL_ALLOCS	512U
+#define MIX_SLOTS	32U
+#define MIX_OPS		4096U
+
+#if SMC_FUZZ_LEGACY_MALLOC
+#define ALLOCATOR	"legacy"
+#else
+#define ALLOCATOR	"slab"
+#endif
+
+static struct memmod mmod;
+static void *ptrs[SMALL_ALLOCS];
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000U) + ts.tv_nsec;
+}
+
+static void report(const char *name, uint64_t ns, unsigned long ops)
+{
+	printf("  %-8s %-12s %8.1f ns/op\n", ALLOCATOR, name,
+	       (double)ns / ops);
+}
+
+static int bench_small(void)
+{
+	unsigned int seed = 1U;
+	unsigned long ops = 0U;
+	uint64_t start, ns = 0U;
+
+	for (unsigned int r = 0U; r < ROUNDS; r++) {
+		initmem(&mmod);
+		start = now_ns();
+		for (unsigned int i = 0U; i < SMALL_ALLOCS; i++) {
+			ptrs[i] = smcmalloc(8U + (rand_r(&seed) % 40U), &mmod);
+		}
+		for (unsigned int i = 0U; i < SMALL_ALLOCS; i++) {
+			smcfree(ptrs[i], &mmod);
+		}
+		ns += now_ns() - start;
+		ops += 2U * SMALL_ALLOCS;
+		if (mmod.memerror != 0U) {
+			printf("  %s: small allocations failed\n", ALLOCATOR);
+			return -1;
+		}
+	}
+
+	report("small", ns, ops);
+	return 0;
+}
+
+static int bench_mix(void)
+{
+	static const unsigned int sizes[] = { 16U, 24U, 100U, 256U, 600U, 1500U };
+	unsigned int seed = 2U;
+	unsigned long ops = 0U;
+	uint64_t start, ns = 0U;
+	unsigned int slot;
+
+	for (unsigned int r = 0U; r < ROUNDS; r++) {
+		initmem(&mmod);
+		for (slot = 0U; slot < MIX_SLOTS; slot++) {
+			ptrs[slot] = NULL;
+		}
+
+		start = now_ns();
+		for (unsigned int i = 0U; i < MIX_OPS; i++) {
+			slot = rand_r(&seed) % MIX_SLOTS;
+			if (ptrs[slot] != NULL) {
+				smcfree(ptrs[slot], &mmod);
+				ptrs[slot] = NULL;
+			} else {
+				ptrs[slot] = smcmalloc(sizes[rand_r(&seed) %
+						(sizeof(sizes) / sizeof(sizes[0]))],
+						&mmod);
+			}
+		}
+		ns += now_ns() - start;
+		ops += MIX_OPS;
+		if (mmod.memerror != 0U) {
+			printf("  %s: mixed allocations failed\n", ALLOCATOR);
+			return -1;
+		}
+	}
+
+	report("mixed", ns, ops);
+
+#if !SMC_FUZZ_LEGACY_MALLOC
+	struct smcmemstats stats;
+
+	smcmemstats(&mmod, &stats);
+	printf("  %-8s peak %u bytes, %u%% lost to rounding, %u/%u pages free, largest run %u\n",
+	       ALLOCATOR, stats.peakinuse,
+	       (unsigned int)(((uint64_t)(stats.allocated - stats.requested) * 100U) /
+			      stats.allocated),
+	       stats.freepages, SLABPAGES, stats.largestrun);
+#endif
+	return 0;
+}
+
+int main(void)
+{
+	if ((bench_small() != 0) || (bench_mix() != 0)) {
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host build of the SMC fuzzer core, linked with a stub SMC backend.
+ *
+ * It loads a compiled bias tree with the same code as TFTF and uses the same
+ * allocator and random number generator, so for a given seed it selects the
+ * same calls with the same arguments as the fuzzer running on the target, as
+ * long as feedback is disabled and the MPIDRs match the platform.
+ *
+ * Usage: smc_fuzz_host [options] file.dtb
+ *   -s seed[,seed...]	Seeds of the instances to run (default: 1)
+ *   -n calls		Calls per instance (default: 100)
+ *   -m mpidr[,mpidr...]	MPIDRs used by "mpidr" generators
+ *			(default: 0x0-0x3,0x100-0x103)
+ *   -r			Print every call, to replay a seed
+ *   -b			Benchmark tree construction and sampling
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "arg_gen.h"
+#include "smc_tree.h"
+#include "smcmalloc.h"
+
+#define MAX_FUNCS	64U
+#define MAX_SEEDS	64U
+#define MAX_CPUS	64U
+
+#define BENCH_BUILDS	10000U
+#define BENCH_CALLS	10000000U
+
+static struct memmod mmod;
+
+/*
+ * Stub backend. Any function name is accepted and gets the next function ID,
+ * and calls are not issued but counted.
+ */
+static const char *func_names[MAX_FUNCS];
+static unsigned int func_count;
+static unsigned long func_calls[MAX_FUNCS];
+
+static uint64_t mpidrs[MAX_CPUS] = {
+	0x0, 0x1, 0x2, 0x3, 0x100, 0x101, 0x102, 0x103,
+};
+static unsigned int mpidr_count = 8U;
+
+int smc_fuzz_func_id(const char *funcname)
+{
+	for (unsigned int k = 0U; k < func_count; k++) {
+		if (strcmp(funcname, func_names[k]) == 0) {
+			return k;
+		}
+	}
+
+	if (func_count == MAX_FUNCS) {
+		return SMC_FUZZ_FUNC_NONE;
+	}
+	func_names[func_count] = funcname;
+	return func_count++;
+}
+
+unsigned int smc_fuzz_get_mpidrs(uint64_t *out)
+{
+	if (out != NULL) {
+		memcpy(out, mpidrs, mpidr_count * sizeof(*out));
+	}
+	return mpidr_count;
+}
+
+static void *load_file(const char *path)
+{
+	FILE *f = fopen(path, "rb");
+	void *buf;
+	long size;
+
+	if (f == NULL) {
+		fprintf(stderr, "Cannot open %s: %s\n", path, strerror(errno));
+		return NULL;
+	}
+
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	buf = malloc(size);
+	if ((buf != NULL) && (fread(buf, 1, size, f) != (size_t)size)) {
+		free(buf);
+		buf = NULL;
+	}
+	fclose(f);
+
+	return buf;
+}
+
+/*
+ * Parse a comma separated list of numbers into `values`. Return the number of
+ * values, or 0 on error.
+ */
+static unsigned int parse_list(char *str, uint64_t *values, unsigned int max)
+{
+	unsigned int count = 0U;
+	char *end;
+
+	while (*str != '\0') {
+		if (count == max) {
+			return 0U;
+		}
+		values[count++] = strtoull(str, &end, 0);
+		if ((end == str) || ((*end != ',') && (*end != '\0'))) {
+			return 0U;
+		}
+		str = (*end == ',') ? end + 1 : end;
+	}
+
+	return count;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t)ts.tv_sec * 1000000000U) + ts.tv_nsec;
+}
+
+static int run_instance(const void *fdt, unsigned int seed, unsigned int calls,
+			int replay)
+{
+	struct rand_smc_tree tree;
+	uint64_t args[ARG_GEN_MAX_ARGS];
+	unsigned int randstate = seed;
+	unsigned int leaf;
+	const struct rand_smc_node *node;
+
+	initmem(&mmod);
+	if ((createsmctree(&tree, fdt, &mmod) != 0) || (mmod.memerror != 0)) {
+		return -1;
+	}
+
+	memset(func_calls, 0, sizeof(func_calls));
+	for (unsigned int i = 0U; i < calls; i++) {
+		leaf = selectsmcleaf(&tree, &randstate, args);
+		node = &tree.nodes[leaf];
+		if (node->funcid != SMC_FUZZ_FUNC_NONE) {
+			func_calls[node->funcid]++;
+		}
+		if (replay) {
+			printf("    #%u %s(", i, node->funcname);
+			for (unsigned int a = 0U; a < ARG_GEN_MAX_ARGS; a++) {
+				printf("%s0x%llx", (a == 0U) ? "" : ", ",
+				       (unsigned long long)args[a]);
+			}
+			printf(")\n");
+		}
+	}
+
+	for (unsigned int k = 0U; k < func_count; k++) {
+		if (func_calls[k] != 0U) {
+			printf("    %s: %lu calls\n", func_names[k],
+			       func_calls[k]);
+		}
+	}
+
+	freesmctree(&tree, &mmod);
+	return (mmod.memerror != 0) ? -1 : 0;
+}
+
+static int benchmark(const void *fdt)
+{
+	struct rand_smc_tree tree;
+	uint64_t args[ARG_GEN_MAX_ARGS];
+	unsigned int randstate = 1U;
+	unsigned long sink = 0U;
+	uint64_t start, build_ns, sample_ns;
+
+	start = now_ns();
+	for (unsigned int i = 0U; i < BENCH_BUILDS; i++) {
+		initmem(&mmod);
+		if (createsmctree(&tree, fdt, &mmod) != 0) {
+			return -1;
+		}
+		freesmctree(&tree, &mmod);
+	}
+	build_ns = now_ns() - start;
+
+	initmem(&mmod);
+	if (createsmctree(&tree, fdt, &mmod) != 0) {
+		return -1;
+	}
+	start = now_ns();
+	for (unsigned int i = 0U; i < BENCH_CALLS; i++) {
+		sink += selectsmcleaf(&tree, &randstate, args);
+	}
+	sample_ns = now_ns() - start;
+	freesmctree(&tree, &mmod);
+
+	printf("Tree of %u nodes\n", tree.nnodes);
+	printf("  Build and free: %.1f us\n",
+	       (double)build_ns / BENCH_BUILDS / 1000.0);
+	printf("  Selection: %.1f ns/call (%lu)\n",
+	       (double)sample_ns / BENCH_CALLS, sink % 2U);
+
+	return 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-s seed[,seed...]] [-n calls] "
+		"[-m mpidr[,mpidr...]] [-r] [-b] file.dtb\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t seeds[MAX_SEEDS] = { 1U };
+	unsigned int seed_count = 1U;
+	unsigned int calls = 100U;
+	int replay = 0;
+	int bench = 0;
+	int result = 0;
+	void *fdt;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "s:n:m:rb")) != -1) {
+		switch (opt) {
+		case 's':
+			seed_count = parse_list(optarg, seeds, MAX_SEEDS);
+			if (seed_count == 0U) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'n':
+			calls = strtoul(optarg, NULL, 0);
+			break;
+		case 'm':
+			mpidr_count = parse_list(optarg, mpidrs, MAX_CPUS);
+			if (mpidr_count == 0U) {
+				usage(argv[0]);
+				return 1;
+			}
+			break;
+		case 'r':
+			replay = 1;
+			break;
+		case 'b':
+			bench = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind != (argc - 1)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	fdt = load_file(argv[optind]);
+	if (fdt == NULL) {
+		return 1;
+	}
+
+	if (bench) {
+		result = benchmark(fdt);
+	} else {
+		for (unsigned int i = 0U; i < seed_count; i++) {
+			printf("  Instance #%u\n", i);
+			printf("    Seed: 0x%x\n", (unsigned int)seeds[i]);
+			if (run_instance(fdt, seeds[i], calls, replay) != 0) {
+				printf("    Result: FAIL\n");
+				result = -1;
+			}
+		}
+	}
+
+	free(fdt);
+	return (result == 0) ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the alias tables used to sample the SMC fuzzer bias tree.
+ *
+ * For each set of biases, the test checks that the alias table encodes exactly
+ * the distribution given by the biases, then draws samples from it and checks
+ * the empirical frequencies with a chi-squared test.
+ *
+ * Usage: test_alias_table [bias...]
+ * Without arguments, the bias sets of the fuzzer's DTS files are used.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "alias_table.h"
+
+#define MAX_ENTRIES	64U
+#define SAMPLES		1000000U
+
+/*
+ * Chi-squared critical values at significance 0.001, indexed by the number of
+ * degrees of freedom. Beyond the table, the Wilson-Hilferty approximation is
+ * used.
+ */
+static const double chi2_crit[] = {
+	0.0, 10.828, 13.816, 16.266, 18.467, 20.515, 22.458, 24.322,
+	26.124, 27.877, 29.588,
+};
+
+static double chi2_critical(unsigned int dof)
+{
+	double z = 3.0902;	/* Standard normal quantile of 0.999 */
+	double a;
+
+	if (dof < (sizeof(chi2_crit) / sizeof(chi2_crit[0]))) {
+		return chi2_crit[dof];
+	}
+
+	a = 2.0 / (9.0 * dof);
+	a = 1.0 - a + z * sqrt(a);
+	return dof * a * a * a;
+}
+
+static int check_biases(const int *biases, unsigned int n)
+{
+	unsigned int prob[MAX_ENTRIES];
+	int alias[MAX_ENTRIES];
+	int work[MAX_ENTRIES];
+	uint64_t weight[MAX_ENTRIES] = { 0 };
+	unsigned long count[MAX_ENTRIES] = { 0 };
+	unsigned int total;
+	unsigned int dof = 0U;
+	double chi2 = 0.0;
+
+	if (alias_table_build(biases, n, prob, alias, work, &total) != 0) {
+		printf("FAIL: could not build alias table\n");
+		return 1;
+	}
+
+	/*
+	 * Entry j is picked with probability (prob[j] + sum of the complements
+	 * of the entries aliased to j) / (n * total), which must be exactly
+	 * biases[j] / total.
+	 */
+	for (unsigned int i = 0U; i < n; i++) {
+		if (prob[i] > total) {
+			printf("FAIL: threshold of entry %u out of range\n", i);
+			return 1;
+		}
+		weight[i] += prob[i];
+		weight[alias[i]] += total - prob[i];
+	}
+
+	for (unsigned int i = 0U; i < n; i++) {
+		uint64_t expected = (biases[i] > 0) ? (uint64_t)biases[i] * n : 0U;
+
+		if (weight[i] != expected) {
+			printf("FAIL: entry %u has weight %llu, expected %llu\n",
+			       i, (unsigned long long)weight[i],
+			       (unsigned long long)expected);
+			return 1;
+		}
+	}
+
+	for (unsigned int s = 0U; s < SAMPLES; s++) {
+		count[alias_table_sample(prob, alias, n, total, rand(), rand())]++;
+	}
+
+	for (unsigned int i = 0U; i < n; i++) {
+		double expected = (double)SAMPLES *
+			((biases[i] > 0) ? biases[i] : 0) / total;
+
+		if (expected == 0.0) {
+			if (count[i] != 0U) {
+				printf("FAIL: entry %u has a null bias but was "
+				       "sampled %lu times\n", i, count[i]);
+				return 1;
+			}
+			continue;
+		}
+
+		chi2 += (count[i] - expected) * (count[i] - expected) /
+			expected;
+		dof++;
+	}
+
+	if (dof > 1U) {
+		dof--;
+	}
+
+	printf("  %u entries, chi2 = %.2f (critical %.2f)\n", n, chi2,
+	       chi2_critical(dof));
+	if (chi2 > chi2_critical(dof)) {
+		printf("FAIL: empirical frequencies do not match the biases\n");
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	/* Bias sets of the nodes in smc_fuzz/dts */
+	static const int sdei_dts[] = { 30, 30, 30, 30, 30, 30, 30 };
+	static const int sample_dts_top[] = { 65, 35 };
+	static const int sample_dts_var1[] = { 30, 30, 35 };
+	static const int sample_dts_var3[] = { 30, 30, 40, 55 };
+	static const int sample_dts_var4[] = { 89, 95, 35 };
+	/* Corner cases */
+	static const int single[] = { 7 };
+	static const int skewed[] = { 1, 1000, 1, 0, 3 };
+	static const struct {
+		const int *biases;
+		unsigned int n;
+	} sets[] = {
+		{ sdei_dts, sizeof(sdei_dts) / sizeof(int) },
+		{ sample_dts_top, sizeof(sample_dts_top) / sizeof(int) },
+		{ sample_dts_var1, sizeof(sample_dts_var1) / sizeof(int) },
+		{ sample_dts_var3, sizeof(sample_dts_var3) / sizeof(int) },
+		{ sample_dts_var4, sizeof(sample_dts_var4) / sizeof(int) },
+		{ single, sizeof(single) / sizeof(int) },
+		{ skewed, sizeof(skewed) / sizeof(int) },
+	};
+	int biases[MAX_ENTRIES];
+	int failed = 0;
+
+	srand(1U);
+
+	if (argc > 1) {
+		if ((unsigned int)(argc - 1) > MAX_ENTRIES) {
+			printf("Too many biases (max %u)\n", MAX_ENTRIES);
+			return 2;
+		}
+		for (int i = 1; i < argc; i++) {
+			biases[i - 1] = atoi(argv[i]);
+		}
+		return check_biases(biases, argc - 1);
+	}
+
+	for (unsigned int i = 0U; i < sizeof(sets) / sizeof(sets[0]); i++) {
+		printf("Bias set %u\n", i);
+		failed |= check_biases(sets[i].biases, sets[i].n);
+	}
+
+	printf("%s\n", failed ? "FAILED" : "PASSED");
+	return failed;
+}
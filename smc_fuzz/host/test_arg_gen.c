@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the SMC argument generators.
+ *
+ * Each generator type is sampled many times and the test checks that every
+ * value is in the domain of the generator and that every value of small
+ * domains is eventually produced.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "arg_gen.h"
+
+#define SAMPLES		100000U
+
+#define CHECK(cond)							\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAILED: %s:%d: %s\n", __FILE__, __LINE__,	\
+			       #cond);					\
+			exit(1);					\
+		}							\
+	} while (0)
+
+static unsigned int randstate = 1U;
+
+static void test_types(void)
+{
+	enum arg_gen_type type;
+
+	CHECK(arg_gen_type_from_name("range", &type) == 0);
+	CHECK(type == ARG_GEN_RANGE);
+	CHECK(arg_gen_type_from_name("mpidr", &type) == 0);
+	CHECK(type == ARG_GEN_MPIDR);
+	CHECK(arg_gen_type_from_name("unknown", &type) != 0);
+}
+
+static void test_check(void)
+{
+	const uint64_t values[2] = { 1U, 2U };
+	struct arg_gen gen = { 0U, ARG_GEN_RANGE, 2U, values };
+
+	CHECK(arg_gen_check(&gen) == 0);
+	gen.nvalues = 1U;
+	CHECK(arg_gen_check(&gen) != 0);
+
+	gen.type = ARG_GEN_CONSTANT;
+	CHECK(arg_gen_check(&gen) == 0);
+
+	gen.type = ARG_GEN_ENUM;
+	CHECK(arg_gen_check(&gen) == 0);
+	gen.nvalues = 0U;
+	CHECK(arg_gen_check(&gen) != 0);
+}
+
+static void test_range(void)
+{
+	const uint64_t values[2] = { 0x84000000U, 0x8400000fU };
+	struct arg_gen gen = { 1U, ARG_GEN_RANGE, 2U, values };
+	unsigned int seen = 0U;
+	uint64_t v;
+
+	for (unsigned int i = 0U; i < SAMPLES; i++) {
+		v = arg_gen_generate(&gen, &randstate);
+		CHECK((v >= values[0]) && (v <= values[1]));
+		seen |= 1U << (v - values[0]);
+	}
+	CHECK(seen == 0xffffU);
+}
+
+static void test_full_range(void)
+{
+	const uint64_t values[2] = { 0U, UINT64_MAX };
+	struct arg_gen gen = { 1U, ARG_GEN_RANGE, 2U, values };
+	uint64_t bits = 0U;
+
+	/* All the bits must get set at some point */
+	for (unsigned int i = 0U; i < SAMPLES; i++) {
+		bits |= arg_gen_generate(&gen, &randstate);
+	}
+	CHECK(bits == UINT64_MAX);
+}
+
+static void test_bitmask(void)
+{
+	const uint64_t values[1] = { 0xf0000000000000f0ULL };
+	struct arg_gen gen = { 2U, ARG_GEN_BITMASK, 1U, values };
+	uint64_t bits = 0U;
+	uint64_t v;
+
+	for (unsigned int i = 0U; i < SAMPLES; i++) {
+		v = arg_gen_generate(&gen, &randstate);
+		CHECK((v & ~values[0]) == 0U);
+		bits |= v;
+	}
+	CHECK(bits == values[0]);
+}
+
+static void test_enum(void)
+{
+	const uint64_t values[3] = { 3U, 0x80000000U, UINT64_MAX };
+	struct arg_gen gen = { 3U, ARG_GEN_ENUM, 3U, values };
+	unsigned int seen = 0U;
+	uint64_t v;
+
+	for (unsigned int i = 0U; i < SAMPLES; i++) {
+		v = arg_gen_generate(&gen, &randstate);
+		for (unsigned int k = 0U; k < 3U; k++) {
+			if (v == values[k]) {
+				seen |= 1U << k;
+			}
+		}
+	}
+	CHECK(seen == 0x7U);
+}
+
+static void test_boundary(void)
+{
+	const uint64_t values[2] = { 16U, 32U };
+	const uint64_t expected[6] = { 16U, 17U, 31U, 32U, 0U, UINT64_MAX };
+	struct arg_gen gen = { 4U, ARG_GEN_BOUNDARY, 2U, values };
+	unsigned int seen = 0U;
+	unsigned int k;
+	uint64_t v;
+
+	for (unsigned int i = 0U; i < SAMPLES; i++) {
+		v = arg_gen_generate(&gen, &randstate);
+		for (k = 0U; k < 6U; k++) {
+			if (v == expected[k]) {
+				seen |= 1U << k;
+				break;
+			}
+		}
+		CHECK(k < 6U);
+	}
+	CHECK(seen == 0x3fU);
+}
+
+int main(void)
+{
+	test_types();
+	test_check();
+	test_range();
+	test_full_range();
+	test_bitmask();
+	test_enum();
+	test_boundary();
+
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the coverage map used by the SMC fuzzer feedback loop.
+ *
+ * The test records tuples which differ in a single field each and checks that
+ * new tuples are reported once, that hits are counted, and that the map stops
+ * accepting new tuples once it is 3/4 full.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "smc_coverage.h"
+
+#define CHECK(cond)							\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAILED: %s:%d: %s\n", __FILE__, __LINE__,	\
+			       #cond);					\
+			exit(1);					\
+		}							\
+	} while (0)
+
+static struct smc_coverage cov;
+
+static void test_new_tuples(void)
+{
+	smc_coverage_init(&cov);
+
+	CHECK(smc_coverage_add(&cov, 0, 0, 0, 0) == 1);
+	CHECK(smc_coverage_add(&cov, 0, 0, 0, 0) == 0);
+
+	/* Each field on its own makes a new tuple */
+	CHECK(smc_coverage_add(&cov, 1, 0, 0, 0) == 1);
+	CHECK(smc_coverage_add(&cov, 0, -1, 0, 0) == 1);
+	CHECK(smc_coverage_add(&cov, 0, 0, 1, 0) == 1);
+	CHECK(smc_coverage_add(&cov, 0, 0, 0, 1) == 1);
+	CHECK(smc_coverage_add(&cov, -1, 0, 0, 0) == 1);
+	CHECK(cov.count == 6U);
+
+	for (unsigned int i = 0U; i < SMC_COVERAGE_SIZE; i++) {
+		const struct smc_coverage_entry *ent = &cov.entries[i];
+
+		if ((ent->hits != 0U) && (ent->funcid == 0) &&
+		    (ent->ret == 0) && (ent->before == 0) &&
+		    (ent->after == 0)) {
+			CHECK(ent->hits == 2U);
+		}
+	}
+}
+
+static void test_full_map(void)
+{
+	unsigned int limit = (SMC_COVERAGE_SIZE / 4U) * 3U;
+
+	smc_coverage_init(&cov);
+
+	for (unsigned int i = 0U; i < limit; i++) {
+		CHECK(smc_coverage_add(&cov, 2, i, 0, 1) == 1);
+	}
+	CHECK(cov.count == limit);
+
+	/* Known tuples are still counted, new ones are dropped */
+	CHECK(smc_coverage_add(&cov, 2, 0, 0, 1) == 0);
+	CHECK(smc_coverage_add(&cov, 3, 0, 0, 1) == 0);
+	CHECK(cov.count == limit);
+	CHECK(cov.dropped == 1U);
+}
+
+int main(void)
+{
+	test_new_tuples();
+	test_full_map();
+
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the SMC fuzzer bias tree loader.
+ *
+ * Bias trees are written with the libfdt sequential write functions, loaded
+ * with the smc_tree code into an smcmalloc pool, then sampled. The test checks
+ * that the leaves are selected with the probabilities given by the biases,
+ * that the argument generators are loaded, that boosting a leaf raises its
+ * probability, and that invalid descriptions are rejected.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libfdt.h>
+
+#include "smc_tree.h"
+#include "smcmalloc.h"
+
+#define FDT_SIZE	4096U
+#define SAMPLES		1000000U
+
+#define CHECK(cond)							\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAILED: %s:%d: %s\n", __FILE__, __LINE__,	\
+			       #cond);					\
+			exit(1);					\
+		}							\
+	} while (0)
+
+static char fdt[FDT_SIZE];
+static struct memmod mmod;
+
+/* Stub backend */
+static const char *const funcs[] = { "a", "b", "c" };
+
+int smc_fuzz_func_id(const char *funcname)
+{
+	for (unsigned int k = 0U; k < (sizeof(funcs) / sizeof(funcs[0])); k++) {
+		if (strcmp(funcname, funcs[k]) == 0) {
+			return k;
+		}
+	}
+
+	return SMC_FUZZ_FUNC_NONE;
+}
+
+unsigned int smc_fuzz_get_mpidrs(uint64_t *mpidrs)
+{
+	if (mpidrs != NULL) {
+		mpidrs[0] = 0x0U;
+		mpidrs[1] = 0x100U;
+	}
+	return 2U;
+}
+
+static void begin_fdt(void)
+{
+	CHECK(fdt_create(fdt, FDT_SIZE) == 0);
+	CHECK(fdt_finish_reservemap(fdt) == 0);
+	CHECK(fdt_begin_node(fdt, "") == 0);
+}
+
+static void end_fdt(void)
+{
+	CHECK(fdt_end_node(fdt) == 0);
+	CHECK(fdt_finish(fdt) == 0);
+}
+
+static void begin_leaf(const char *name, uint32_t bias, const char *funcname)
+{
+	CHECK(fdt_begin_node(fdt, name) == 0);
+	CHECK(fdt_property_u32(fdt, "bias", bias) == 0);
+	CHECK(fdt_property_string(fdt, "functionname", funcname) == 0);
+}
+
+static void add_arg(const char *name, const char *type, const uint64_t *values,
+		    unsigned int nvalues)
+{
+	fdt64_t v[4];
+
+	CHECK(nvalues <= 4U);
+	for (unsigned int i = 0U; i < nvalues; i++) {
+		v[i] = cpu_to_fdt64(values[i]);
+	}
+
+	CHECK(fdt_begin_node(fdt, name) == 0);
+	CHECK(fdt_property_string(fdt, "type", type) == 0);
+	if (nvalues != 0U) {
+		CHECK(fdt_property(fdt, "values", v,
+				   nvalues * sizeof(v[0])) == 0);
+	}
+	CHECK(fdt_end_node(fdt) == 0);
+}
+
+/*
+ * Root
+ *   t1 (65)
+ *     l1 (30, a)
+ *     t2 (35)
+ *       l2 (10, b)
+ *       l3 (30, c, arg0 constant, arg1 mpidr, arg2 range)
+ *   l4 (35, a)
+ */
+static void write_tree(void)
+{
+	const uint64_t fid = 0x84000000U;
+	const uint64_t range[2] = { 5U, 9U };
+
+	begin_fdt();
+	CHECK(fdt_begin_node(fdt, "t1") == 0);
+	CHECK(fdt_property_u32(fdt, "bias", 65) == 0);
+	begin_leaf("l1", 30, "a");
+	CHECK(fdt_end_node(fdt) == 0);
+	CHECK(fdt_begin_node(fdt, "t2") == 0);
+	CHECK(fdt_property_u32(fdt, "bias", 35) == 0);
+	begin_leaf("l2", 10, "b");
+	CHECK(fdt_end_node(fdt) == 0);
+	begin_leaf("l3", 30, "c");
+	add_arg("arg0", "constant", &fid, 1U);
+	add_arg("arg1", "mpidr", NULL, 0U);
+	add_arg("arg2", "range", range, 2U);
+	CHECK(fdt_end_node(fdt) == 0);
+	CHECK(fdt_end_node(fdt) == 0);
+	CHECK(fdt_end_node(fdt) == 0);
+	begin_leaf("l4", 35, "a");
+	CHECK(fdt_end_node(fdt) == 0);
+	end_fdt();
+}
+
+static unsigned int find_node(const struct rand_smc_tree *tree,
+			      const char *name)
+{
+	for (unsigned int i = 0U; i < tree->nnodes; i++) {
+		if (strcmp(tree->nodes[i].name, name) == 0) {
+			return i;
+		}
+	}
+
+	CHECK(0);
+	return 0U;
+}
+
+/*
+ * Sample the tree and check that `leaf` is selected with a frequency close to
+ * `expected`.
+ */
+static void check_frequency(const struct rand_smc_tree *tree, unsigned int leaf,
+			    double expected)
+{
+	uint64_t args[ARG_GEN_MAX_ARGS];
+	unsigned int randstate = 1U;
+	unsigned long count = 0U;
+	double freq;
+
+	for (unsigned int i = 0U; i < SAMPLES; i++) {
+		if (selectsmcleaf(tree, &randstate, args) == leaf) {
+			count++;
+		}
+	}
+
+	freq = (double)count / SAMPLES;
+	printf("  %s: %.4f (expected %.4f)\n", tree->nodes[leaf].name, freq,
+	       expected);
+	CHECK((freq > (expected - 0.005)) && (freq < (expected + 0.005)));
+}
+
+static void test_tree(void)
+{
+	struct rand_smc_tree tree;
+	uint64_t args[ARG_GEN_MAX_ARGS];
+	unsigned int randstate = 1U;
+	unsigned int l3;
+
+	write_tree();
+	initmem(&mmod);
+	CHECK(createsmctree(&tree, fdt, &mmod) == 0);
+	CHECK(mmod.memerror == 0U);
+	CHECK(tree.nnodes == 7U);
+
+	l3 = find_node(&tree, "l3");
+	CHECK(tree.nodes[l3].funcid == 2);
+	CHECK(tree.nodes[l3].nargs == 3U);
+	CHECK(tree.nodes[find_node(&tree, "l1")].nargs == 0U);
+
+	check_frequency(&tree, find_node(&tree, "l1"), 0.65 * (30.0 / 65));
+	check_frequency(&tree, find_node(&tree, "l2"),
+			0.65 * (35.0 / 65) * (10.0 / 40));
+	check_frequency(&tree, l3, 0.65 * (35.0 / 65) * (30.0 / 40));
+	check_frequency(&tree, find_node(&tree, "l4"), 0.35);
+
+	/* Arguments of l3 */
+	for (unsigned int i = 0U; i < 1000U; i++) {
+		if (selectsmcleaf(&tree, &randstate, args) != l3) {
+			continue;
+		}
+		CHECK(args[0] == 0x84000000U);
+		CHECK((args[1] == 0x0U) || (args[1] == 0x100U));
+		CHECK((args[2] >= 5U) && (args[2] <= 9U));
+		CHECK(args[3] == 0U);
+	}
+
+	/* Boosting l2 doubles its bias and the biases of t2 and t1 */
+	boostsmcnode(&tree, find_node(&tree, "l2"));
+	check_frequency(&tree, find_node(&tree, "l2"),
+			(130.0 / 165) * (70.0 / 100) * (20.0 / 50));
+
+	freesmctree(&tree, &mmod);
+	CHECK(mmod.memerror == 0U);
+}
+
+static void test_invalid(void)
+{
+	struct rand_smc_tree tree;
+	const uint64_t one = 1U;
+
+	/* Missing bias */
+	begin_fdt();
+	CHECK(fdt_begin_node(fdt, "l1") == 0);
+	CHECK(fdt_property_string(fdt, "functionname", "a") == 0);
+	CHECK(fdt_end_node(fdt) == 0);
+	end_fdt();
+	initmem(&mmod);
+	CHECK(createsmctree(&tree, fdt, &mmod) != 0);
+
+	/* Tree node without children */
+	begin_fdt();
+	CHECK(fdt_begin_node(fdt, "t1") == 0);
+	CHECK(fdt_property_u32(fdt, "bias", 1) == 0);
+	CHECK(fdt_end_node(fdt) == 0);
+	end_fdt();
+	initmem(&mmod);
+	CHECK(createsmctree(&tree, fdt, &mmod) != 0);
+
+	/* Invalid argument register */
+	begin_fdt();
+	begin_leaf("l1", 1, "a");
+	add_arg("arg8", "constant", &one, 1U);
+	CHECK(fdt_end_node(fdt) == 0);
+	end_fdt();
+	initmem(&mmod);
+	CHECK(createsmctree(&tree, fdt, &mmod) != 0);
+
+	/* Wrong number of values */
+	begin_fdt();
+	begin_leaf("l1", 1, "a");
+	add_arg("arg1", "range", &one, 1U);
+	CHECK(fdt_end_node(fdt) == 0);
+	end_fdt();
+	initmem(&mmod);
+	CHECK(createsmctree(&tree, fdt, &mmod) != 0);
+}
+
+int main(void)
+{
+	test_tree();
+	test_invalid();
+
+	printf("PASSED\n");
+	return 0;
+}
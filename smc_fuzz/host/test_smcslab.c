@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host test of the size-class slab allocator of the SMC fuzzer pools.
+ *
+ * The test checks alignment, reuse of freed objects, allocation of page runs,
+ * exhaustion of the pool, detection of invalid frees and the statistics.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "smcmalloc.h"
+
+#define CHECK(cond)							\
+	do {								\
+		if (!(cond)) {						\
+			printf("FAILED: %s:%d: %s\n", __FILE__, __LINE__,	\
+			       #cond);					\
+			exit(1);					\
+		}							\
+	} while (0)
+
+static struct memmod mmod;
+
+static unsigned int offset(void *ptr)
+{
+	return (char *)ptr - mmod.memory;
+}
+
+static void test_small(void)
+{
+	void *a, *b, *c;
+
+	initmem(&mmod);
+
+	a = smcmalloc(1U, &mmod);
+	b = smcmalloc(17U, &mmod);
+	c = smcmalloc(500U, &mmod);
+	CHECK((a != NULL) && (b != NULL) && (c != NULL));
+	CHECK((offset(a) % 16U) == 0U);
+	CHECK((offset(b) % 32U) == 0U);
+	CHECK((offset(c) % 512U) == 0U);
+
+	/* Each class took its own page */
+	CHECK((offset(a) / SLABPAGESIZE) != (offset(b) / SLABPAGESIZE));
+
+	/* A freed object is the next one given out in its class */
+	CHECK(smcfree(b, &mmod) == 0);
+	CHECK(smcmalloc(20U, &mmod) == b);
+
+	/* Misaligned pointers are rejected */
+	CHECK(smcfree((char *)a + 8, &mmod) != 0);
+	CHECK(mmod.memerror != 0U);
+}
+
+static void test_large(void)
+{
+	void *a, *b;
+	struct smcmemstats stats;
+
+	initmem(&mmod);
+
+	a = smcmalloc(SLABPAGESIZE + 1U, &mmod);
+	CHECK(a != NULL);
+	CHECK((offset(a) % SLABPAGESIZE) == 0U);
+
+	smcmemstats(&mmod, &stats);
+	CHECK(stats.freepages == (SLABPAGES - 2U));
+	CHECK(stats.inuse == (2U * SLABPAGESIZE));
+
+	/* The whole rest of the pool */
+	b = smcmalloc((SLABPAGES - 2U) * SLABPAGESIZE, &mmod);
+	CHECK(b != NULL);
+	CHECK(smcmalloc(16U, &mmod) == NULL);
+	CHECK(mmod.memerror != 0U);
+
+	mmod.memerror = 0U;
+	CHECK(smcfree(a, &mmod) == 0);
+	CHECK(smcfree(a, &mmod) != 0);
+	CHECK(smcfree(b, &mmod) == 0);
+
+	smcmemstats(&mmod, &stats);
+	CHECK(stats.freepages == SLABPAGES);
+	CHECK(stats.largestrun == SLABPAGES);
+	CHECK(stats.inuse == 0U);
+	CHECK(stats.nalloc == 2U);
+	CHECK(stats.nfree == 2U);
+
+	/* The whole pool at once */
+	a = smcmalloc(TOTALMEMORYSIZE, &mmod);
+	CHECK(a == mmod.memory);
+	CHECK(smcfree(a, &mmod) == 0);
+}
+
+static void test_stats(void)
+{
+	struct smcmemstats stats;
+	void *ptrs[64];
+
+	initmem(&mmod);
+
+	for (unsigned int i = 0U; i < 64U; i++) {
+		ptrs[i] = smcmalloc(24U, &mmod);
+		CHECK(ptrs[i] != NULL);
+	}
+	for (unsigned int i = 0U; i < 64U; i += 2U) {
+		CHECK(smcfree(ptrs[i], &mmod) == 0);
+	}
+
+	smcmemstats(&mmod, &stats);
+	CHECK(stats.requested == (64U * 24U));
+	CHECK(stats.allocated == (64U * 32U));
+	CHECK(stats.inuse == (32U * 32U));
+	CHECK(stats.peakinuse == (64U * 32U));
+	CHECK(stats.slabpages == ((64U * 32U) / SLABPAGESIZE));
+	CHECK(stats.freepages == (SLABPAGES - stats.slabpages));
+}
+
+int main(void)
+{
+	test_small();
+	test_large();
+	test_stats();
+
+	printf("PASSED\n");
+	return 0;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+/*
+ * Walker/Vose alias tables, used to pick one of the children of a bias tree
+ * node in constant time with a probability proportional to its bias.
+ *
+ * For a node with n children of biases b[0..n-1] summing to total, entry i of
+ * the table holds a threshold prob[i] in [0, total] and an alias alias[i].
+ * Sampling picks an entry i uniformly, then keeps i with probability
+ * prob[i] / total or takes alias[i] otherwise. All computations are done on
+ * integers so the sampled distribution exactly matches the biases.
+ */
+
+/*
+ * Build the alias table of the n biases in `biases`. `prob` and `alias` must
+ * hold n entries each and `work` is a scratch array of n entries.
+ *
+ * Negative biases are treated as 0. On success, the sum of the biases is
+ * stored in `*total` and 0 is returned. If the biases sum up to 0 or are too
+ * large to be handled, -1 is returned.
+ */
+int alias_table_build(const int *biases, unsigned int n, unsigned int *prob,
+		      int *alias, int *work, unsigned int *total);
+
+/*
+ * Pick an entry of an alias table of n entries from the random numbers
+ * `rnd_entry` and `rnd_thres`.
+ */
+static inline int alias_table_sample(const unsigned int *prob,
+				     const int *alias, unsigned int n,
+				     unsigned int total, unsigned int rnd_entry,
+				     unsigned int rnd_thres)
+{
+	unsigned int i = rnd_entry % n;
+
+	return ((rnd_thres % total) < prob[i]) ? (int)i : alias[i];
+}
+
+#endif /* ALIAS_TABLE_H */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef ARG_GEN_H
+#define ARG_GEN_H
+
+#include <stdint.h>
+
+/*
+ * Generators of the SMC arguments of the leaf nodes of the bias tree.
+ *
+ * A leaf node may declare a generator for any of the argument registers x0 to
+ * x7 with an "argN" subnode, for instance:
+ *
+ *	sdei_event_status {
+ *		bias = <30>;
+ *		functionname = "sdei_event_status";
+ *		arg1 {
+ *			type = "enum";
+ *			values = /bits/ 64 <0 1 0x40000000>;
+ *		};
+ *	};
+ *
+ * The supported types and the values they expect are:
+ *  - "constant": <value>, always the same value;
+ *  - "range": <min max>, any value from min to max inclusive;
+ *  - "enum": <value...>, one of the listed values;
+ *  - "bitmask": <mask>, a random subset of the bits of mask;
+ *  - "boundary": <min max>, one of min, min + 1, max - 1, max, 0 and ~0, which
+ *    are the values around the edges of the range;
+ *  - "mpidr": no values, the MPIDR of one of the CPUs of the platform.
+ *
+ * Registers without a generator are set to 0.
+ */
+
+#define ARG_GEN_MAX_ARGS	8U
+
+enum arg_gen_type {
+	ARG_GEN_CONSTANT,
+	ARG_GEN_RANGE,
+	ARG_GEN_ENUM,
+	ARG_GEN_BITMASK,
+	ARG_GEN_BOUNDARY,
+	ARG_GEN_MPIDR,
+};
+
+struct arg_gen {
+	unsigned int reg;		// Argument register
+	enum arg_gen_type type;
+	unsigned int nvalues;
+	const uint64_t *values;		// Parameters of the generator
+};
+
+/*
+ * Look up a generator type from its name. Return 0 on success, -1 if the name
+ * is unknown.
+ */
+int arg_gen_type_from_name(const char *name, enum arg_gen_type *type);
+
+/*
+ * Return 0 if `gen` has the number of values its type expects, -1 otherwise.
+ * "mpidr" generators must have been given the list of MPIDRs as values.
+ */
+int arg_gen_check(const struct arg_gen *gen);
+
+/*
+ * Generate a value from `gen`, using the random number generator state
+ * `randstate`.
+ */
+uint64_t arg_gen_generate(const struct arg_gen *gen, unsigned int *randstate);
+
+#endif /* ARG_GEN_H */
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SMC_COVERAGE_H
+#define SMC_COVERAGE_H
+
+#include <stdint.h>
+
+/*
+ * Coverage map of the SMC fuzzer.
+ *
+ * Each call is summarised as a tuple made of the function called, its return
+ * value and the state of the firmware observed before and after the call. The
+ * map records the distinct tuples seen by an instance, so that the fuzzer can
+ * tell when a call exercised new behaviour.
+ */
+
+/* Number of tuples the map can hold, must be a power of two */
+#define SMC_COVERAGE_SIZE	256U
+
+struct smc_coverage_entry {
+	int64_t ret;		// Return value of the call
+	int64_t before;		// State observed before the call
+	int64_t after;		// State observed after the call
+	int32_t funcid;		// Function called
+	uint32_t hits;		// Number of calls with this tuple, 0 if unused
+};
+
+struct smc_coverage {
+	struct smc_coverage_entry entries[SMC_COVERAGE_SIZE];
+	unsigned int count;	// Number of distinct tuples recorded
+	unsigned int dropped;	// Number of new tuples that did not fit
+};
+
+void smc_coverage_init(struct smc_coverage *cov);
+
+/*
+ * Record a call in the coverage map. Return 1 if the tuple had not been seen
+ * before, 0 otherwise.
+ *
+ * The map is kept at most 3/4 full. Once it is, new tuples are counted as
+ * dropped and are not reported as new.
+ */
+int smc_coverage_add(struct smc_coverage *cov, int32_t funcid, int64_t ret,
+		     int64_t before, int64_t after);
+
+#endif /* SMC_COVERAGE_H */
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SMC_TREE_H
+#define SMC_TREE_H
+
+#include <stdint.h>
+
+#include "arg_gen.h"
+#include "smcmalloc.h"
+
+/*
+ * Bias tree of the SMC fuzzer, loaded from a device tree description.
+ *
+ * This part of the fuzzer is plain C so that it can be built both into TFTF
+ * and for the host (see smc_fuzz/host). The backend it is linked with provides
+ * smc_fuzz_func_id() and smc_fuzz_get_mpidrs().
+ */
+
+/* Function ID of leaf nodes naming an unknown function */
+#define SMC_FUZZ_FUNC_NONE	(-1)
+
+/* Largest bias boostsmcnode() raises a node to */
+#define SMC_FUZZ_MAX_BIAS	0x10000
+
+/*
+ * Node of the bias tree built from the device tree description. The nodes are
+ * stored in a single array, with the children of each tree node stored
+ * contiguously, so that the whole tree lives in a single allocation.
+ */
+struct rand_smc_node {
+	const char *name;		// Node name, pointing into the DTB
+	const char *funcname;		// Function called by leaf nodes, NULL for tree nodes
+	int funcid;			// Function ID returned by smc_fuzz_func_id()
+	int bias;			// Bias of the node relative to its siblings
+	unsigned int parent;		// Index of the parent node
+	unsigned int firstchild;	// Index of the first child of tree nodes
+	unsigned int nchildren;		// Number of children of tree nodes
+	unsigned int *aliasprob;	// Alias table thresholds, one per child
+	int *alias;			// Alias table aliases, one per child
+	unsigned int biastotal;		// Sum of the biases of the children
+	struct arg_gen *args;		// Argument generators of leaf nodes
+	unsigned int nargs;		// Number of argument generators
+};
+
+/*
+ * Bias tree and the arena holding it
+ */
+struct rand_smc_tree {
+	void *arena;
+	struct rand_smc_node *nodes;	// nodes[0] is the root of the tree
+	unsigned int nnodes;
+	unsigned int *aliasprob;	// Pool of alias table thresholds
+	int *alias;			// Pool of alias table aliases
+	int *aliaswork;			// Scratch space to build alias tables
+	int *biases;			// Scratch space to build alias tables
+	unsigned int nalias;		// Number of alias table entries used
+	struct arg_gen *args;		// Pool of argument generators
+	unsigned int nargs;		// Number of argument generators used
+	uint64_t *values;		// Pool of argument generator values
+	unsigned int nvalues;		// Number of values used
+};
+
+/*
+ * Return the function ID of the function `funcname` named by a leaf node, or
+ * SMC_FUZZ_FUNC_NONE if there is no such function. Provided by the backend.
+ */
+int smc_fuzz_func_id(const char *funcname);
+
+/*
+ * Store the MPIDRs of the CPUs of the platform into `mpidrs` and return their
+ * number. If `mpidrs` is NULL, only return the number of CPUs. Provided by the
+ * backend.
+ */
+unsigned int smc_fuzz_get_mpidrs(uint64_t *mpidrs);
+
+/*
+ * Create the bias tree described by the device tree `fdt`, allocating it from
+ * `mmod`. Return 0 on success, -1 if the description is invalid or the tree
+ * does not fit.
+ */
+int createsmctree(struct rand_smc_tree *tree, const void *fdt,
+		  struct memmod *mmod);
+
+void freesmctree(struct rand_smc_tree *tree, struct memmod *mmod);
+
+/*
+ * Select a leaf node by walking down the tree from the root, then generate
+ * the arguments of the call into `args`, which has ARG_GEN_MAX_ARGS entries.
+ * Return the index of the leaf node.
+ */
+unsigned int selectsmcleaf(const struct rand_smc_tree *tree,
+			   unsigned int *randstate, uint64_t *args);
+
+/*
+ * Double the bias of node `idx` and of its ancestors, up to SMC_FUZZ_MAX_BIAS,
+ * and rebuild the alias tables of their parents.
+ */
+void boostsmcnode(struct rand_smc_tree *tree, unsigned int idx);
+
+#endif /* SMC_TREE_H */
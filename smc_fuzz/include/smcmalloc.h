@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,15 +8,30 @@
 #define SMCMALLOC_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include "fifo3d.h"
 
 #define TOTALMEMORYSIZE (0x10000)
+
+/*
+ * Allocator of the memory pools of the SMC fuzzer.
+ *
+ * By default, the pool is split into SLABPAGESIZE pages. Requests of up to
+ * SLABPAGESIZE / 2 bytes are rounded up to a power of two size class and
+ * served from the free list of their class, which is refilled one page at a
+ * time. Larger requests take a run of contiguous pages. Allocating and
+ * freeing small objects is O(1), and large allocations search a bitmap of
+ * the free pages.
+ *
+ * With SMC_FUZZ_LEGACY_MALLOC=1, the original first-fit allocator of
+ * smcmalloc.c is used instead.
+ */
+#if SMC_FUZZ_LEGACY_MALLOC
+
 #define BLKSPACEDIV (4)
 #define TOPBITSIZE (20)
-#define MAX_NAME_CHARS 50
 
 struct memblk {
 	unsigned int address;
@@ -52,13 +67,55 @@ struct peret {
 	unsigned int pow2;
 };
 
-void initmem(void);
 struct peret priorityencoder(unsigned int);
-void *smcmalloc(unsigned int, struct memmod*);
-int smcfree(void*, struct memmod *);
 #ifdef DEBUG_SMC_MALLOC
 void displayblocks(struct memmod *);
 void displaymalloctable(struct memmod *);
 #endif
 
+#else /* !SMC_FUZZ_LEGACY_MALLOC */
+
+#define SLABPAGESIZE	(0x400)
+#define SLABPAGES	(TOTALMEMORYSIZE / SLABPAGESIZE)
+#define SLABMINSHIFT	(4)
+#define SLABCLASSES	(6)		// 16 to 512 bytes
+
+/*
+ * Usage statistics of a pool, since it was initialized
+ */
+struct smcmemstats {
+	unsigned int nalloc;		// Successful allocations
+	unsigned int nfree;		// Successful frees
+	unsigned int requested;		// Bytes requested by all allocations
+	unsigned int allocated;		// Bytes given out by all allocations
+	unsigned int inuse;		// Bytes given out to live allocations
+	unsigned int peakinuse;		// Largest value of inuse
+	unsigned int slabpages;		// Pages given to size classes
+	unsigned int freepages;		// Pages neither in a slab nor allocated
+	unsigned int largestrun;	// Largest run of free pages
+};
+
+struct memmod {
+	char memory[TOTALMEMORYSIZE];
+	uint64_t freepages;			// Bitmap of the free pages
+	void *freelist[SLABCLASSES];		// Free objects of each class
+	uint8_t pageclass[SLABPAGES];		// Class or state of each page
+	uint8_t pagerun[SLABPAGES];		// Length of large allocations
+	struct smcmemstats stats;
+	unsigned int memerror;
+};
+
+/*
+ * Fill in `stats` with the usage statistics of `mmod`. The internal
+ * fragmentation is allocated - requested, and the external fragmentation shows
+ * as largestrun being smaller than freepages.
+ */
+void smcmemstats(struct memmod *mmod, struct smcmemstats *stats);
+
+#endif /* SMC_FUZZ_LEGACY_MALLOC */
+
+void initmem(struct memmod *mmod);
+void *smcmalloc(unsigned int, struct memmod*);
+int smcfree(void*, struct memmod *);
+
 #endif /* SMCMALLOC_H */
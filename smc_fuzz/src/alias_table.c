@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdint.h>
+
+#include "alias_table.h"
+
+int alias_table_build(const int *biases, unsigned int n, unsigned int *prob,
+		      int *alias, int *work, unsigned int *total)
+{
+	uint64_t sum = 0U;
+	unsigned int nsmall = 0U;
+	unsigned int nlarge = 0U;
+
+	if (n == 0U) {
+		return -1;
+	}
+
+	for (unsigned int i = 0U; i < n; i++) {
+		if (biases[i] > 0) {
+			sum += (unsigned int)biases[i];
+		}
+	}
+
+	/* Scaled biases must fit in prob[] */
+	if ((sum == 0U) || ((sum * n) > UINT32_MAX)) {
+		return -1;
+	}
+
+	/*
+	 * Scale the biases by n so that the average entry is worth sum, and
+	 * sort them into entries below the average (stacked from the start of
+	 * work[]) and entries above it (stacked from its end).
+	 */
+	for (unsigned int i = 0U; i < n; i++) {
+		prob[i] = (biases[i] > 0) ? ((unsigned int)biases[i] * n) : 0U;
+		alias[i] = (int)i;
+		if (prob[i] < sum) {
+			work[nsmall++] = (int)i;
+		} else {
+			work[n - ++nlarge] = (int)i;
+		}
+	}
+
+	/*
+	 * Fill up each small entry with the excess of a large one, which may
+	 * then become small itself.
+	 */
+	while ((nsmall != 0U) && (nlarge != 0U)) {
+		int s = work[--nsmall];
+		int l = work[n - nlarge];
+
+		alias[s] = l;
+		prob[l] -= (unsigned int)sum - prob[s];
+		if (prob[l] < sum) {
+			nlarge--;
+			work[nsmall++] = l;
+		}
+	}
+
+	/* The remaining entries are exactly worth the average */
+	while (nlarge != 0U) {
+		prob[work[n - nlarge--]] = (unsigned int)sum;
+	}
+	while (nsmall != 0U) {
+		prob[work[--nsmall]] = (unsigned int)sum;
+	}
+
+	*total = (unsigned int)sum;
+	return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arg_gen.h"
+
+static const struct {
+	const char *name;
+	enum arg_gen_type type;
+	unsigned int nvalues;		// Expected number of values, 0 for any
+} arg_gen_types[] = {
+	{ "constant", ARG_GEN_CONSTANT, 1U },
+	{ "range", ARG_GEN_RANGE, 2U },
+	{ "enum", ARG_GEN_ENUM, 0U },
+	{ "bitmask", ARG_GEN_BITMASK, 1U },
+	{ "boundary", ARG_GEN_BOUNDARY, 2U },
+	{ "mpidr", ARG_GEN_MPIDR, 0U },
+};
+
+#define ARG_GEN_TYPE_COUNT	(sizeof(arg_gen_types) / sizeof(arg_gen_types[0]))
+
+int arg_gen_type_from_name(const char *name, enum arg_gen_type *type)
+{
+	for (unsigned int i = 0U; i < ARG_GEN_TYPE_COUNT; i++) {
+		if (strcmp(name, arg_gen_types[i].name) == 0) {
+			*type = arg_gen_types[i].type;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+int arg_gen_check(const struct arg_gen *gen)
+{
+	for (unsigned int i = 0U; i < ARG_GEN_TYPE_COUNT; i++) {
+		if (arg_gen_types[i].type != gen->type) {
+			continue;
+		}
+		if (arg_gen_types[i].nvalues == 0U) {
+			return (gen->nvalues != 0U) ? 0 : -1;
+		}
+		return (gen->nvalues == arg_gen_types[i].nvalues) ? 0 : -1;
+	}
+
+	return -1;
+}
+
+/*
+ * rand_r() returns 31 bits at most, combine three of them.
+ */
+static uint64_t rand64(unsigned int *randstate)
+{
+	uint64_t r = (uint64_t)rand_r(randstate) << 62;
+
+	r ^= (uint64_t)rand_r(randstate) << 31;
+	r ^= (uint64_t)rand_r(randstate);
+
+	return r;
+}
+
+uint64_t arg_gen_generate(const struct arg_gen *gen, unsigned int *randstate)
+{
+	uint64_t min, max, span;
+
+	switch (gen->type) {
+	case ARG_GEN_CONSTANT:
+		return gen->values[0];
+
+	case ARG_GEN_RANGE:
+		min = gen->values[0];
+		max = gen->values[1];
+		if (max < min) {
+			return min;
+		}
+		/* A span of 0 stands for the whole 64-bit range */
+		span = max - min + 1U;
+		return (span == 0U) ? rand64(randstate) :
+			(min + (rand64(randstate) % span));
+
+	case ARG_GEN_BITMASK:
+		return rand64(randstate) & gen->values[0];
+
+	case ARG_GEN_BOUNDARY:
+		min = gen->values[0];
+		max = gen->values[1];
+		switch (rand_r(randstate) % 6) {
+		case 0:
+			return min;
+		case 1:
+			return min + 1U;
+		case 2:
+			return max - 1U;
+		case 3:
+			return max;
+		case 4:
+			return 0U;
+		default:
+			return UINT64_MAX;
+		}
+
+	case ARG_GEN_ENUM:
+	case ARG_GEN_MPIDR:
+		return gen->values[(unsigned int)rand_r(randstate) %
+				   gen->nvalues];
+
+	default:
+		return 0U;
+	}
+}
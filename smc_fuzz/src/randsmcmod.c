@@ -1,573 +1,531 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
 #include <arch_helpers.h>
+#include <assert.h>
+#include <cassert.h>
 #include <debug.h>
 #include <drivers/arm/private_timer.h>
 #include <events.h>
-#include "fifo3d.h"
-#include <libfdt.h>
+#include "arg_gen.h"
+#include "smc_coverage.h"
+#include "smc_tree.h"
+#include "smcmalloc.h"
 
 #include <power_management.h>
 #include <sdei.h>
 #include <tftf_lib.h>
 #include <timer.h>
+#include <utils_def.h>
 
 #include <plat_topology.h>
 #include <platform.h>
 
 extern char _binary___dtb_start[];
 
-struct memmod tmod __aligned(65536) __section("smcfuzz");
-
 /*
- * switch to use either standard C malloc or custom SMC malloc
+ * In multi-core mode, up to SMC_FUZZ_POOL_COUNT instances run concurrently on
+ * different CPUs, each with its own memory pool.
  */
-
-#define FIRST_NODE_DEVTREE_OFFSET (8)
-
-#ifdef SMC_FUZZ_TMALLOC
-#define GENMALLOC(x)	malloc((x))
-#define GENFREE(x)	free((x))
+#if SMC_FUZZ_MULTICORE
+#define SMC_FUZZ_CPU_COUNT	SMC_FUZZ_POOL_COUNT
 #else
-#define GENMALLOC(x)	smcmalloc((x), mmod)
-#define GENFREE(x)	smcfree((x), mmod)
+#define SMC_FUZZ_CPU_COUNT	1
 #endif
 
-/*
- * Device tree parameter struct
- */
+CASSERT(SMC_FUZZ_CPU_COUNT <= PLATFORM_CORE_COUNT,
+	assert_smc_fuzz_pool_count_too_big);
 
-struct fdt_header_sf {
-	unsigned int magic;
-	unsigned int totalsize;
-	unsigned int off_dt_struct;
-	unsigned int off_dt_strings;
-	unsigned int off_mem_rsvmap;
-	unsigned int version;
-	unsigned int last_comp_version;
-	unsigned int boot_cpuid_phys;
-	unsigned int size_dt_strings;
-	unsigned int size_dt_struct;
-};
+struct memmod tmod[SMC_FUZZ_CPU_COUNT] __aligned(65536) __section("smcfuzz");
 
 /*
- * Structure to read the fields of the device tree
+ * SMC fuzzing functions. Each one issues an SMC and checks its return value.
+ * args[] holds the values of x0 to x7 generated for the call, see arg_gen.h.
  */
-struct propval {
-	unsigned int len;
-	unsigned int nameoff;
-};
+static int64_t fuzz_sdei_version(const uint64_t *args)
+{
+	int64_t ret = sdei_version();
 
-/*
- * Converting from big endian to little endian to read values
- * of device tree
- */
-unsigned int lendconv(unsigned int val)
+	if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
+		tftf_testcase_printf("Unexpected SDEI version: 0x%llx\n", ret);
+	}
+	return ret;
+}
+
+static int64_t fuzz_sdei_pe_unmask(const uint64_t *args)
 {
-	unsigned int res;
+	int64_t ret = sdei_pe_unmask();
 
-	res = val << 24;
-	res |= ((val << 8) & 0xFF0000U);
-	res |= ((val >> 8) & 0xFF00U);
-	res |= ((val >> 24) & 0xFFU);
-	return res;
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI pe unmask failed: 0x%llx\n", ret);
+	}
+	return ret;
 }
 
-/*
- * Function to read strings from device tree
- */
-void pullstringdt(void **dtb,
-		  void *dtb_beg,
-		  unsigned int offset,
-		  char *cset)
+static int64_t fuzz_sdei_pe_mask(const uint64_t *args)
 {
-	int fistr;
-	int cntchr;
-	char rval;
+	int64_t ret = sdei_pe_mask();
 
-	if (offset != 0U) {
-		*dtb = dtb_beg + offset;
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI pe mask failed: 0x%llx\n", ret);
 	}
-	fistr = 0;
-
-	cntchr = 0;
-	while (fistr == 0) {
-		rval = *((char *)*dtb);
-		*dtb += sizeof(char);
-		cset[cntchr] = rval;
-		if (cset[cntchr] == 0) {
-			fistr = 1;
-		}
-		cntchr++;
+	return ret;
+}
+
+static int64_t fuzz_sdei_event_status(const uint64_t *args)
+{
+	int64_t ret = sdei_event_status((int32_t)args[1]);
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI event status failed: 0x%llx\n", ret);
 	}
+	return ret;
+}
 
-	if ((cntchr % 4) != 0) {
-		for (unsigned int i = 0U; (int)i < (4 - (cntchr % 4)); i++) {
-			*dtb += sizeof(char);
-		}
+static int64_t fuzz_sdei_event_signal(const uint64_t *args)
+{
+	int64_t ret = sdei_event_signal(args[1]);
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI event signal failed: 0x%llx\n", ret);
 	}
+	return ret;
+}
+
+static int64_t fuzz_sdei_private_reset(const uint64_t *args)
+{
+	int64_t ret = sdei_private_reset();
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI private reset failed: 0x%llx\n", ret);
+	}
+	return ret;
+}
+
+static int64_t fuzz_sdei_shared_reset(const uint64_t *args)
+{
+	int64_t ret = sdei_shared_reset();
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI shared reset failed: 0x%llx\n", ret);
+	}
+	return ret;
+}
+
+/*
+ * Generic SMCCC call, issued with the function ID and arguments generated for
+ * the leaf node. This lets a bias tree cover any service, such as PSCI, FF-A
+ * or SiP services, without adding code to the fuzzer.
+ */
+static int64_t fuzz_smc(const uint64_t *args)
+{
+	smc_args smc = {
+		.fid = (uint32_t)args[0],
+		.arg1 = (u_register_t)args[1],
+		.arg2 = (u_register_t)args[2],
+		.arg3 = (u_register_t)args[3],
+		.arg4 = (u_register_t)args[4],
+		.arg5 = (u_register_t)args[5],
+		.arg6 = (u_register_t)args[6],
+		.arg7 = (u_register_t)args[7],
+	};
+	smc_ret_values ret = tftf_smc(&smc);
+
+	return (int64_t)ret.ret0;
 }
 
 /*
- * Structure for Node information extracted from device tree
+ * Table of the functions that leaf nodes of the bias tree can name in their
+ * "functionname" property. Leaf nodes are resolved to an index in this table
+ * once, when the bias tree is built.
  */
-struct rand_smc_node {
-	int *biases;				 // Biases of the individual nodes
-	int *biasarray;				 // Array of biases across all nodes
-	char **snames;				 // String that is unique to the SMC call called in test
-	struct rand_smc_node *treenodes;	 // Selection of nodes that are farther down in the tree
-						// that reference further rand_smc_node objects
-	int *norcall;				// Specifies whether a particular node is a leaf node or tree node
-	int entries;				// Number of nodes in object
-	int biasent;				// Number that gives the total number of entries in biasarray
-						// based on all biases of the nodes
-	char **nname;				// Array of node names
+struct smc_fuzz_func {
+	const char *name;
+	int64_t (*func)(const uint64_t *args);
 };
 
+static const struct smc_fuzz_func smc_fuzz_funcs[] = {
+	{ "sdei_version", fuzz_sdei_version },
+	{ "sdei_pe_unmask", fuzz_sdei_pe_unmask },
+	{ "sdei_pe_mask", fuzz_sdei_pe_mask },
+	{ "sdei_event_status", fuzz_sdei_event_status },
+	{ "sdei_event_signal", fuzz_sdei_event_signal },
+	{ "sdei_private_reset", fuzz_sdei_private_reset },
+	{ "sdei_shared_reset", fuzz_sdei_shared_reset },
+	{ "smc", fuzz_smc },
+};
+
+#define SMC_FUZZ_FUNC_COUNT	ARRAY_SIZE(smc_fuzz_funcs)
 
 /*
- * Create bias tree from given device tree description
+ * Resolve a function name into an index in smc_fuzz_funcs[]
  */
-
-struct rand_smc_node *createsmctree(int *casz,
-				    struct memmod *mmod)
+int smc_fuzz_func_id(const char *funcname)
 {
-	void *dtb;
-	void *dtb_pn;
-	void *dtb_beg;
-	struct fdt_header fhd;
-	unsigned int rval;
-	struct propval pv;
-	char cset[MAX_NAME_CHARS];
-	char nodename[MAX_NAME_CHARS];
-	int dtdone;
-	struct fifo3d f3d;
-	int leafnode = 0;
-	unsigned int fnode = 0U;
-	unsigned int bias_count = 0U;
-	unsigned int bintnode = 0U;
-	unsigned int treenodetrack = 0U;
-	struct fdt_header *fhdptr;
-	struct rand_smc_node *ndarray = NULL;
-	int cntndarray;
-	struct rand_smc_node nrnode;
-	struct rand_smc_node *tndarray;
-
-	f3d.col = 0;
-	f3d.curr_col = 0;
+	for (unsigned int k = 0U; k < SMC_FUZZ_FUNC_COUNT; k++) {
+		if (strcmp(funcname, smc_fuzz_funcs[k].name) == 0) {
+			return k;
+		}
+	}
 
-	/*
-	 * Read device tree header and check for valid type
-	 */
+	return SMC_FUZZ_FUNC_NONE;
+}
 
-	fhdptr = (struct fdt_header *)_binary___dtb_start;
+/*
+ * MPIDRs of the CPUs of the platform, for the "mpidr" argument generators
+ */
+unsigned int smc_fuzz_get_mpidrs(uint64_t *mpidrs)
+{
+	unsigned int cpu_node;
+	unsigned int count = 0U;
 
-	if (fdt_check_header((void *)fhdptr) != 0) {
-		printf("ERROR, not device tree compliant\n");
+	for_each_cpu(cpu_node) {
+		if (mpidrs != NULL) {
+			mpidrs[count] = tftf_get_mpidr_from_node(cpu_node);
+		}
+		count++;
 	}
-	fhd = *fhdptr;
-	cntndarray = 0;
-	nrnode.entries = 0;
 
-	/*
-	 * Create pointers to device tree data
-	 */
-	dtb = _binary___dtb_start;
-	dtb_pn = _binary___dtb_start;
+	return count;
+}
 
-	dtb_beg = dtb;
-	fhd = *((struct fdt_header *)dtb);
-	dtb += (fdt32_to_cpu(fhd.off_dt_struct) + FIRST_NODE_DEVTREE_OFFSET);
-	dtdone = 0;
 
-	/*
-	 * Reading device tree file
-	 */
-	while (dtdone == 0) {
-		rval = *((unsigned int *)dtb);
-		dtb += sizeof(unsigned int);
-
-		/*
-		 * Reading node name from device tree and pushing it into the raw data
-		 * Table of possible values reading from device tree binary file:
-		 * 1	New node found within current tree, possible leaf or tree variant
-		 * 2 	Node termination of current hiearchy.
-		 *     Could indicate end of tree or preparation for another branch
-		 * 3 	Leaf node indication where a bias with a function name should be
-		 *     found for the current node
-		 * 9  	End of device tree file and we end the read of the bias tree
-		 */
-		if (fdt32_to_cpu(rval) == 1) {
-			pullstringdt(&dtb, dtb_beg, 0U, cset);
-			push_3dfifo_col(&f3d, cset, mmod);
-			strlcpy(nodename, cset, MAX_NAME_CHARS);
-
-			/*
-			 * Error checking to make sure that bias is specified
-			 */
-			if (fnode == 0U) {
-				fnode = 1U;
-			} else {
-				if (!((fnode == 1U) && (bias_count == 1U))) {
-					printf("ERROR: Did not find bias or multiple bias ");
-					printf("designations before %s %u %u\n",
-					cset, fnode, bias_count);
-				}
-				bias_count = 0U;
-			}
-		}
+/*
+ * With feedback enabled, the state of the firmware is probed after each call
+ * and every call that produces a new (function, return value, state before,
+ * state after) tuple doubles the bias of the path to its leaf node in the bias
+ * tree, as well as the bias of the path to the leaf called just before it.
+ */
+#if SMC_FUZZ_FEEDBACK
+/*
+ * The state probed is the status of the SDEI event the fuzzing functions act
+ * on, which captures the registered, enabled and running transitions.
+ */
+static int64_t smc_fuzz_probe_state(void)
+{
+	return sdei_event_status(0);
+}
+#endif
 
-		/*
-		 * Reading node parameters of bias and function name
-		 */
-		if (fdt32_to_cpu(rval) == 3) {
-			pv = *((struct propval *)dtb);
-			dtb += sizeof(struct propval);
-			pullstringdt(&dtb_pn, dtb_beg,
-				     (fdt32_to_cpu(fhd.off_dt_strings) +
-				      fdt32_to_cpu(pv.nameoff)), cset);
-			if (strcmp(cset, "bias") == 0) {
-				rval = *((unsigned int *)dtb);
-				dtb += sizeof(unsigned int);
-				push_3dfifo_bias(&f3d, fdt32_to_cpu(rval));
-				bias_count++;
-				if (bintnode == 1U) {
-					fnode = 0U;
-					bintnode = 0U;
-					bias_count = 0U;
-				}
-			}
-			if (strcmp(cset, "functionname") == 0) {
-				pullstringdt(&dtb, dtb_beg, 0, cset);
-				push_3dfifo_fname(&f3d, cset);
-				leafnode = 1;
-				if (bias_count == 0U) {
-					bintnode = 1U;
-					fnode = 1U;
-				} else {
-					bias_count = 0U;
-					fnode = 0U;
-				}
-			}
-		}
+/*
+ * Compact trace of the last SMC_FUZZ_TRACE_SIZE calls of an instance, kept in
+ * memory rather than printed as calls are made.
+ */
+#define SMC_FUZZ_TRACE_SIZE	256U
 
-		/*
-		 * Node termination and evaluate whether the bias tree requires addition.
-		 * The non tree nodes are added.
-		 */
-		if (fdt32_to_cpu(rval) == 2) {
-			if ((fnode > 0U) || (bias_count > 0U)) {
-				printf("ERROR: early node termination... ");
-				printf("no bias or functionname field for leaf node, near %s %u\n",
-				nodename, fnode);
-			}
-			f3d.col--;
-			if (leafnode == 1) {
-				leafnode = 0;
-			} else {
-				/*
-				 * Create bias tree in memory from raw data
-				 */
-				tndarray =
-					GENMALLOC((cntndarray + 1) *
-						   sizeof(struct rand_smc_node));
-				unsigned int treenodetrackmal = 0;
-				for (unsigned int j = 0U; (int)j < cntndarray; j++) {
-					tndarray[j].biases = GENMALLOC(ndarray[j].entries * sizeof(int));
-					tndarray[j].snames = GENMALLOC(ndarray[j].entries * sizeof(char *));
-					tndarray[j].norcall = GENMALLOC(ndarray[j].entries * sizeof(int));
-					tndarray[j].nname = GENMALLOC(ndarray[j].entries * sizeof(char *));
-					tndarray[j].treenodes = GENMALLOC(ndarray[j].entries * sizeof(struct rand_smc_node));
-					tndarray[j].entries = ndarray[j].entries;
-					for (unsigned int i = 0U; (int)i < ndarray[j].entries; i++) {
-						tndarray[j].snames[i] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
-						strlcpy(tndarray[j].snames[i], ndarray[j].snames[i], MAX_NAME_CHARS);
-						tndarray[j].nname[i] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
-						strlcpy(tndarray[j].nname[i], ndarray[j].nname[i], MAX_NAME_CHARS);
-						tndarray[j].biases[i] = ndarray[j].biases[i];
-						tndarray[j].norcall[i] = ndarray[j].norcall[i];
-						if (tndarray[j].norcall[i] == 1) {
-							tndarray[j].treenodes[i] = tndarray[treenodetrackmal];
-							treenodetrackmal++;
-						}
-					}
-					tndarray[j].biasent = ndarray[j].biasent;
-					tndarray[j].biasarray = GENMALLOC((tndarray[j].biasent) * sizeof(int));
-					for (unsigned int i = 0U; (int)i < ndarray[j].biasent; i++) {
-						tndarray[j].biasarray[i] = ndarray[j].biasarray[i];
-					}
-				}
-				tndarray[cntndarray].biases = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(int));
-				tndarray[cntndarray].snames = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(char *));
-				tndarray[cntndarray].norcall = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(int));
-				tndarray[cntndarray].nname = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(char *));
-				tndarray[cntndarray].treenodes = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(struct rand_smc_node));
-				tndarray[cntndarray].entries = f3d.row[f3d.col + 1];
-
-				/*
-				 * Populate bias tree with former values in tree
-				 */
-				int cntbias = 0;
-				int bias_count = 0;
-				for (unsigned int j = 0U; (int)j < f3d.row[f3d.col + 1]; j++) {
-					tndarray[cntndarray].snames[j] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
-					strlcpy(tndarray[cntndarray].snames[j], f3d.fnamefifo[f3d.col + 1][j], MAX_NAME_CHARS);
-					tndarray[cntndarray].nname[j] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
-					strlcpy(tndarray[cntndarray].nname[j], f3d.nnfifo[f3d.col + 1][j], MAX_NAME_CHARS);
-					tndarray[cntndarray].biases[j] = f3d.biasfifo[f3d.col + 1][j];
-					cntbias += tndarray[cntndarray].biases[j];
-					if (strcmp(tndarray[cntndarray].snames[j], "none") != 0) {
-						strlcpy(tndarray[cntndarray].snames[j], f3d.fnamefifo[f3d.col + 1][j], MAX_NAME_CHARS);
-						tndarray[cntndarray].norcall[j] = 0;
-						tndarray[cntndarray].treenodes[j] = nrnode;
-					} else {
-						tndarray[cntndarray].norcall[j] = 1;
-						tndarray[cntndarray].treenodes[j] = tndarray[treenodetrack];
-						treenodetrack++;
-					}
-				}
-
-				tndarray[cntndarray].biasent = cntbias;
-				tndarray[cntndarray].biasarray = GENMALLOC((tndarray[cntndarray].biasent) * sizeof(int));
-				for (unsigned int j = 0U; j < tndarray[cntndarray].entries; j++) {
-					for (unsigned int i = 0U; i < tndarray[cntndarray].biases[j]; i++) {
-						tndarray[cntndarray].biasarray[bias_count] = j;
-						bias_count++;
-					}
-				}
-
-				/*
-				 * Free memory of old bias tree
-				 */
-				if (cntndarray > 0) {
-					for (unsigned int j = 0U; (int)j < cntndarray; j++) {
-						for (unsigned int i = 0U;
-						     (int)i < ndarray[j].entries;
-						     i++) {
-							GENFREE(ndarray[j].snames[i]);
-							GENFREE(ndarray[j].nname[i]);
-						}
-						GENFREE(ndarray[j].biases);
-						GENFREE(ndarray[j].norcall);
-						GENFREE(ndarray[j].biasarray);
-						GENFREE(ndarray[j].snames);
-						GENFREE(ndarray[j].nname);
-						GENFREE(ndarray[j].treenodes);
-					}
-					GENFREE(ndarray);
-				}
-
-				/*
-				 * Move pointers to new bias tree to current tree
-				 */
-				ndarray = tndarray;
-				cntndarray++;
-
-				/*
-				 * Free raw data
-				 */
-				for (unsigned int j = 0U; (int)j < f3d.row[f3d.col + 1]; j++) {
-					GENFREE(f3d.nnfifo[f3d.col + 1][j]);
-					GENFREE(f3d.fnamefifo[f3d.col + 1][j]);
-				}
-				GENFREE(f3d.nnfifo[f3d.col + 1]);
-				GENFREE(f3d.fnamefifo[f3d.col + 1]);
-				GENFREE(f3d.biasfifo[f3d.col + 1]);
-				f3d.curr_col -= 1;
-			}
-		}
+struct smc_fuzz_trace_entry {
+	uint64_t args[ARG_GEN_MAX_ARGS];
+	int64_t ret;
+	uint32_t call;
+	int32_t funcid;
+};
 
-		/*
-		 * Ending device tree file and freeing raw data
-		 */
-		if (fdt32_to_cpu(rval) == 9) {
-			for (unsigned int i = 0U; (int)i < f3d.col; i++) {
-				for (unsigned int j = 0U; (int)j < f3d.row[i]; j++) {
-					GENFREE(f3d.nnfifo[i][j]);
-					GENFREE(f3d.fnamefifo[i][j]);
-				}
-				GENFREE(f3d.nnfifo[i]);
-				GENFREE(f3d.fnamefifo[i]);
-				GENFREE(f3d.biasfifo[i]);
-			}
-			GENFREE(f3d.nnfifo);
-			GENFREE(f3d.fnamefifo);
-			GENFREE(f3d.biasfifo);
-			GENFREE(f3d.row);
-			dtdone = 1;
-		}
+struct smc_fuzz_trace {
+	struct smc_fuzz_trace_entry entries[SMC_FUZZ_TRACE_SIZE];
+	uint32_t ncalls;
+	uint32_t func_calls[SMC_FUZZ_FUNC_COUNT];
+};
+
+/*
+ * State of an instance running on a CPU
+ */
+struct smc_fuzz_ctx {
+	unsigned int instance;		// Instance number
+	uint32_t seed;			// Seed of the instance
+	unsigned int randstate;		// State of the random number generator
+	u_register_t mpid;		// CPU running the instance
+	struct memmod *mmod;		// Memory pool of the instance
+	struct smc_fuzz_trace trace;	// Replay log of the instance
+#if SMC_FUZZ_FEEDBACK
+	struct smc_coverage cov;	// Coverage map of the instance
+	unsigned int boosts;		// Number of calls which raised biases
+#endif
+	uint64_t elapsed;		// Duration of the calls, in ticks
+	test_result_t result;
+	event_t done;
+};
+
+static struct smc_fuzz_ctx fuzz_ctx[SMC_FUZZ_CPU_COUNT];
+static unsigned int fuzz_ctx_count;
+
+/*
+ * Running SMC call from the function ID of the selected leaf node
+ */
+int64_t runtestfunction(struct smc_fuzz_trace *trace, int funcid,
+			const uint64_t *args)
+{
+	struct smc_fuzz_trace_entry *ent;
+	int64_t ret = 0;
+
+	if (funcid != SMC_FUZZ_FUNC_NONE) {
+		ret = smc_fuzz_funcs[funcid].func(args);
+		trace->func_calls[funcid]++;
 	}
 
+	ent = &trace->entries[trace->ncalls % SMC_FUZZ_TRACE_SIZE];
+	memcpy(ent->args, args, sizeof(ent->args));
+	ent->ret = ret;
+	ent->call = trace->ncalls;
+	ent->funcid = funcid;
+	trace->ncalls++;
 
-	*casz = cntndarray;
-	return ndarray;
+	return ret;
 }
 
 /*
- * Running SMC call from what function name is selected
+ * Print the per-function call counts and the last calls of the trace
  */
-void runtestfunction(char *funcstr)
+static void dumptrace(const struct smc_fuzz_trace *trace)
 {
-	if (strcmp(funcstr, "sdei_version") == 0) {
-		long long ret = sdei_version();
-		if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
-			tftf_testcase_printf("Unexpected SDEI version: 0x%llx\n",
-					     ret);
-		}
-		printf("running %s\n", funcstr);
-	}
-	if (strcmp(funcstr, "sdei_pe_unmask") == 0) {
-		long long ret = sdei_pe_unmask();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI pe unmask failed: 0x%llx\n",
-					     ret);
-		}
-		printf("running %s\n", funcstr);
-	}
-	if (strcmp(funcstr, "sdei_pe_mask") == 0) {
-		int64_t ret = sdei_pe_mask();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI pe mask failed: 0x%llx\n", ret);
-		}
-		printf("running %s\n", funcstr);
-	}
-	if (strcmp(funcstr, "sdei_event_status") == 0) {
-		int64_t ret = sdei_event_status(0);
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI event status failed: 0x%llx\n",
-					     ret);
+	for (unsigned int k = 0U; k < SMC_FUZZ_FUNC_COUNT; k++) {
+		if (trace->func_calls[k] != 0U) {
+			printf("    %s: %u calls\n", smc_fuzz_funcs[k].name,
+			       trace->func_calls[k]);
 		}
-		printf("running %s\n", funcstr);
 	}
-	if (strcmp(funcstr, "sdei_event_signal") == 0) {
-		int64_t ret = sdei_event_signal(0);
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI event signal failed: 0x%llx\n",
-					     ret);
-		}
-		printf("running %s\n", funcstr);
+
+#if LOG_LEVEL >= LOG_LEVEL_VERBOSE
+	uint32_t first = (trace->ncalls > SMC_FUZZ_TRACE_SIZE) ?
+		(trace->ncalls - SMC_FUZZ_TRACE_SIZE) : 0U;
+
+	for (uint32_t i = first; i < trace->ncalls; i++) {
+		const struct smc_fuzz_trace_entry *ent =
+			&trace->entries[i % SMC_FUZZ_TRACE_SIZE];
+
+		VERBOSE("    #%u %s(0x%llx, 0x%llx, 0x%llx, 0x%llx, "
+			"0x%llx, 0x%llx, 0x%llx, 0x%llx) -> 0x%llx\n",
+			ent->call,
+			(ent->funcid == SMC_FUZZ_FUNC_NONE) ? "none" :
+			smc_fuzz_funcs[ent->funcid].name,
+			(unsigned long long)ent->args[0],
+			(unsigned long long)ent->args[1],
+			(unsigned long long)ent->args[2],
+			(unsigned long long)ent->args[3],
+			(unsigned long long)ent->args[4],
+			(unsigned long long)ent->args[5],
+			(unsigned long long)ent->args[6],
+			(unsigned long long)ent->args[7],
+			(unsigned long long)ent->ret);
 	}
-	if (strcmp(funcstr, "sdei_private_reset") == 0) {
-		int64_t ret = sdei_private_reset();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI private reset failed: 0x%llx\n",
-					     ret);
-		}
-		printf("running %s\n", funcstr);
+#endif
+}
+
+#if SMC_FUZZ_FEEDBACK
+/*
+ * Print the coverage map of an instance, grouped by function
+ */
+static void dumpcoverage(const struct smc_fuzz_ctx *ctx)
+{
+	const struct smc_coverage *cov = &ctx->cov;
+
+	printf("    Coverage: %u tuples, %u bias boosts", cov->count,
+	       ctx->boosts);
+	if (cov->dropped != 0U) {
+		printf(", %u tuples dropped", cov->dropped);
 	}
-	if (strcmp(funcstr, "sdei_shared_reset") == 0) {
-		int64_t ret = sdei_shared_reset();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI shared reset failed: 0x%llx\n",
-					     ret);
+	printf("\n");
+
+	for (int k = SMC_FUZZ_FUNC_NONE; k < (int)SMC_FUZZ_FUNC_COUNT; k++) {
+		for (unsigned int i = 0U; i < SMC_COVERAGE_SIZE; i++) {
+			const struct smc_coverage_entry *ent = &cov->entries[i];
+
+			if ((ent->hits == 0U) || (ent->funcid != k)) {
+				continue;
+			}
+			printf("      %s: ret 0x%llx, ",
+			       (k == SMC_FUZZ_FUNC_NONE) ? "none" :
+			       smc_fuzz_funcs[k].name,
+			       (unsigned long long)ent->ret);
+			printf("state 0x%llx -> 0x%llx, %u calls\n",
+			       (unsigned long long)ent->before,
+			       (unsigned long long)ent->after, ent->hits);
 		}
-		printf("running %s\n", funcstr);
 	}
 }
+#endif
+
+#if !SMC_FUZZ_LEGACY_MALLOC
+/*
+ * Print the usage statistics of the memory pool of an instance
+ */
+static void dumppoolstats(struct memmod *mmod)
+{
+	struct smcmemstats stats;
+
+	smcmemstats(mmod, &stats);
+	printf("    Pool: %u allocations, peak %u bytes, %u bytes of rounding\n",
+	       stats.nalloc, stats.peakinuse,
+	       stats.allocated - stats.requested);
+	printf("    Pool: %u slab pages, %u free pages, largest free run %u\n",
+	       stats.slabpages, stats.freepages, stats.largestrun);
+}
+#endif
 
 /*
- * Function executes a single SMC fuzz test instance with a supplied seed.
+ * Function executes a single SMC fuzz test instance with the seed and memory
+ * pool of the supplied context.
  */
-test_result_t smc_fuzzing_instance(uint32_t seed)
+static test_result_t smc_fuzzing_instance(struct smc_fuzz_ctx *ctx)
 {
+	uint64_t start;
+	uint64_t args[ARG_GEN_MAX_ARGS];
+	unsigned int leaf;
+	int funcid;
+#if SMC_FUZZ_FEEDBACK
+	unsigned int prevleaf = 0U;
+	int64_t ret, before, after;
+#endif
+	struct memmod *mmod = ctx->mmod;
+	struct rand_smc_tree tree;
+
 	/*
 	 * Setting up malloc block parameters
 	 */
-	tmod.memptr = (void *)tmod.memory;
-	tmod.memptrend = (void *)tmod.memory;
-	tmod.maxmemblk = ((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk));
-	tmod.nmemblk = 1;
-	tmod.memptr->address = 0U;
-	tmod.memptr->size = TOTALMEMORYSIZE - (TOTALMEMORYSIZE / BLKSPACEDIV);
-	tmod.memptr->valid = 1;
-	tmod.mallocdeladd[0] = 0U;
-	tmod.precblock[0] = (void *)tmod.memory;
-	tmod.trailblock[0] = NULL;
-	tmod.cntdeladd = 0U;
-	tmod.ptrmemblkqueue = 0U;
-	tmod.mallocdeladd_queue_cnt = 0U;
-	tmod.checkadd = 1U;
-	tmod.checknumentries = 0U;
-	tmod.memerror = 0U;
-	struct memmod *mmod;
-	mmod = &tmod;
-	int cntndarray;
-	struct rand_smc_node *tlnode;
+	initmem(mmod);
 
 	/*
 	 * Creating SMC bias tree
 	 */
-	struct rand_smc_node *ndarray = createsmctree(&cntndarray, &tmod);
-
-	if (tmod.memerror != 0) {
+	if ((createsmctree(&tree, _binary___dtb_start, mmod) != 0) ||
+	    (mmod->memerror != 0)) {
 		return TEST_RESULT_FAIL;
 	}
 
 	/*
 	 * Initialize pseudo random number generator with supplied seed.
+	 * Each instance has its own generator state so that the sequence of
+	 * calls only depends on the seed, even when instances run concurrently.
 	 */
-	srand(seed);
+	ctx->randstate = ctx->seed;
+	memset(&ctx->trace, 0, sizeof(ctx->trace));
+#if SMC_FUZZ_FEEDBACK
+	smc_coverage_init(&ctx->cov);
+	ctx->boosts = 0U;
+	before = smc_fuzz_probe_state();
+#endif
 
 	/*
-	 * Code to traverse the bias tree and select function based on the biaes within
-	 *
-	 * The algorithm starts with the first node to pull up the biasarray.  The
-	 * array is specified as a series of values that reflect the bias of the nodes
-	 * in question. So for instance if there are three nodes with a bias of 2,5,7
-	 * the biasarray would have the following constituency:
-	 *
-	 * 0,0,1,1,1,1,1,2,2,2,2,2,2,2.
-	 *
-	 * Mapping 0 as node 1, 1 as node 2, and 2 as node 3.
-	 * The biasent variable contains the count of the size of the biasarray which
-	 * provides the input for random selection.  This is subsequently applied as an
-	 * index to the biasarray.  The selection pulls up the node and then is checked
-	 * for whether it is a leaf or tree node using the norcall variable.
-	 * If it is a leaf then the bias tree traversal ends with an SMC call.
-	 * If it is a tree node then the process begins again with
-	 * another loop to continue the process of selection until an eventual leaf
-	 * node is found.
+	 * Select the functions to call based on the biases of the bias tree,
+	 * see selectsmcleaf().
 	 */
+	start = read_cntpct_el0();
 	for (unsigned int i = 0U; i < SMC_FUZZ_CALLS_PER_INSTANCE; i++) {
-		tlnode = &ndarray[cntndarray - 1];
-		int nd = 0;
-		while (nd == 0) {
-			int nch = rand()%tlnode->biasent;
-			int selent = tlnode->biasarray[nch];
-			if (tlnode->norcall[selent] == 0) {
-				runtestfunction(tlnode->snames[selent]);
-				nd = 1;
-			} else {
-				tlnode = &tlnode->treenodes[selent];
-			}
+		leaf = selectsmcleaf(&tree, &ctx->randstate, args);
+		funcid = tree.nodes[leaf].funcid;
+#if SMC_FUZZ_FEEDBACK
+		ret = runtestfunction(&ctx->trace, funcid, args);
+		after = smc_fuzz_probe_state();
+		if (smc_coverage_add(&ctx->cov, funcid, ret, before,
+				     after) != 0) {
+			boostsmcnode(&tree, leaf);
+			boostsmcnode(&tree, prevleaf);
+			ctx->boosts++;
 		}
+		before = after;
+		prevleaf = leaf;
+#else
+		runtestfunction(&ctx->trace, funcid, args);
+#endif
 	}
+	ctx->elapsed = read_cntpct_el0() - start;
 
 	/*
 	 * End of test SMC selection and freeing of nodes
 	 */
-	if (cntndarray > 0) {
-		for (unsigned int j = 0U; j < cntndarray; j++) {
-			for (unsigned int i = 0U; i < ndarray[j].entries; i++) {
-				GENFREE(ndarray[j].snames[i]);
-				GENFREE(ndarray[j].nname[i]);
-			}
-			GENFREE(ndarray[j].biases);
-			GENFREE(ndarray[j].norcall);
-			GENFREE(ndarray[j].biasarray);
-			GENFREE(ndarray[j].snames);
-			GENFREE(ndarray[j].nname);
-			GENFREE(ndarray[j].treenodes);
+	freesmctree(&tree, mmod);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+#if SMC_FUZZ_MULTICORE
+/*
+ * Entry point of the CPUs running an instance concurrently with the lead CPU
+ */
+static test_result_t smc_fuzzing_cpu(void)
+{
+	u_register_t mpid = read_mpidr_el1() & MPID_MASK;
+
+	for (unsigned int i = 0U; i < fuzz_ctx_count; i++) {
+		if (fuzz_ctx[i].mpid == mpid) {
+			fuzz_ctx[i].result = smc_fuzzing_instance(&fuzz_ctx[i]);
+			tftf_send_event(&fuzz_ctx[i].done);
+			break;
 		}
-		GENFREE(ndarray);
 	}
 
 	return TEST_RESULT_SUCCESS;
 }
+#endif
+
+/*
+ * Run instances from `first` concurrently, one per CPU, on up to
+ * SMC_FUZZ_CPU_COUNT CPUs. The lead CPU runs the first one.
+ *
+ * Return the number of instances run.
+ */
+static unsigned int smc_fuzzing_run(const uint32_t *seeds, unsigned int first)
+{
+	u_register_t lead_mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int count = 0U;
+
+	fuzz_ctx[count++].mpid = lead_mpid;
+#if SMC_FUZZ_MULTICORE
+	unsigned int cpu_node;
+	u_register_t cpu_mpid;
+
+	for_each_cpu(cpu_node) {
+		cpu_mpid = tftf_get_mpidr_from_node(cpu_node);
+		if (cpu_mpid == lead_mpid) {
+			continue;
+		}
+		if (((first + count) == SMC_FUZZ_INSTANCE_COUNT) ||
+		    (count == SMC_FUZZ_CPU_COUNT)) {
+			break;
+		}
+		fuzz_ctx[count++].mpid = cpu_mpid;
+	}
+#endif
+	fuzz_ctx_count = count;
+
+	for (unsigned int i = 0U; i < count; i++) {
+		fuzz_ctx[i].instance = first + i;
+		fuzz_ctx[i].seed = seeds[first + i];
+		fuzz_ctx[i].mmod = &tmod[i];
+		fuzz_ctx[i].result = TEST_RESULT_CRASHED;
+		fuzz_ctx[i].elapsed = 0U;
+		tftf_init_event(&fuzz_ctx[i].done);
+		printf("Starting SMC fuzz test with seed 0x%x on CPU%u\n",
+		       fuzz_ctx[i].seed,
+		       platform_get_core_pos(fuzz_ctx[i].mpid));
+	}
+
+#if SMC_FUZZ_MULTICORE
+	for (unsigned int i = 1U; i < count; i++) {
+		if (tftf_cpu_on(fuzz_ctx[i].mpid, (uintptr_t)smc_fuzzing_cpu,
+				0) != PSCI_E_SUCCESS) {
+			fuzz_ctx[i].result = TEST_RESULT_FAIL;
+			tftf_send_event(&fuzz_ctx[i].done);
+		}
+	}
+#endif
+
+	fuzz_ctx[0].result = smc_fuzzing_instance(&fuzz_ctx[0]);
+
+#if SMC_FUZZ_MULTICORE
+	/* Wait for the other instances, then for their CPUs to power off */
+	for (unsigned int i = 1U; i < count; i++) {
+		tftf_wait_for_event(&fuzz_ctx[i].done);
+		while (tftf_psci_affinity_info(fuzz_ctx[i].mpid,
+					       MPIDR_AFFLVL0) != PSCI_STATE_OFF) {
+		}
+	}
+#endif
+
+	return count;
+}
 
 /*
  * Top of SMC fuzzing module
@@ -575,37 +533,69 @@ test_result_t smc_fuzzing_instance(uint32_t seed)
 test_result_t smc_fuzzing_top(void)
 {
 	/* These SMC_FUZZ_x macros are supplied by the build system. */
-	test_result_t results[SMC_FUZZ_INSTANCE_COUNT];
 	uint32_t seeds[SMC_FUZZ_INSTANCE_COUNT] = {SMC_FUZZ_SEEDS};
 	test_result_t result = TEST_RESULT_SUCCESS;
-	unsigned int i;
+	uint64_t total_calls = 0U;
+	uint64_t total_ticks = 0U;
+	uint64_t start;
+	unsigned int i, count;
 
-	/* Run each instance. */
-	for (i = 0U; i < SMC_FUZZ_INSTANCE_COUNT; i++) {
-		printf("Starting SMC fuzz test with seed 0x%x\n", seeds[i]);
-		results[i] = smc_fuzzing_instance(seeds[i]);
-	}
-
-	/* Report successes and failures. */
+	/*
+	 * Run the instances, up to one per CPU at a time in multi-core mode,
+	 * and report each one as soon as it has run since the next ones reuse
+	 * its context.
+	 */
 	printf("SMC Fuzz Test Results Summary\n");
-	for (i = 0U; i < SMC_FUZZ_INSTANCE_COUNT; i++) {
-		/* Display instance number. */
-		printf("  Instance #%d\n", i);
-
-		/* Print test results. */
-		printf("    Result: ");
-		if (results[i] == TEST_RESULT_SUCCESS) {
-			printf("SUCCESS\n");
-		} else if (results[i] == TEST_RESULT_FAIL) {
-			printf("FAIL\n");
-			/* If we got a failure, update the result value. */
-			result = TEST_RESULT_FAIL;
-		} else if (results[i] == TEST_RESULT_SKIPPED) {
-			printf("SKIPPED\n");
+	for (i = 0U; i < SMC_FUZZ_INSTANCE_COUNT; i += count) {
+		start = read_cntpct_el0();
+		count = smc_fuzzing_run(seeds, i);
+		total_ticks += read_cntpct_el0() - start;
+
+		for (unsigned int j = 0U; j < count; j++) {
+			struct smc_fuzz_ctx *ctx = &fuzz_ctx[j];
+			uint64_t calls_per_sec = 0U;
+
+			/* Display instance number. */
+			printf("  Instance #%u\n", ctx->instance);
+
+			/* Print test results. */
+			printf("    Result: ");
+			if (ctx->result == TEST_RESULT_SUCCESS) {
+				printf("SUCCESS\n");
+			} else if (ctx->result == TEST_RESULT_SKIPPED) {
+				printf("SKIPPED\n");
+			} else {
+				printf("FAIL\n");
+				/* If we got a failure, update the result value. */
+				result = TEST_RESULT_FAIL;
+			}
+
+			/* Print seed and CPU used */
+			printf("    Seed: 0x%x\n", ctx->seed);
+			printf("    CPU: %u\n", platform_get_core_pos(ctx->mpid));
+
+			/* Print call rate */
+			if (ctx->elapsed != 0U) {
+				calls_per_sec = (ctx->trace.ncalls *
+						 read_cntfrq_el0()) / ctx->elapsed;
+			}
+			printf("    Calls/s: %llu\n",
+			       (unsigned long long)calls_per_sec);
+			total_calls += ctx->trace.ncalls;
+
+			dumptrace(&ctx->trace);
+#if !SMC_FUZZ_LEGACY_MALLOC
+			dumppoolstats(ctx->mmod);
+#endif
+#if SMC_FUZZ_FEEDBACK
+			dumpcoverage(ctx);
+#endif
 		}
+	}
 
-		/* Print seed used */
-		printf("    Seed: 0x%x\n", seeds[i]);
+	if (total_ticks != 0U) {
+		printf("  Total calls/s: %llu\n", (unsigned long long)
+		       ((total_calls * read_cntfrq_el0()) / total_ticks));
 	}
 
 	/*
@@ -616,6 +606,9 @@ test_result_t smc_fuzzing_top(void)
 		SMC_FUZZ_INSTANCE_COUNT);
 	printf("  SMC_FUZZ_CALLS_PER_INSTANCE=%u\n",
 		SMC_FUZZ_CALLS_PER_INSTANCE);
+	printf("  SMC_FUZZ_MULTICORE=%u\n", SMC_FUZZ_MULTICORE);
+	printf("  SMC_FUZZ_FEEDBACK=%u\n", SMC_FUZZ_FEEDBACK);
+	printf("  SMC_FUZZ_LEGACY_MALLOC=%u\n", SMC_FUZZ_LEGACY_MALLOC);
 	printf("  SMC_FUZZ_SEEDS=0x%x", seeds[0]);
 	for (i = 1U; i < SMC_FUZZ_INSTANCE_COUNT; i++) {
 		printf(",0x%x", seeds[i]);
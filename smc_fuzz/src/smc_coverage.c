@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <string.h>
+
+#include "smc_coverage.h"
+
+#if (SMC_COVERAGE_SIZE & (SMC_COVERAGE_SIZE - 1U)) != 0U
+#error "SMC_COVERAGE_SIZE must be a power of two"
+#endif
+
+static uint64_t mix(uint64_t h, uint64_t v)
+{
+	h ^= v;
+	h *= 0x9e3779b97f4a7c15ULL;
+	return h ^ (h >> 29);
+}
+
+static unsigned int smc_coverage_hash(int32_t funcid, int64_t ret,
+				      int64_t before, int64_t after)
+{
+	uint64_t h = 0U;
+
+	h = mix(h, (uint64_t)(uint32_t)funcid);
+	h = mix(h, (uint64_t)ret);
+	h = mix(h, (uint64_t)before);
+	h = mix(h, (uint64_t)after);
+
+	return (unsigned int)(h >> 32) & (SMC_COVERAGE_SIZE - 1U);
+}
+
+void smc_coverage_init(struct smc_coverage *cov)
+{
+	memset(cov, 0, sizeof(*cov));
+}
+
+int smc_coverage_add(struct smc_coverage *cov, int32_t funcid, int64_t ret,
+		     int64_t before, int64_t after)
+{
+	unsigned int i = smc_coverage_hash(funcid, ret, before, after);
+	struct smc_coverage_entry *ent;
+
+	/* Linear probing, an entry with no hits is free */
+	for (;;) {
+		ent = &cov->entries[i];
+		if (ent->hits == 0U) {
+			break;
+		}
+		if ((ent->funcid == funcid) && (ent->ret == ret) &&
+		    (ent->before == before) && (ent->after == after)) {
+			ent->hits++;
+			return 0;
+		}
+		i = (i + 1U) & (SMC_COVERAGE_SIZE - 1U);
+	}
+
+	if (cov->count >= ((SMC_COVERAGE_SIZE / 4U) * 3U)) {
+		cov->dropped++;
+		return 0;
+	}
+
+	ent->funcid = funcid;
+	ent->ret = ret;
+	ent->before = before;
+	ent->after = after;
+	ent->hits = 1U;
+	cov->count++;
+
+	return 1;
+}
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libfdt.h>
+
+#include "alias_table.h"
+#include "smc_tree.h"
+
+/*
+ * switch to use either standard C malloc or custom SMC malloc
+ */
+
+#ifdef SMC_FUZZ_TMALLOC
+#define GENMALLOC(x)	malloc((x))
+#define GENFREE(x)	free((x))
+#else
+#define GENMALLOC(x)	smcmalloc((x), mmod)
+#define GENFREE(x)	smcfree((x), mmod)
+#endif
+
+/*
+ * Count the nodes of the device tree, the largest number of children of a
+ * node, and the argument generators of leaf nodes and their values, to size
+ * the arena.
+ */
+static int countsmcnodes(const void *fdt, int offset, unsigned int *maxchildren,
+			 unsigned int *nargs, unsigned int *nvalues)
+{
+	const char *type;
+	int child;
+	int count = 1;
+	int len;
+	unsigned int nchildren = 0U;
+
+	/* The subnodes of leaf nodes are argument generators */
+	if (fdt_getprop(fdt, offset, "functionname", NULL) != NULL) {
+		fdt_for_each_subnode(child, fdt, offset) {
+			(*nargs)++;
+			type = fdt_getprop(fdt, child, "type", NULL);
+			if ((type != NULL) && (strcmp(type, "mpidr") == 0)) {
+				*nvalues += smc_fuzz_get_mpidrs(NULL);
+			} else if (fdt_getprop(fdt, child, "values",
+					       &len) != NULL) {
+				*nvalues += len / sizeof(fdt64_t);
+			}
+		}
+		return count;
+	}
+
+	fdt_for_each_subnode(child, fdt, offset) {
+		count += countsmcnodes(fdt, child, maxchildren, nargs, nvalues);
+		nchildren++;
+	}
+
+	if (nchildren > *maxchildren) {
+		*maxchildren = nchildren;
+	}
+
+	return count;
+}
+
+/*
+ * Resolve a function name into a function ID of the backend
+ */
+static int resolvefuncid(const char *funcname)
+{
+	int funcid = smc_fuzz_func_id(funcname);
+
+	if (funcid == SMC_FUZZ_FUNC_NONE) {
+		printf("WARNING: unknown SMC fuzzing function %s\n", funcname);
+	}
+	return funcid;
+}
+
+/*
+ * Load the argument generators declared by the "argN" subnodes of the leaf
+ * node `leaf`, found at `offset` in the device tree.
+ *
+ * Return 0 on success, -1 if the description is invalid.
+ */
+static int buildsmcargs(const void *fdt, int offset, struct rand_smc_tree *tree,
+			struct rand_smc_node *leaf)
+{
+	struct arg_gen *gen;
+	const char *name;
+	const char *type;
+	const fdt64_t *values;
+	uint64_t *v;
+	int suboffset;
+	int len;
+
+	leaf->args = &tree->args[tree->nargs];
+	leaf->nargs = 0U;
+	fdt_for_each_subnode(suboffset, fdt, offset) {
+		gen = &leaf->args[leaf->nargs];
+		name = fdt_get_name(fdt, suboffset, NULL);
+		if ((strncmp(name, "arg", 3) != 0) || (name[3] < '0') ||
+		    (name[3] >= ('0' + ARG_GEN_MAX_ARGS)) || (name[4] != '\0')) {
+			printf("ERROR: invalid argument node %s in leaf node %s\n",
+			       name, leaf->name);
+			return -1;
+		}
+		gen->reg = name[3] - '0';
+
+		type = fdt_getprop(fdt, suboffset, "type", NULL);
+		if ((type == NULL) ||
+		    (arg_gen_type_from_name(type, &gen->type) != 0)) {
+			printf("ERROR: missing or unknown type for %s of %s\n",
+			       name, leaf->name);
+			return -1;
+		}
+
+		v = &tree->values[tree->nvalues];
+		gen->values = v;
+		gen->nvalues = 0U;
+		if (gen->type == ARG_GEN_MPIDR) {
+			gen->nvalues = smc_fuzz_get_mpidrs(v);
+		} else {
+			values = fdt_getprop(fdt, suboffset, "values", &len);
+			if ((values != NULL) &&
+			    ((len % sizeof(*values)) == 0U)) {
+				gen->nvalues = len / sizeof(*values);
+			}
+			for (unsigned int i = 0U; i < gen->nvalues; i++) {
+				v[i] = fdt64_ld(&values[i]);
+			}
+		}
+
+		if (arg_gen_check(gen) != 0) {
+			printf("ERROR: wrong number of 64-bit values for %s of %s\n",
+			       name, leaf->name);
+			return -1;
+		}
+		tree->nvalues += gen->nvalues;
+		leaf->nargs++;
+	}
+	tree->nargs += leaf->nargs;
+
+	return 0;
+}
+
+/*
+ * Fill in the children of the tree node `nodeidx`, found at `offset` in the
+ * device tree, then recurse into them. `*nextidx` is the index of the next
+ * free node in the tree.
+ *
+ * Return 0 on success, -1 if the description is invalid.
+ */
+static int buildsmcnode(const void *fdt, int offset, struct rand_smc_tree *tree,
+			unsigned int nodeidx, unsigned int *nextidx)
+{
+	struct rand_smc_node *node = &tree->nodes[nodeidx];
+	struct rand_smc_node *child;
+	const fdt32_t *bias;
+	int suboffset;
+	int len;
+	int ret = 0;
+
+	/* Reserve contiguous entries for the children */
+	node->firstchild = *nextidx;
+	node->nchildren = 0U;
+	fdt_for_each_subnode(suboffset, fdt, offset) {
+		child = &tree->nodes[node->firstchild + node->nchildren];
+		child->name = fdt_get_name(fdt, suboffset, NULL);
+		child->parent = nodeidx;
+		child->args = NULL;
+		child->nargs = 0U;
+
+		bias = fdt_getprop(fdt, suboffset, "bias", &len);
+		if ((bias == NULL) || (len != sizeof(*bias))) {
+			printf("ERROR: Did not find bias or multiple bias ");
+			printf("designations for %s\n", child->name);
+			return -1;
+		}
+		child->bias = fdt32_to_cpu(*bias);
+
+		child->funcname = fdt_getprop(fdt, suboffset, "functionname",
+					      NULL);
+		child->funcid = (child->funcname != NULL) ?
+			resolvefuncid(child->funcname) : SMC_FUZZ_FUNC_NONE;
+		tree->biases[node->nchildren] = child->bias;
+		node->nchildren++;
+	}
+	*nextidx += node->nchildren;
+
+	if (node->nchildren == 0U) {
+		printf("ERROR: early node termination... ");
+		printf("no bias or functionname field for leaf node, near %s\n",
+		       node->name);
+		return -1;
+	}
+
+	/* Compile the biases of the children into an alias table */
+	node->aliasprob = &tree->aliasprob[tree->nalias];
+	node->alias = &tree->alias[tree->nalias];
+	tree->nalias += node->nchildren;
+	if (alias_table_build(tree->biases, node->nchildren, node->aliasprob,
+			      node->alias, tree->aliaswork,
+			      &node->biastotal) != 0) {
+		printf("ERROR: invalid biases in tree node %s\n", node->name);
+		return -1;
+	}
+
+	/* Recurse into the children which are tree nodes */
+	suboffset = fdt_first_subnode(fdt, offset);
+	for (unsigned int i = 0U; i < node->nchildren; i++) {
+		child = &tree->nodes[node->firstchild + i];
+		if (child->funcname == NULL) {
+			ret = buildsmcnode(fdt, suboffset, tree,
+					   node->firstchild + i, nextidx);
+			if (ret != 0) {
+				return ret;
+			}
+		} else if (buildsmcargs(fdt, suboffset, tree, child) != 0) {
+			return -1;
+		}
+		suboffset = fdt_next_subnode(fdt, suboffset);
+	}
+
+	return 0;
+}
+
+int createsmctree(struct rand_smc_tree *tree, const void *fdt,
+		  struct memmod *mmod)
+{
+	unsigned int maxchildren = 0U;
+	unsigned int nargs = 0U;
+	unsigned int nvalues = 0U;
+	unsigned int nextidx = 1U;
+	int root;
+	char *arena;
+
+	if (fdt_check_header(fdt) != 0) {
+		printf("ERROR, not device tree compliant\n");
+		return -1;
+	}
+
+	root = fdt_path_offset(fdt, "/");
+	if (root < 0) {
+		printf("ERROR, no root node in device tree\n");
+		return -1;
+	}
+
+	/*
+	 * Every node but the root takes an alias table entry in its parent.
+	 * Allocate all the nodes, argument generators, alias tables and scratch
+	 * space at once, with the 64-bit aligned arrays first.
+	 */
+	tree->nnodes = countsmcnodes(fdt, root, &maxchildren, &nargs, &nvalues);
+	tree->arena = GENMALLOC(tree->nnodes * sizeof(struct rand_smc_node) +
+				nargs * sizeof(struct arg_gen) +
+				nvalues * sizeof(uint64_t) +
+				tree->nnodes * (sizeof(unsigned int) + sizeof(int)) +
+				maxchildren * 2U * sizeof(int));
+	if (tree->arena == NULL) {
+		printf("ERROR, cannot allocate bias tree of %u nodes\n",
+		       tree->nnodes);
+		return -1;
+	}
+
+	arena = tree->arena;
+	tree->nodes = (struct rand_smc_node *)arena;
+	arena += tree->nnodes * sizeof(struct rand_smc_node);
+	tree->args = (struct arg_gen *)arena;
+	arena += nargs * sizeof(struct arg_gen);
+	tree->values = (uint64_t *)arena;
+	arena += nvalues * sizeof(uint64_t);
+	tree->aliasprob = (unsigned int *)arena;
+	arena += tree->nnodes * sizeof(unsigned int);
+	tree->alias = (int *)arena;
+	arena += tree->nnodes * sizeof(int);
+	tree->aliaswork = (int *)arena;
+	arena += maxchildren * sizeof(int);
+	tree->biases = (int *)arena;
+	tree->nalias = 0U;
+	tree->nargs = 0U;
+	tree->nvalues = 0U;
+
+	tree->nodes[0].name = "/";
+	tree->nodes[0].funcname = NULL;
+	tree->nodes[0].funcid = SMC_FUZZ_FUNC_NONE;
+	tree->nodes[0].bias = 0;
+	tree->nodes[0].parent = 0U;
+	tree->nodes[0].args = NULL;
+	tree->nodes[0].nargs = 0U;
+
+	if (buildsmcnode(fdt, root, tree, 0U, &nextidx) != 0) {
+		GENFREE(tree->arena);
+		return -1;
+	}
+	assert(nextidx == tree->nnodes);
+	assert(tree->nargs == nargs);
+	assert(tree->nvalues <= nvalues);
+
+	return 0;
+}
+
+void freesmctree(struct rand_smc_tree *tree, struct memmod *mmod)
+{
+	GENFREE(tree->arena);
+	tree->arena = NULL;
+}
+
+/*
+ * The algorithm starts with the root node to pull up its alias table. The
+ * biases of the children of a node are compiled into one threshold and one
+ * alias per child, so that a child is selected in constant time with a
+ * probability proportional to its bias. So for instance if there are three
+ * children with a bias of 2,5,7, they are selected 2, 5 and 7 times out of 14
+ * on average (see alias_table.h).
+ *
+ * If the selected node is a leaf then the bias tree traversal ends. If it is a
+ * tree node then the process begins again with its children until an eventual
+ * leaf node is found.
+ */
+unsigned int selectsmcleaf(const struct rand_smc_tree *tree,
+			   unsigned int *randstate, uint64_t *args)
+{
+	const struct rand_smc_node *tlnode = &tree->nodes[0];
+
+	while (tlnode->funcname == NULL) {
+		int selent = alias_table_sample(tlnode->aliasprob,
+						tlnode->alias,
+						tlnode->nchildren,
+						tlnode->biastotal,
+						rand_r(randstate),
+						rand_r(randstate));
+		tlnode = &tree->nodes[tlnode->firstchild + selent];
+	}
+
+	memset(args, 0, ARG_GEN_MAX_ARGS * sizeof(*args));
+	for (unsigned int a = 0U; a < tlnode->nargs; a++) {
+		args[tlnode->args[a].reg] = arg_gen_generate(&tlnode->args[a],
+							     randstate);
+	}
+
+	return tlnode - tree->nodes;
+}
+
+void boostsmcnode(struct rand_smc_tree *tree, unsigned int idx)
+{
+	while (idx != 0U) {
+		struct rand_smc_node *node = &tree->nodes[idx];
+		struct rand_smc_node *parent = &tree->nodes[node->parent];
+		struct rand_smc_node *child;
+		int bias = node->bias;
+
+		node->bias = (bias < (SMC_FUZZ_MAX_BIAS / 2)) ?
+			(bias * 2) : SMC_FUZZ_MAX_BIAS;
+		if (node->bias != bias) {
+			child = &tree->nodes[parent->firstchild];
+			for (unsigned int i = 0U; i < parent->nchildren; i++) {
+				tree->biases[i] = child[i].bias;
+			}
+			if (alias_table_build(tree->biases, parent->nchildren,
+					      parent->aliasprob, parent->alias,
+					      tree->aliaswork,
+					      &parent->biastotal) != 0) {
+				/* Too large, keep the previous biases */
+				node->bias = bias;
+				tree->biases[idx - parent->firstchild] = bias;
+				(void)alias_table_build(tree->biases,
+						parent->nchildren,
+						parent->aliasprob,
+						parent->alias, tree->aliaswork,
+						&parent->biastotal);
+			}
+		}
+		idx = node->parent;
+	}
+}
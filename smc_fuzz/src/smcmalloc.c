@@ -1,22 +1,36 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
-#include <debug.h>
-#include <drivers/arm/private_timer.h>
-#include <events.h>
-#include "fifo3d.h"
-#include <libfdt.h>
+#include <stdbool.h>
 
-#include <power_management.h>
-#include <sdei.h>
-#include <tftf_lib.h>
-#include <timer.h>
+#include "smcmalloc.h"
 
-#include <plat_topology.h>
-#include <platform.h>
+/*
+ * Initialize the memory pool of `mmod` with a single free block spanning the
+ * whole allocatable memory
+ */
+void initmem(struct memmod *mmod)
+{
+	mmod->memptr = (void *)mmod->memory;
+	mmod->memptrend = (void *)mmod->memory;
+	mmod->maxmemblk = ((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk));
+	mmod->nmemblk = 1;
+	mmod->memptr->address = 0U;
+	mmod->memptr->size = TOTALMEMORYSIZE - (TOTALMEMORYSIZE / BLKSPACEDIV);
+	mmod->memptr->valid = 1;
+	mmod->mallocdeladd[0] = 0U;
+	mmod->precblock[0] = (void *)mmod->memory;
+	mmod->trailblock[0] = NULL;
+	mmod->cntdeladd = 0U;
+	mmod->ptrmemblkqueue = 0U;
+	mmod->mallocdeladd_queue_cnt = 0U;
+	mmod->checkadd = 1U;
+	mmod->checknumentries = 0U;
+	mmod->memerror = 0U;
+}
 
 /*
  * Priority encoder for enabling proper alignment of returned malloc
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <stdint.h>
+
+#include "smcmalloc.h"
+
+#if (SLABPAGES != 64)
+#error "The free page bitmap must have one bit per page"
+#endif
+
+/* State of a page which is not in a slab, in pageclass[] */
+#define SLABPAGEFREE	(0xffU)		// Free page
+#define SLABPAGELARGE	(0xfeU)		// First page of a large allocation
+#define SLABPAGECONT	(0xfdU)		// Other pages of a large allocation
+
+#define SLABMAXSMALL	(1U << (SLABMINSHIFT + SLABCLASSES - 1))
+
+/*
+ * Objects on the free list of a size class
+ */
+struct slabobj {
+	struct slabobj *next;
+};
+
+static unsigned int sizeclass(unsigned int size)
+{
+	unsigned int class = 0U;
+
+	while ((1U << (SLABMINSHIFT + class)) < size) {
+		class++;
+	}
+
+	return class;
+}
+
+static unsigned int pageindex(struct memmod *mmod, void *ptr)
+{
+	return ((char *)ptr - mmod->memory) / SLABPAGESIZE;
+}
+
+/*
+ * Take a run of `npages` free pages. Return the index of the first one, or -1
+ * if there is no such run.
+ */
+static int takepages(struct memmod *mmod, unsigned int npages)
+{
+	uint64_t mask;
+
+	if ((npages == 0U) || (npages > SLABPAGES)) {
+		return -1;
+	}
+
+	mask = (npages == SLABPAGES) ? UINT64_MAX : ((1ULL << npages) - 1U);
+	for (unsigned int i = 0U; i <= (SLABPAGES - npages); i++) {
+		if ((mmod->freepages & (mask << i)) == (mask << i)) {
+			mmod->freepages &= ~(mask << i);
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void accountalloc(struct memmod *mmod, unsigned int requested,
+			 unsigned int allocated)
+{
+	mmod->stats.nalloc++;
+	mmod->stats.requested += requested;
+	mmod->stats.allocated += allocated;
+	mmod->stats.inuse += allocated;
+	if (mmod->stats.inuse > mmod->stats.peakinuse) {
+		mmod->stats.peakinuse = mmod->stats.inuse;
+	}
+}
+
+void initmem(struct memmod *mmod)
+{
+	mmod->freepages = UINT64_MAX;
+	memset(mmod->freelist, 0, sizeof(mmod->freelist));
+	memset(mmod->pageclass, SLABPAGEFREE, sizeof(mmod->pageclass));
+	memset(mmod->pagerun, 0, sizeof(mmod->pagerun));
+	memset(&mmod->stats, 0, sizeof(mmod->stats));
+	mmod->memerror = 0U;
+}
+
+/*
+ * Small requests are served from the free list of their size class, so
+ * objects are aligned to their size. Large requests are page aligned.
+ */
+void *smcmalloc(unsigned int rsize, struct memmod *mmod)
+{
+	struct slabobj *obj;
+	unsigned int class;
+	unsigned int npages;
+	unsigned int objsize;
+	char *page;
+	int first;
+
+	if (rsize > SLABMAXSMALL) {
+		npages = (rsize + SLABPAGESIZE - 1U) / SLABPAGESIZE;
+		first = takepages(mmod, npages);
+		if (first < 0) {
+			printf("ERROR: SMC GENMALLOC did not find memory region, size is %u\n",
+			       rsize);
+			mmod->memerror = 4U;
+			return NULL;
+		}
+		mmod->pageclass[first] = SLABPAGELARGE;
+		mmod->pagerun[first] = npages;
+		for (unsigned int i = 1U; i < npages; i++) {
+			mmod->pageclass[first + i] = SLABPAGECONT;
+		}
+		accountalloc(mmod, rsize, npages * SLABPAGESIZE);
+		return &mmod->memory[first * SLABPAGESIZE];
+	}
+
+	class = sizeclass(rsize);
+	objsize = 1U << (SLABMINSHIFT + class);
+
+	/* Refill the free list of the class with a new page */
+	if (mmod->freelist[class] == NULL) {
+		first = takepages(mmod, 1U);
+		if (first < 0) {
+			printf("ERROR: SMC GENMALLOC did not find memory region, size is %u\n",
+			       rsize);
+			mmod->memerror = 4U;
+			return NULL;
+		}
+		mmod->pageclass[first] = class;
+		mmod->stats.slabpages++;
+
+		page = &mmod->memory[first * SLABPAGESIZE];
+		for (unsigned int off = SLABPAGESIZE; off != 0U; off -= objsize) {
+			obj = (struct slabobj *)(page + off - objsize);
+			obj->next = mmod->freelist[class];
+			mmod->freelist[class] = obj;
+		}
+	}
+
+	obj = mmod->freelist[class];
+	mmod->freelist[class] = obj->next;
+	accountalloc(mmod, rsize, objsize);
+
+	return obj;
+}
+
+/*
+ * Return 0 on success, or -1 if `faddptr` cannot have been returned by
+ * smcmalloc(). Freeing a large allocation twice is detected as well.
+ */
+int smcfree(void *faddptr, struct memmod *mmod)
+{
+	struct slabobj *obj = faddptr;
+	unsigned int offset;
+	unsigned int page;
+	unsigned int class;
+	uint64_t mask;
+
+	if (((char *)faddptr < mmod->memory) ||
+	    ((char *)faddptr >= &mmod->memory[TOTALMEMORYSIZE])) {
+		printf("ERROR: GENFREE of address outside of the pool\n");
+		mmod->memerror = 7U;
+		return -1;
+	}
+
+	offset = (char *)faddptr - mmod->memory;
+	page = pageindex(mmod, faddptr);
+	class = mmod->pageclass[page];
+
+	if (class == SLABPAGELARGE) {
+		if ((offset % SLABPAGESIZE) != 0U) {
+			printf("ERROR: GENFREE of address %u not returned by GENMALLOC\n",
+			       offset);
+			mmod->memerror = 7U;
+			return -1;
+		}
+		mask = (mmod->pagerun[page] == SLABPAGES) ? UINT64_MAX :
+			((1ULL << mmod->pagerun[page]) - 1U);
+		mmod->freepages |= mask << page;
+		for (unsigned int i = 0U; i < mmod->pagerun[page]; i++) {
+			mmod->pageclass[page + i] = SLABPAGEFREE;
+		}
+		mmod->stats.inuse -= mmod->pagerun[page] * SLABPAGESIZE;
+		mmod->pagerun[page] = 0U;
+		mmod->stats.nfree++;
+		return 0;
+	}
+
+	if ((class >= SLABCLASSES) ||
+	    ((offset % (1U << (SLABMINSHIFT + class))) != 0U)) {
+		printf("ERROR: GENFREE of address %u not returned by GENMALLOC\n",
+		       offset);
+		mmod->memerror = 7U;
+		return -1;
+	}
+
+	/* Freed objects go back to their class, pages are not given back */
+	obj->next = mmod->freelist[class];
+	mmod->freelist[class] = obj;
+	mmod->stats.inuse -= 1U << (SLABMINSHIFT + class);
+	mmod->stats.nfree++;
+
+	return 0;
+}
+
+void smcmemstats(struct memmod *mmod, struct smcmemstats *stats)
+{
+	unsigned int run = 0U;
+
+	*stats = mmod->stats;
+	stats->freepages = 0U;
+	stats->largestrun = 0U;
+	for (unsigned int i = 0U; i < SLABPAGES; i++) {
+		if ((mmod->freepages & (1ULL << i)) != 0U) {
+			stats->freepages++;
+			run++;
+			if (run > stats->largestrun) {
+				stats->largestrun = run;
+			}
+		} else {
+			run = 0U;
+		}
+	}
+}
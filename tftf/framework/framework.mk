@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2018-2022, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -42,6 +42,7 @@ FRAMEWORK_SOURCES	+=	$(addprefix tftf/,			\
 	framework/main.c						\
 	framework/nvm_results_helpers.c					\
 	framework/report.c						\
+	framework/test_filter.c						\
 	framework/timer/timer_framework.c				\
 	tests/common/test_helpers.c					\
 )
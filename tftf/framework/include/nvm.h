@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,12 +8,51 @@
 #define __NVM_H__
 
 #ifndef __ASSEMBLY__
+#include <platform_def.h>
 #include <stddef.h>
 #include <tftf.h>
 #include "tests_list.h"
 
 #define TEST_BUFFER_SIZE 0x80
 
+/*
+ * The last TEST_FILTER_NVM_SIZE bytes of the NVM are reserved for the test
+ * filter DTB (see tftf/framework/test_filter.c). The output of the tests is
+ * stored between the end of tftf_state_t and that record.
+ */
+#define TEST_FILTER_NVM_SIZE		0x1000
+#define TEST_FILTER_NVM_OFFSET		(TFTF_NVM_SIZE - TEST_FILTER_NVM_SIZE)
+
+/*
+ * State of the test session. These fields are updated together and are kept
+ * contiguous so that they can be written back to NVM in a single operation.
+ */
+typedef struct {
+	/*
+	 * The following 2 fields track the progress in the test session. They
+	 * indicate which test case we are dealing with and the progress of this
+	 * test, i.e. whether it hasn't started yet, or it is being executed
+	 * right now, ...
+	 */
+	test_ref_t		test_to_run;
+	test_progress_t		test_progress;
+
+#if PARALLEL_SINGLE_CORE_TESTS
+	/*
+	 * First and last tests of the batch of single-core tests in progress.
+	 * They are equal if no batch is in progress, as a batch has at least 2
+	 * tests.
+	 */
+	test_ref_t		batch_first;
+	test_ref_t		batch_last;
+#endif
+
+	/*
+	 * @brief Size of \a result_buffer.
+	 */
+	unsigned		result_buffer_size;
+} tftf_session_t;
+
 typedef struct {
 	/*
 	 * @brief Last executed TFTF build message which consists of date and
@@ -25,14 +64,7 @@ typedef struct {
 	 */
 	char build_message[BUILD_MESSAGE_SIZE];
 
-	/*
-	 * The following 2 fields track the progress in the test session. They
-	 * indicate which test case we are dealing with and the progress of this
-	 * test, i.e. whether it hasn't started yet, or it is being executed
-	 * right now, ...
-	 */
-	test_ref_t		test_to_run;
-	test_progress_t		test_progress;
+	tftf_session_t		session;
 
 	/*
 	 * @brief Scratch buffer for test internal use.
@@ -50,11 +82,6 @@ typedef struct {
 	 */
 	TESTCASE_RESULT testcase_results[TESTCASE_RESULT_COUNT];
 
-	/*
-	 * @brief Size of \a result_buffer.
-	 */
-	unsigned result_buffer_size;
-
 	/*
 	 * Buffer containing the output of all tests.
 	 * Each test appends its output to the end of \a result_buffer.
@@ -68,6 +95,10 @@ typedef struct {
  */
 #define TFTF_STATE_OFFSET(_field)		offsetof(tftf_state_t, _field)
 
+/* Space available in NVM for the output of all tests */
+#define RESULT_BUFFER_MAX_SIZE		\
+	(TEST_FILTER_NVM_OFFSET - TFTF_STATE_OFFSET(result_buffer))
+
 /*
  * Return 1 if we need to start a new test session;
  *        0 if we need to resume an interrupted session.
@@ -101,6 +132,24 @@ STATUS tftf_init_nvm(void);
  */
 STATUS tftf_clean_nvm(void);
 
+/*
+ * @brief Write back the cached test session state to NVM.
+ *
+ * The test session state and the result of the last test are kept in DRAM
+ * and only written to NVM at the following checkpoints:
+ *  - when a test starts (TEST_IN_PROGRESS), so that a crash can be detected
+ *    and attributed to the right test after a reset;
+ *  - when a test has completed, once its result has been saved;
+ *  - when a test announces it is going to reboot (TEST_REBOOTING);
+ *  - at the end of the test session.
+ *
+ * The result of the last test is written first and the session state last,
+ * so that an interruption in the middle of this operation can be detected.
+ *
+ * @return STATUS_SUCCESS on success, another status code on failure.
+ */
+STATUS tftf_flush_nvm(void);
+
 /* Writes the buffer to the flash at offset with length equal to
  * size
  * Returns: STATUS_FAIL, STATUS_SUCCESS, STATUS_OUT_OF_RESOURCES
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -14,8 +14,22 @@
 
 #define TFTF_WELCOME_STR	"Booting trusted firmware test framework"
 
-/* Maximum size of test output (in bytes) */
-#define TESTCASE_OUTPUT_MAX_SIZE	512
+/*
+ * Maximum size of test output (in bytes), set by the TESTCASE_OUTPUT_MAX_SIZE
+ * build option. The output of all CPUs is truncated to this size when it is
+ * saved.
+ */
+#ifndef TESTCASE_OUTPUT_MAX_SIZE
+#define TESTCASE_OUTPUT_MAX_SIZE	2048
+#endif
+
+/*
+ * Size of the buffer of each CPU for the test output (in bytes), set by the
+ * TESTCASE_CPU_OUTPUT_SIZE build option.
+ */
+#ifndef TESTCASE_CPU_OUTPUT_SIZE
+#define TESTCASE_CPU_OUTPUT_SIZE	TESTCASE_OUTPUT_MAX_SIZE
+#endif
 
 /* Size of build message used to differentiate different TFTF binaries */
 #define BUILD_MESSAGE_SIZE 		0x20
@@ -36,6 +50,8 @@ typedef struct {
 	unsigned		output_offset;
 	/* Size of test output string, excluding final \0. */
 	unsigned		output_size;
+	/* Non-zero if some of the test output didn't fit and has been lost. */
+	unsigned		output_truncated;
 } TESTCASE_RESULT;
 
 typedef struct {
@@ -43,6 +59,12 @@ typedef struct {
 	const char		*name;
 	const char		*description;
 	test_function_t		test;
+	/*
+	 * Non-zero if the test only runs on the calling CPU and doesn't
+	 * interfere with other tests, in which case it may be run in parallel
+	 * with other such tests (see PARALLEL_SINGLE_CORE_TESTS).
+	 */
+	unsigned		single_core;
 } test_case_t;
 
 typedef struct {
@@ -110,6 +132,11 @@ STATUS tftf_get_test_to_run(test_ref_t *test_to_run);
 /* Set/Get the progress of the current test in NVM */
 STATUS tftf_set_test_progress(test_progress_t test_progress);
 STATUS tftf_get_test_progress(test_progress_t *test_progress);
+#if PARALLEL_SINGLE_CORE_TESTS
+/* Set/Get the first and last tests of the batch in progress in NVM */
+STATUS tftf_set_test_batch(const test_ref_t first, const test_ref_t last);
+STATUS tftf_get_test_batch(test_ref_t *first, test_ref_t *last);
+#endif
 
 /**
 ** Save test result into NVM.
@@ -117,6 +144,17 @@ STATUS tftf_get_test_progress(test_progress_t *test_progress);
 STATUS tftf_testcase_set_result(const test_case_t *testcase,
 				test_result_t result,
 				unsigned long long duration);
+
+#if PARALLEL_SINGLE_CORE_TESTS
+/**
+** Save into NVM the result of a test which ran on the CPU \a core_pos, along
+** with the output of that CPU only.
+*/
+STATUS tftf_testcase_set_cpu_result(const test_case_t *testcase,
+				    test_result_t result,
+				    unsigned long long duration,
+				    unsigned int core_pos);
+#endif
 /**
 ** Get a testcase result from NVM.
 **
@@ -135,6 +173,16 @@ void print_test_start(const test_case_t *test);
 void print_test_end(const test_case_t *test);
 void print_tests_summary(void);
 
+/*
+ * Select the tests to run according to the runtime test filter, if any (see
+ * tftf/framework/test_filter.c).
+ */
+void tftf_init_test_filter(void);
+/* Return true if the test case has been selected to run */
+bool tftf_is_test_selected(const test_case_t *testcase);
+/* Return the number of test cases which have not been selected */
+unsigned int tftf_get_filtered_out_count(void);
+
 /*
  * Exit the TFTF.
  * This function can be used when a fatal error is encountered or as part of the
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2022, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <debug.h>
 #include <drivers/arm/arm_gic.h>
+#include <events.h>
 #include <irq.h>
 #include <mmio.h>
 #include <nvm.h>
@@ -47,6 +48,27 @@ static unsigned int test_is_rebooting;
 u_register_t fw_config_base;
 u_register_t hw_config_base;
 
+#if PARALLEL_SINGLE_CORE_TESTS
+/*
+ * Batch of consecutive single-core tests of the current test suite, run
+ * concurrently on different CPUs. The first slot always runs on the lead CPU.
+ *
+ * The first and last tests of the batch are tracked in NVM while it is in
+ * progress. If any CPU crashes, all the tests of the batch are reported as
+ * crashed since the CPU at fault can't be identified.
+ */
+typedef struct {
+	const test_case_t *test;
+	test_ref_t test_ref;
+	unsigned int mpid;
+	unsigned int core_pos;
+} batch_slot_t;
+
+static batch_slot_t batch[PLATFORM_CORE_COUNT];
+static unsigned int batch_size;
+static event_t batch_slot_started[PLATFORM_CORE_COUNT];
+#endif /* PARALLEL_SINGLE_CORE_TESTS */
+
 static inline const test_suite_t *current_testsuite(void)
 {
 	test_ref_t test_to_run;
@@ -85,29 +107,33 @@ static const test_case_t *advance_to_next_test(void)
 	testcase_idx = test_to_run.testcase_idx;
 	testsuite_idx = test_to_run.testsuite_idx;
 
-	/* Move to the next test case in the current test suite */
-	++testcase_idx;
-	testcase = &testsuites[testsuite_idx].testcases[testcase_idx];
+	/* Skip the test cases which have been filtered out */
+	do {
+		/* Move to the next test case in the current test suite */
+		++testcase_idx;
+		testcase = &testsuites[testsuite_idx].testcases[testcase_idx];
 
-	if (testcase->name == NULL) {
-		/*
-		 * There's no more test cases in the current test suite so move
-		 * to the first test case of the next test suite.
-		 */
-		const test_suite_t *testsuite;
-		testcase_idx = 0;
-		++testsuite_idx;
-		testsuite = &testsuites[testsuite_idx];
-		testcase = &testsuite->testcases[0];
-
-		if (testsuite->name == NULL) {
+		if (testcase->name == NULL) {
 			/*
-			 * This was the last test suite so there's no more tests
-			 * at all.
+			 * There's no more test cases in the current test suite
+			 * so move to the first test case of the next test
+			 * suite.
 			 */
-			return NULL;
+			const test_suite_t *testsuite;
+			testcase_idx = 0;
+			++testsuite_idx;
+			testsuite = &testsuites[testsuite_idx];
+			testcase = &testsuite->testcases[0];
+
+			if (testsuite->name == NULL) {
+				/*
+				 * This was the last test suite so there's no
+				 * more tests at all.
+				 */
+				return NULL;
+			}
 		}
-	}
+	} while (!tftf_is_test_selected(testcase));
 
 	VERBOSE("Moving to test (%u,%u)\n", testsuite_idx, testcase_idx);
 	test_to_run.testsuite_idx = testsuite_idx;
@@ -118,6 +144,137 @@ static const test_case_t *advance_to_next_test(void)
 	return testcase;
 }
 
+#if PARALLEL_SINGLE_CORE_TESTS
+/*
+ * Entrypoint of all CPUs of a batch: run the test of the batch slot assigned
+ * to the calling CPU. The test output goes to the buffer of that CPU, which is
+ * saved with the result of this test only.
+ */
+static test_result_t run_batch_slot(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	unsigned int i;
+
+	for (i = 0; i < batch_size; ++i) {
+		if (batch[i].core_pos == core_pos)
+			break;
+	}
+	assert(i < batch_size);
+
+	tftf_send_event(&batch_slot_started[i]);
+
+	return batch[i].test->test();
+}
+
+/*
+ * Test entrypoint of the lead CPU when running a batch: power on the other
+ * CPUs of the batch, then run the first test of the batch.
+ */
+static test_result_t run_test_batch(void)
+{
+	int32_t ret;
+
+	for (unsigned int i = 1; i < batch_size; ++i) {
+		ret = tftf_cpu_on(batch[i].mpid, (uintptr_t) run_batch_slot, 0);
+		if (ret != PSCI_E_SUCCESS) {
+			ERROR("Failed to power on CPU%u for test '%s' (%d)\n",
+				batch[i].core_pos, batch[i].test->name, ret);
+			test_results[batch[i].core_pos] = TEST_RESULT_FAIL;
+			continue;
+		}
+
+		/*
+		 * Make sure the CPU has entered the test before the lead CPU
+		 * may leave it, so that the last CPU to exit closes the batch.
+		 */
+		tftf_wait_for_event(&batch_slot_started[i]);
+	}
+
+	return run_batch_slot();
+}
+
+/* Assign the test `test_ref` to the CPU `mpid` and move to the next test */
+static void add_batch_slot(test_ref_t *test_ref, unsigned int mpid)
+{
+	batch_slot_t *slot = &batch[batch_size];
+
+	slot->test = &testsuites[test_ref->testsuite_idx].
+		testcases[test_ref->testcase_idx];
+	slot->test_ref = *test_ref;
+	slot->mpid = mpid;
+	slot->core_pos = platform_get_core_pos(mpid);
+	tftf_init_event(&batch_slot_started[batch_size]);
+
+	++batch_size;
+	++test_ref->testcase_idx;
+}
+
+/*
+ * Gather the single-core tests following the current test in the current test
+ * suite into a batch, up to one test per CPU.
+ *
+ * Return the number of tests in the batch.
+ */
+static unsigned int prepare_batch(void)
+{
+	test_ref_t test_ref;
+	const test_case_t *testcases;
+	unsigned int cpu_node;
+	unsigned int mpid;
+
+	batch_size = 0;
+
+	/* A rebooting test must resume alone */
+	if (tftf_is_rebooted())
+		return 0;
+
+	tftf_get_test_to_run(&test_ref);
+	testcases = testsuites[test_ref.testsuite_idx].testcases;
+
+	if (testcases[test_ref.testcase_idx].single_core == 0)
+		return 0;
+
+	/* The first test of the batch runs on the lead CPU */
+	add_batch_slot(&test_ref, lead_cpu_mpid);
+
+	for_each_cpu(cpu_node) {
+		mpid = tftf_get_mpidr_from_node(cpu_node);
+		if (mpid == lead_cpu_mpid)
+			continue;
+
+		if ((testcases[test_ref.testcase_idx].name == NULL) ||
+		    (testcases[test_ref.testcase_idx].single_core == 0) ||
+		    !tftf_is_test_selected(&testcases[test_ref.testcase_idx]))
+			break;
+
+		add_batch_slot(&test_ref, mpid);
+	}
+
+	/* There is no point in running a single test through a batch */
+	if (batch_size < 2)
+		batch_size = 0;
+
+	return batch_size;
+}
+#endif /* PARALLEL_SINGLE_CORE_TESTS */
+
+/*
+ * Return 1 if `test_ref` is the first test selected to run in its test suite,
+ * 0 otherwise.
+ */
+static unsigned int is_first_selected_test(test_ref_t test_ref)
+{
+	const test_case_t *testcases =
+		testsuites[test_ref.testsuite_idx].testcases;
+
+	for (unsigned int i = 0; i < test_ref.testcase_idx; ++i) {
+		if (tftf_is_test_selected(&testcases[i]))
+			return 0;
+	}
+
+	return 1;
+}
+
 /*
  * This function is executed only by the lead CPU.
  * It prepares the environment for the next test to run.
@@ -156,13 +313,25 @@ static void prepare_next_test(void)
 	for (unsigned int i = 0; i < PLATFORM_CORE_COUNT; ++i)
 		test_results[i] = TEST_RESULT_NA;
 
-	/* If we're starting a new testsuite, announce it. */
+	/*
+	 * If we're starting a new testsuite, announce it. Test cases before
+	 * the current one might have been filtered out.
+	 */
 	test_ref_t test_to_run;
 	tftf_get_test_to_run(&test_to_run);
-	if (test_to_run.testcase_idx == 0) {
+	if (is_first_selected_test(test_to_run)) {
 		print_testsuite_start(current_testsuite());
 	}
 
+#if PARALLEL_SINGLE_CORE_TESTS
+	if (prepare_batch() != 0) {
+		test_entrypoint[core_pos] = run_test_batch;
+		tftf_set_test_batch(batch[0].test_ref,
+				batch[batch_size - 1].test_ref);
+		for (unsigned int i = 0; i < batch_size; ++i)
+			print_test_start(batch[i].test);
+	} else
+#endif
 	print_test_start(current_testcase());
 
 	/* Program the watchdog */
@@ -272,12 +441,41 @@ static unsigned int close_test(void)
 	/* Ensure no CPU is still executing the test */
 	assert(tftf_get_ref_cnt() == 0);
 
-	/* Save test result in NVM */
-	tftf_testcase_set_result(current_testcase(),
-				get_overall_test_result(),
-				0);
+#if PARALLEL_SINGLE_CORE_TESTS
+	if (batch_size != 0) {
+		/*
+		 * Save the result of each test of the batch in NVM, in the
+		 * order of the tests list, leaving the last test of the batch
+		 * as the current one.
+		 */
+		for (unsigned int i = 0; i < batch_size; ++i) {
+			tftf_set_test_to_run(batch[i].test_ref);
+			tftf_testcase_set_cpu_result(batch[i].test,
+					test_results[batch[i].core_pos],
+					0, batch[i].core_pos);
+			print_test_end(batch[i].test);
+		}
+		tftf_set_test_batch(batch[batch_size - 1].test_ref,
+				batch[batch_size - 1].test_ref);
+		batch_size = 0;
+	} else
+#endif
+	{
+		/* Save test result in NVM */
+		tftf_testcase_set_result(current_testcase(),
+					get_overall_test_result(),
+					0);
+
+		print_test_end(current_testcase());
+	}
 
-	print_test_end(current_testcase());
+	/*
+	 * Write back the test result along with TEST_COMPLETE, so that a reset
+	 * from now on is not taken for a crash of the test. The move to the next
+	 * test is only written back when it starts: after a reset, the session
+	 * resumes from the completed test.
+	 */
+	tftf_flush_nvm();
 
 	/* The test is finished, let's move to the next one (if any) */
 	next_test = advance_to_next_test();
@@ -450,6 +648,56 @@ unsigned int tftf_is_rebooted(void)
 	return test_is_rebooting;
 }
 
+#if PARALLEL_SINGLE_CORE_TESTS
+/*
+ * Called when resuming a session interrupted while the current test was in
+ * progress, once it has been reported as crashed. If that test was the first
+ * of a batch, report the other tests of the batch as crashed too, and make the
+ * last one the current test.
+ *
+ * Return 0 on success, -1 if the session can't be resumed.
+ */
+static int crash_test_batch(void)
+{
+	test_ref_t first, last, test_ref;
+	const test_case_t *testcase;
+	TESTCASE_RESULT result;
+	/* Too big for the stack, only used by the lead CPU */
+	static char output[TESTCASE_OUTPUT_MAX_SIZE];
+
+	tftf_get_test_batch(&first, &last);
+	if ((first.testsuite_idx == last.testsuite_idx) &&
+	    (first.testcase_idx == last.testcase_idx))
+		return 0;
+
+	test_ref = first;
+	for (++test_ref.testcase_idx;
+	     test_ref.testcase_idx <= last.testcase_idx;
+	     ++test_ref.testcase_idx) {
+		testcase = &testsuites[test_ref.testsuite_idx].
+			testcases[test_ref.testcase_idx];
+
+		/* The results of the batch are written in the order of tests */
+		tftf_testcase_get_result(testcase, &result, output);
+		if (result.result != TEST_RESULT_NA) {
+			NOTICE("The test framework has been interrupted in the "
+				"middle of critical maintenance operations.\n");
+			NOTICE("Can't recover execution.\n");
+			return -1;
+		}
+
+		INFO("Test '%s' of the same batch has crashed too\n",
+			testcase->name);
+		tftf_testcase_set_result(testcase, TEST_RESULT_CRASHED, 0);
+	}
+
+	tftf_set_test_to_run(last);
+	tftf_set_test_batch(last, last);
+
+	return 0;
+}
+#endif /* PARALLEL_SINGLE_CORE_TESTS */
+
 /*
  * Return 0 if the test session can be resumed
  *        -1 otherwise.
@@ -459,12 +707,27 @@ static int resume_test_session(void)
 	test_ref_t test_to_run;
 	test_progress_t test_progress;
 	const test_case_t *next_test;
+	TESTCASE_RESULT result;
+	/* Too big for the stack, only used by the lead CPU */
+	static char output[TESTCASE_OUTPUT_MAX_SIZE];
 
 	/* Get back on our feet. Where did we stop? */
 	tftf_get_test_to_run(&test_to_run);
 	tftf_get_test_progress(&test_progress);
 	assert(TEST_PROGRESS_IS_VALID(test_progress));
 
+	/*
+	 * The result of a test is written to NVM before TEST_COMPLETE. If it
+	 * has already been written, the framework has been interrupted while
+	 * writing back the state of the session after the test had completed.
+	 */
+	if ((test_progress == TEST_IN_PROGRESS) ||
+	    (test_progress == TEST_COMPLETE)) {
+		tftf_testcase_get_result(current_testcase(), &result, output);
+		if (result.result != TEST_RESULT_NA)
+			test_progress = TEST_COMPLETE;
+	}
+
 	switch (test_progress) {
 	case TEST_READY:
 		/*
@@ -483,6 +746,10 @@ static int resume_test_session(void)
 		tftf_testcase_set_result(current_testcase(),
 					TEST_RESULT_CRASHED,
 					0);
+#if PARALLEL_SINGLE_CORE_TESTS
+		if (crash_test_batch() != 0)
+			return -1;
+#endif
 		next_test = advance_to_next_test();
 		if (!next_test) {
 			INFO("No more tests\n");
@@ -492,20 +759,28 @@ static int resume_test_session(void)
 
 	case TEST_COMPLETE:
 		/*
-		 * The TFTF has reset in the framework code, after the test had
-		 * completed but before we finished the framework maintenance
-		 * required to move to the next test.
+		 * The TFTF has reset after the test had completed, either in
+		 * the framework code or to run the next test in a clean
+		 * environment.
 		 *
-		 * In this case, we don't know the exact state of the data:
-		 * maybe we had the time to update the test result,
-		 * maybe we had the time to move to the next test.
-		 * We can't be sure so let's stay on the safe side and just
+		 * Without a result, the framework has been interrupted while
+		 * saving the results of a batch of tests. We can't be sure of
+		 * the state of the data so let's stay on the safe side and just
 		 * restart the test session from the beginning...
 		 */
-		NOTICE("The test framework has been interrupted in the middle "
-			"of critical maintenance operations.\n");
-		NOTICE("Can't recover execution.\n");
-		return -1;
+		if (result.result == TEST_RESULT_NA) {
+			NOTICE("The test framework has been interrupted in the "
+				"middle of critical maintenance operations.\n");
+			NOTICE("Can't recover execution.\n");
+			return -1;
+		}
+
+		next_test = advance_to_next_test();
+		if (!next_test) {
+			INFO("No more tests\n");
+			return -1;
+		}
+		break;
 
 	case TEST_REBOOTING:
 		/*
@@ -563,7 +838,11 @@ void __dead2 tftf_cold_boot_main(void)
 	tftf_platform_setup();
 	tftf_init_topology();
 
+	/* Select the tests to run in this session */
+	tftf_init_test_filter();
+
 	tftf_irq_setup();
+	tftf_irq_setup_local();
 
 	rc = tftf_initialise_timer();
 	if (rc != 0) {
@@ -588,6 +867,17 @@ void __dead2 tftf_cold_boot_main(void)
 			tftf_clean_nvm();
 			tftf_exit();
 		}
+
+		/* Skip the first test cases if they have been filtered out */
+		if (!tftf_is_test_selected(current_testcase())) {
+			tftf_set_test_progress(TEST_COMPLETE);
+			if (advance_to_next_test() == NULL) {
+				NOTICE("No test selected to run\n");
+				print_tests_summary();
+				tftf_clean_nvm();
+				tftf_exit();
+			}
+		}
 	} else {
 		NOTICE("Resuming interrupted test session\n");
 		rc = resume_test_session();
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -14,33 +14,34 @@
 #include <debug.h>
 #include <nvm.h>
 #include <platform.h>
-#include <spinlock.h>
+#include <stdbool.h>
 #include <stdio.h>
 
 /*
- * Temporary buffer to store 1 test output.
- * This will eventually be saved into NVM at the end of the execution
- * of this test.
- */
-static char testcase_output[TESTCASE_OUTPUT_MAX_SIZE];
-/*
+ * Temporary buffers to store the test output, one per CPU so that CPUs don't
+ * contend on a lock to write it. They are merged in CPU order and saved into
+ * NVM at the end of the execution of the test.
+ *
  * A test output can be written in several pieces by calling
- * tftf_testcase_printf() multiple times. testcase_output_idx keeps the position
- * of the last character written in testcase_output buffer and allows to easily
+ * tftf_testcase_printf() multiple times. cpu_output_idx keeps the position of
+ * the last character written in the buffer of each CPU and allows to easily
  * append a new string at next call to tftf_testcase_printf().
+ * cpu_output_truncated records whether some output of the CPU was lost.
  */
-static unsigned int testcase_output_idx;
-
-/* Lock to avoid concurrent accesses to the testcase output buffer */
-static spinlock_t testcase_output_lock;
+static char cpu_output[PLATFORM_CORE_COUNT][TESTCASE_CPU_OUTPUT_SIZE];
+static unsigned int cpu_output_idx[PLATFORM_CORE_COUNT];
+static bool cpu_output_truncated[PLATFORM_CORE_COUNT];
 
 static tftf_state_t tftf_init_state = {
 	.build_message		= "",
-	.test_to_run		= {
-		.testsuite_idx	= 0,
-		.testcase_idx	= 0,
+	.session		= {
+		.test_to_run		= {
+			.testsuite_idx	= 0,
+			.testcase_idx	= 0,
+		},
+		.test_progress		= TEST_READY,
+		.result_buffer_size	= 0,
 	},
-	.test_progress		= TEST_READY,
 	.testcase_buffer	= { 0 },
 	.testcase_results	= {
 		{
@@ -48,12 +49,51 @@ static tftf_state_t tftf_init_state = {
 			.duration	= 0,
 			.output_offset	= 0,
 			.output_size	= 0,
+			.output_truncated = 0,
 		}
 	},
-	.result_buffer_size	= 0,
 	.result_buffer		= NULL,
 };
 
+/*
+ * Write-back cache of the test session state and of the result of the last
+ * test. On platforms storing results in flash, each NVM write is expensive so
+ * state transitions are kept in DRAM and only written to NVM by
+ * tftf_flush_nvm() at well defined checkpoints.
+ */
+static struct {
+	/* True once the session state has been loaded from NVM */
+	bool		loaded;
+	/* True if the session state differs from the one in NVM */
+	bool		dirty;
+	tftf_session_t	session;
+
+	/* Result of the last test, if not written to NVM yet */
+	bool		result_pending;
+	unsigned int	result_index;
+	TESTCASE_RESULT	result;
+	char		output[TESTCASE_OUTPUT_MAX_SIZE];
+} nvm_cache;
+
+static STATUS nvm_cache_load(void)
+{
+	STATUS status;
+
+	if (nvm_cache.loaded)
+		return STATUS_SUCCESS;
+
+	status = tftf_nvm_read(TFTF_STATE_OFFSET(session), &nvm_cache.session,
+			sizeof(nvm_cache.session));
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	nvm_cache.loaded = true;
+	nvm_cache.dirty = false;
+	nvm_cache.result_pending = false;
+
+	return STATUS_SUCCESS;
+}
+
 unsigned int new_test_session(void)
 {
 /* NEW_TEST_SESSION == 1 => we always want to start a new session */
@@ -75,16 +115,41 @@ unsigned int new_test_session(void)
 
 STATUS tftf_init_nvm(void)
 {
+	STATUS status;
+
 	INFO("Initialising NVM\n");
 
 	/* Copy the build message to identify the TFTF */
 	strncpy(tftf_init_state.build_message, build_message, BUILD_MESSAGE_SIZE);
-	return tftf_nvm_write(0, &tftf_init_state, sizeof(tftf_init_state));
+
+	/*
+	 * No test has run yet. This allows to tell whether the result of the
+	 * current test has been written when resuming the test session.
+	 */
+	for (unsigned int i = 0; i < TESTCASE_RESULT_COUNT; i++)
+		tftf_init_state.testcase_results[i].result = TEST_RESULT_NA;
+
+	status = tftf_nvm_write(0, &tftf_init_state, sizeof(tftf_init_state));
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	nvm_cache.session = tftf_init_state.session;
+	nvm_cache.loaded = true;
+	nvm_cache.dirty = false;
+	nvm_cache.result_pending = false;
+
+	return STATUS_SUCCESS;
 }
 
 STATUS tftf_clean_nvm(void)
 {
 	unsigned char corrupt_build_message = '\0';
+	STATUS status;
+
+	/* Leave complete results in NVM */
+	status = tftf_flush_nvm();
+	if (status != STATUS_SUCCESS)
+		ERROR("Failed to write back test session state (%d)\n", status);
 
 	/*
 	 * This will cause TFTF to re-initialise its data structures next time
@@ -95,87 +160,265 @@ STATUS tftf_clean_nvm(void)
 			sizeof(corrupt_build_message));
 }
 
+STATUS tftf_flush_nvm(void)
+{
+	STATUS status;
+
+	if (!nvm_cache.dirty)
+		return STATUS_SUCCESS;
+
+	if (nvm_cache.result_pending) {
+		status = tftf_nvm_write(TFTF_STATE_OFFSET(testcase_results) +
+				(nvm_cache.result_index * sizeof(TESTCASE_RESULT)),
+				&nvm_cache.result, sizeof(TESTCASE_RESULT));
+		if (status != STATUS_SUCCESS)
+			return status;
+
+		if (nvm_cache.result.output_size != 0) {
+			status = tftf_nvm_write(TFTF_STATE_OFFSET(result_buffer) +
+					nvm_cache.result.output_offset,
+					nvm_cache.output,
+					nvm_cache.result.output_size + 1);
+			if (status != STATUS_SUCCESS)
+				return status;
+		}
+	}
+
+	status = tftf_nvm_write(TFTF_STATE_OFFSET(session), &nvm_cache.session,
+			sizeof(nvm_cache.session));
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	nvm_cache.result_pending = false;
+	nvm_cache.dirty = false;
+
+	return STATUS_SUCCESS;
+}
+
 STATUS tftf_set_test_to_run(const test_ref_t test_to_run)
 {
-	return tftf_nvm_write(TFTF_STATE_OFFSET(test_to_run), &test_to_run,
-			sizeof(test_to_run));
+	STATUS status;
+
+	status = nvm_cache_load();
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	nvm_cache.session.test_to_run = test_to_run;
+	nvm_cache.dirty = true;
+
+	return STATUS_SUCCESS;
 }
 
 STATUS tftf_get_test_to_run(test_ref_t *test_to_run)
 {
+	STATUS status;
+
 	assert(test_to_run != NULL);
-	return tftf_nvm_read(TFTF_STATE_OFFSET(test_to_run), test_to_run,
-			sizeof(*test_to_run));
+
+	status = nvm_cache_load();
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	*test_to_run = nvm_cache.session.test_to_run;
+
+	return STATUS_SUCCESS;
 }
 
 STATUS tftf_set_test_progress(test_progress_t test_progress)
 {
-	return tftf_nvm_write(TFTF_STATE_OFFSET(test_progress), &test_progress,
-			sizeof(test_progress));
+	STATUS status;
+
+	status = nvm_cache_load();
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	nvm_cache.session.test_progress = test_progress;
+	nvm_cache.dirty = true;
+
+	/*
+	 * The test is about to run or to reboot the platform: whatever happens
+	 * next, the state must be found in NVM after a reset. TEST_COMPLETE is
+	 * written back by the framework along with the result of the test, and
+	 * TEST_READY only matters once the test is in progress.
+	 */
+	if ((test_progress == TEST_IN_PROGRESS) ||
+	    (test_progress == TEST_REBOOTING))
+		return tftf_flush_nvm();
+
+	return STATUS_SUCCESS;
+}
+
+#if PARALLEL_SINGLE_CORE_TESTS
+STATUS tftf_set_test_batch(const test_ref_t first, const test_ref_t last)
+{
+	STATUS status;
+
+	status = nvm_cache_load();
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	nvm_cache.session.batch_first = first;
+	nvm_cache.session.batch_last = last;
+	nvm_cache.dirty = true;
+
+	return STATUS_SUCCESS;
+}
+
+STATUS tftf_get_test_batch(test_ref_t *first, test_ref_t *last)
+{
+	STATUS status;
+
+	assert(first != NULL);
+	assert(last != NULL);
+
+	status = nvm_cache_load();
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	*first = nvm_cache.session.batch_first;
+	*last = nvm_cache.session.batch_last;
+
+	return STATUS_SUCCESS;
 }
+#endif /* PARALLEL_SINGLE_CORE_TESTS */
 
 STATUS tftf_get_test_progress(test_progress_t *test_progress)
 {
+	STATUS status;
+
 	assert(test_progress != NULL);
-	return tftf_nvm_read(TFTF_STATE_OFFSET(test_progress), test_progress,
-			sizeof(*test_progress));
+
+	status = nvm_cache_load();
+	if (status != STATUS_SUCCESS)
+		return status;
+
+	*test_progress = nvm_cache.session.test_progress;
+
+	return STATUS_SUCCESS;
 }
 
-STATUS tftf_testcase_set_result(const test_case_t *testcase,
-				test_result_t result,
-				unsigned long long duration)
+/*
+ * Append the output of the CPUs `first_cpu` to `last_cpu` to the NVM cache, in
+ * CPU order, and reset their buffers. Return the size of the merged output.
+ */
+static unsigned int merge_cpu_output(unsigned int first_cpu,
+				     unsigned int last_cpu, bool *truncated)
+{
+	unsigned int core_pos, size, idx = 0;
+
+	assert(last_cpu < PLATFORM_CORE_COUNT);
+
+	for (core_pos = first_cpu; core_pos <= last_cpu; core_pos++) {
+		size = cpu_output_idx[core_pos];
+
+		/* Leave room for the final '\0' */
+		if (size > TESTCASE_OUTPUT_MAX_SIZE - 1 - idx) {
+			size = TESTCASE_OUTPUT_MAX_SIZE - 1 - idx;
+			*truncated = true;
+		}
+
+		memcpy(&nvm_cache.output[idx], cpu_output[core_pos], size);
+		idx += size;
+
+		if (cpu_output_truncated[core_pos])
+			*truncated = true;
+
+		cpu_output_idx[core_pos] = 0;
+		cpu_output[core_pos][0] = 0;
+		cpu_output_truncated[core_pos] = false;
+	}
+
+	nvm_cache.output[idx] = 0;
+
+	return idx;
+}
+
+/*
+ * Cache the result of `testcase`, whose output is the merged output of the
+ * CPUs `first_cpu` to `last_cpu`. The result is written to NVM at the next
+ * checkpoint.
+ */
+static STATUS testcase_set_result(const test_case_t *testcase,
+				  test_result_t result,
+				  unsigned long long duration,
+				  unsigned int first_cpu,
+				  unsigned int last_cpu)
 {
 	STATUS status;
-	unsigned result_buffer_size = 0;
-	TESTCASE_RESULT test_result;
+	bool truncated = false;
+	size_t available;
 
 	assert(testcase != NULL);
 
-	/* Initialize Test case result */
-	test_result.result = result;
-	test_result.duration = duration;
-	test_result.output_offset = 0;
-	test_result.output_size = strlen(testcase_output);
+	status = nvm_cache_load();
+	if (status != STATUS_SUCCESS)
+		return status;
 
-	/* Does the test have an output? */
-	if (test_result.output_size != 0) {
-		/* Get the size of the buffer containing all tests outputs */
-		status = tftf_nvm_read(TFTF_STATE_OFFSET(result_buffer_size),
-				&result_buffer_size, sizeof(unsigned));
+	/* Only the result of the last test is cached */
+	if (nvm_cache.result_pending) {
+		status = tftf_flush_nvm();
 		if (status != STATUS_SUCCESS)
-			goto reset_test_output;
+			return status;
+	}
+
+	/* Initialize Test case result */
+	nvm_cache.result_index = testcase->index;
+	nvm_cache.result.result = result;
+	nvm_cache.result.duration = duration;
+	nvm_cache.result.output_offset = 0;
+	nvm_cache.result.output_size = merge_cpu_output(first_cpu, last_cpu,
+							&truncated);
+
+	/* Don't let the output overwrite the test filter record */
+	available = RESULT_BUFFER_MAX_SIZE -
+		nvm_cache.session.result_buffer_size;
+	if (nvm_cache.result.output_size + 1 > available) {
+		nvm_cache.result.output_size = (available > 1) ?
+			(available - 1) : 0;
+		nvm_cache.output[nvm_cache.result.output_size] = 0;
+		truncated = true;
+	}
+
+	nvm_cache.result.output_truncated = truncated;
 
+	/* Does the test have an output? */
+	if (nvm_cache.result.output_size != 0) {
 		/*
-		 * Write the output buffer at the end of the string buffer in
-		 * NVM
+		 * The output will be written at the end of the string buffer
+		 * in NVM.
 		 */
-		test_result.output_offset = result_buffer_size;
-		status = tftf_nvm_write(
-			TFTF_STATE_OFFSET(result_buffer) + result_buffer_size,
-			testcase_output, test_result.output_size + 1);
-		if (status != STATUS_SUCCESS)
-			goto reset_test_output;
-
-		/* And update the buffer size into NVM */
-		result_buffer_size += test_result.output_size + 1;
-		status = tftf_nvm_write(TFTF_STATE_OFFSET(result_buffer_size),
-					&result_buffer_size, sizeof(unsigned));
-		if (status != STATUS_SUCCESS)
-			goto reset_test_output;
+		nvm_cache.result.output_offset =
+			nvm_cache.session.result_buffer_size;
+		nvm_cache.session.result_buffer_size +=
+			nvm_cache.result.output_size + 1;
 	}
 
-	/* Write the test result into NVM */
-	status = tftf_nvm_write(TFTF_STATE_OFFSET(testcase_results) +
-				(testcase->index * sizeof(TESTCASE_RESULT)),
-				&test_result, sizeof(TESTCASE_RESULT));
+	nvm_cache.result_pending = true;
+	nvm_cache.dirty = true;
 
-reset_test_output:
-	/* Reset test output buffer for the next test */
-	testcase_output_idx = 0;
-	testcase_output[0] = 0;
+	return STATUS_SUCCESS;
+}
+
+STATUS tftf_testcase_set_result(const test_case_t *testcase,
+				test_result_t result,
+				unsigned long long duration)
+{
+	return testcase_set_result(testcase, result, duration,
+			0, PLATFORM_CORE_COUNT - 1);
+}
+
+#if PARALLEL_SINGLE_CORE_TESTS
+STATUS tftf_testcase_set_cpu_result(const test_case_t *testcase,
+				    test_result_t result,
+				    unsigned long long duration,
+				    unsigned int core_pos)
+{
+	assert(core_pos < PLATFORM_CORE_COUNT);
 
-	return status;
+	return testcase_set_result(testcase, result, duration,
+			core_pos, core_pos);
 }
+#endif /* PARALLEL_SINGLE_CORE_TESTS */
 
 STATUS tftf_testcase_get_result(const test_case_t *testcase,
 				TESTCASE_RESULT *result,
@@ -188,6 +431,15 @@ STATUS tftf_testcase_get_result(const test_case_t *testcase,
 	assert(result != NULL);
 	assert(test_output != NULL);
 
+	/* The result might not have been written to NVM yet */
+	if (nvm_cache.result_pending &&
+	    (nvm_cache.result_index == testcase->index)) {
+		*result = nvm_cache.result;
+		memcpy(test_output, nvm_cache.output, result->output_size);
+		test_output[result->output_size] = 0;
+		return STATUS_SUCCESS;
+	}
+
 	status = tftf_nvm_read(TFTF_STATE_OFFSET(testcase_results)
 			+ (testcase->index * sizeof(TESTCASE_RESULT)),
 			result, sizeof(TESTCASE_RESULT));
@@ -210,32 +462,32 @@ STATUS tftf_testcase_get_result(const test_case_t *testcase,
 	return STATUS_SUCCESS;
 }
 
-int tftf_testcase_printf(const char *format, ...)
+/*
+ * Append the formatted string to the test output buffer `buf` of `size` bytes,
+ * at position `*idx`. Set `*truncated` if the string doesn't fit.
+ */
+static int testcase_vprintf(char *buf, unsigned int size, unsigned int *idx,
+			    bool *truncated, const char *format, va_list ap)
 {
-	va_list ap;
 	int available;
-	int written = -1;
-
-	spin_lock(&testcase_output_lock);
+	int written;
 
-	assert(sizeof(testcase_output) >= testcase_output_idx);
-	available = sizeof(testcase_output) - testcase_output_idx;
+	assert(size >= *idx);
+	available = size - *idx;
 	if (available == 0) {
+		*truncated = true;
 		ERROR("%s: Output buffer is full ; the string won't be printed.\n",
 			__func__);
-		ERROR("%s: Consider increasing TESTCASE_OUTPUT_MAX_SIZE value.\n",
+		ERROR("%s: Consider increasing TESTCASE_CPU_OUTPUT_SIZE value.\n",
 			__func__);
-		goto release_lock;
+		return -1;
 	}
 
-	va_start(ap, format);
-	written = vsnprintf(&testcase_output[testcase_output_idx], available,
-			format, ap);
-	va_end(ap);
+	written = vsnprintf(&buf[*idx], available, format, ap);
 
 	if (written < 0) {
 		ERROR("%s: Output error (%d)", __func__, written);
-		goto release_lock;
+		return written;
 	}
 	/*
 	 * If vsnprintf() truncated the string due to the size limit passed as
@@ -248,22 +500,36 @@ int tftf_testcase_printf(const char *format, ...)
 	 * written.
 	 */
 	if (written >= available) {
+		*truncated = true;
 		ERROR("%s: String has been truncated (%u/%u bytes written).\n",
 			__func__, available - 1, written);
-		ERROR("%s: Consider increasing TESTCASE_OUTPUT_MAX_SIZE value.\n",
+		ERROR("%s: Consider increasing TESTCASE_CPU_OUTPUT_SIZE value.\n",
 			__func__);
 		written = available - 1;
 	}
 
 	/*
-	 * Update testcase_output_idx to point to the '\0' of the buffer.
-	 * The next call of tftf_testcase_printf() will overwrite '\0' to
-	 * append its new string to the buffer.
+	 * Update the index to point to the '\0' of the buffer. The next call
+	 * of tftf_testcase_printf() will overwrite '\0' to append its new
+	 * string to the buffer.
 	 */
-	testcase_output_idx += written;
+	*idx += written;
+
+	return written;
+}
+
+int tftf_testcase_printf(const char *format, ...)
+{
+	va_list ap;
+	int written;
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+
+	va_start(ap, format);
+	written = testcase_vprintf(cpu_output[core_pos],
+			sizeof(cpu_output[core_pos]), &cpu_output_idx[core_pos],
+			&cpu_output_truncated[core_pos], format, ap);
+	va_end(ap);
 
-release_lock:
-	spin_unlock(&testcase_output_lock);
 	return written;
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -36,7 +36,8 @@ void print_test_start(const test_case_t *test)
 void print_test_end(const test_case_t *test)
 {
 	TESTCASE_RESULT result;
-	char output[TESTCASE_OUTPUT_MAX_SIZE];
+	/* Too big for the stack, only used by the lead CPU */
+	static char output[TESTCASE_OUTPUT_MAX_SIZE];
 
 	tftf_testcase_get_result(test, &result, output);
 
@@ -45,6 +46,11 @@ void print_test_end(const test_case_t *test)
 	if (strlen(output) != 0) {
 		mp_printf("%s", output);
 	}
+	if (result.output_truncated) {
+		mp_printf("  (test output truncated, consider increasing "
+			  "TESTCASE_CPU_OUTPUT_SIZE or "
+			  "TESTCASE_OUTPUT_MAX_SIZE)\n");
+	}
 	mp_printf("\n");
 }
 
@@ -58,15 +64,24 @@ void print_tests_summary(void)
 	/* Go through the list of test suites. */
 	for (int i = 0; testsuites[i].name != NULL; i++) {
 		bool passed = true;
-
-		mp_printf("> Test suite '%s'\n", testsuites[i].name);
+		bool selected = false;
 
 		const test_case_t *testcases = testsuites[i].testcases;
 
 		/* Go through the list of tests inside this test suite. */
 		for (int j = 0; testcases[j].name != NULL; j++) {
 			TESTCASE_RESULT result;
-			char output[TESTCASE_OUTPUT_MAX_SIZE];
+			static char output[TESTCASE_OUTPUT_MAX_SIZE];
+
+			/* Only report the tests selected to run */
+			if (!tftf_is_test_selected(&testcases[j]))
+				continue;
+
+			if (!selected) {
+				mp_printf("> Test suite '%s'\n",
+					testsuites[i].name);
+				selected = true;
+			}
 
 			if (tftf_testcase_get_result(&testcases[j], &result,
 					output) != STATUS_SUCCESS) {
@@ -88,7 +103,8 @@ void print_tests_summary(void)
 			total_tests++;
 			tests_stats[result.result]++;
 		}
-		mp_printf("%70s\n", passed ? "Passed" : "Failed");
+		if (selected)
+			mp_printf("%70s\n", passed ? "Passed" : "Failed");
 	}
 
 	mp_printf("=================================\n");
@@ -98,5 +114,9 @@ void print_tests_summary(void)
 			test_result_to_string(i), tests_stats[i]);
 	}
 	mp_printf("%-14s: %d\n", "Total tests", total_tests);
+	if (tftf_get_filtered_out_count() != 0) {
+		mp_printf("%-14s: %u\n", "Filtered out",
+			tftf_get_filtered_out_count());
+	}
 	mp_printf("=================================\n");
 }
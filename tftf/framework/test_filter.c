@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Runtime selection of the tests to run.
+ *
+ * The tests list is fixed at build time but a subset of it can be selected at
+ * runtime through a device tree node compatible with "arm,tftf-test-filter":
+ *
+ *	test-filter {
+ *		compatible = "arm,tftf-test-filter";
+ *		include = "PSCI*", "SDEI*";
+ *		exclude = "*stress*";
+ *		shard-index = <1>;
+ *		shard-count = <4>;
+ *	};
+ *
+ * Patterns are matched against "<test suite name>/<test case name>" and may
+ * use the '*' and '?' wildcards. All properties are optional.
+ *
+ * The node is looked up in the following blobs, in order:
+ *  - the fw_config DTB passed by the EL3 firmware;
+ *  - the hw_config DTB passed by the EL3 firmware;
+ *  - a DTB stored in the last TEST_FILTER_NVM_SIZE bytes of the NVM.
+ *
+ * The filter is evaluated again on every cold boot so it applies to resumed
+ * test sessions as well.
+ */
+
+#include <assert.h>
+#include <debug.h>
+#include <libfdt.h>
+#include <nvm.h>
+#include <platform_def.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <tftf.h>
+#include <utils_def.h>
+#include <xlat_tables_v2.h>
+
+#define TEST_FILTER_COMPATIBLE		"arm,tftf-test-filter"
+
+/* Maximum size of "<test suite name>/<test case name>" */
+#define TEST_FULL_NAME_MAX_SIZE		256
+
+/* Parameters arg0 and arg1 passed from BL31 */
+extern u_register_t fw_config_base;
+extern u_register_t hw_config_base;
+
+/* Bitmap of the selected tests, indexed by test case index */
+static uint8_t test_selected[(TESTCASE_RESULT_COUNT + 7) / 8];
+static unsigned int filtered_out_count;
+
+static uint8_t filter_nvm_record[TEST_FILTER_NVM_SIZE] __aligned(8);
+
+/*
+ * Return true if `str` matches the shell-like `pattern`, where '*' matches any
+ * sequence of characters and '?' matches any single character.
+ */
+static bool glob_match(const char *pattern, const char *str)
+{
+	const char *star = NULL;
+	const char *backtrack = NULL;
+
+	while (*str != '\0') {
+		if ((*pattern == '?') || (*pattern == *str)) {
+			++pattern;
+			++str;
+		} else if (*pattern == '*') {
+			/* Try to match an empty sequence first */
+			star = pattern++;
+			backtrack = str;
+		} else if (star != NULL) {
+			/* Let the last '*' swallow one more character */
+			pattern = star + 1;
+			str = ++backtrack;
+		} else {
+			return false;
+		}
+	}
+
+	while (*pattern == '*')
+		++pattern;
+
+	return *pattern == '\0';
+}
+
+/*
+ * Return true if `name` matches any of the patterns of the string list
+ * property `prop` of length `len`.
+ */
+static bool match_any(const char *prop, int len, const char *name)
+{
+	const char *end = prop + len;
+
+	while (prop < end) {
+		if (glob_match(prop, name))
+			return true;
+		prop += strnlen(prop, end - prop) + 1;
+	}
+
+	return false;
+}
+
+static uint32_t get_u32_prop(const void *fdt, int node, const char *name,
+			     uint32_t default_value)
+{
+	const fdt32_t *prop;
+	int len;
+
+	prop = fdt_getprop(fdt, node, name, &len);
+	if ((prop == NULL) || (len != sizeof(*prop)))
+		return default_value;
+
+	return fdt32_to_cpu(*prop);
+}
+
+/*
+ * Return the DTB at address `base` if it is mapped and valid, NULL otherwise.
+ */
+static const void *get_dtb(uintptr_t base)
+{
+	uint32_t attr;
+
+	if ((base == 0U) || (xlat_get_mem_attributes(base, &attr) != 0))
+		return NULL;
+
+	if (fdt_check_header((const void *)base) != 0)
+		return NULL;
+
+	if (xlat_get_mem_attributes(base + fdt_totalsize((const void *)base) - 1U,
+				    &attr) != 0)
+		return NULL;
+
+	return (const void *)base;
+}
+
+/*
+ * Look for the test filter node. Return its offset and store the DTB it lives
+ * in into `*fdt_out`, or return a negative value if there is none.
+ */
+static int find_filter_node(const void **fdt_out)
+{
+	const void *fdt;
+	const uintptr_t dtbs[] = { fw_config_base, hw_config_base };
+	int node;
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(dtbs); ++i) {
+		fdt = get_dtb(dtbs[i]);
+		if (fdt == NULL)
+			continue;
+
+		node = fdt_node_offset_by_compatible(fdt, -1,
+				TEST_FILTER_COMPATIBLE);
+		if (node >= 0) {
+			*fdt_out = fdt;
+			return node;
+		}
+	}
+
+	if (tftf_nvm_read(TEST_FILTER_NVM_OFFSET, filter_nvm_record,
+			  sizeof(filter_nvm_record)) != STATUS_SUCCESS)
+		return -1;
+
+	fdt = filter_nvm_record;
+	if ((fdt_check_header(fdt) != 0) ||
+	    (fdt_totalsize(fdt) > sizeof(filter_nvm_record)))
+		return -1;
+
+	*fdt_out = fdt;
+	return fdt_node_offset_by_compatible(fdt, -1, TEST_FILTER_COMPATIBLE);
+}
+
+void tftf_init_test_filter(void)
+{
+	const void *fdt;
+	const char *include;
+	const char *exclude;
+	int include_len;
+	int exclude_len;
+	uint32_t shard_index;
+	uint32_t shard_count;
+	unsigned int selected_count = 0;
+	char name[TEST_FULL_NAME_MAX_SIZE];
+	int node;
+
+	/* Run all tests unless told otherwise */
+	memset(test_selected, 0xff, sizeof(test_selected));
+	filtered_out_count = 0;
+
+	node = find_filter_node(&fdt);
+	if (node < 0)
+		return;
+
+	include = fdt_getprop(fdt, node, "include", &include_len);
+	exclude = fdt_getprop(fdt, node, "exclude", &exclude_len);
+	shard_index = get_u32_prop(fdt, node, "shard-index", 0);
+	shard_count = get_u32_prop(fdt, node, "shard-count", 1);
+
+	if ((shard_count == 0) || (shard_index >= shard_count)) {
+		ERROR("Invalid test shard %u/%u, ignoring it\n",
+			shard_index, shard_count);
+		shard_index = 0;
+		shard_count = 1;
+	}
+
+	for (unsigned int i = 0; testsuites[i].name != NULL; i++) {
+		const test_case_t *testcases = testsuites[i].testcases;
+
+		for (unsigned int j = 0; testcases[j].name != NULL; j++) {
+			bool selected = true;
+
+			snprintf(name, sizeof(name), "%s/%s",
+				testsuites[i].name, testcases[j].name);
+
+			if ((include != NULL) &&
+			    !match_any(include, include_len, name))
+				selected = false;
+
+			if (selected && (exclude != NULL) &&
+			    match_any(exclude, exclude_len, name))
+				selected = false;
+
+			/* Deal the remaining tests out to the shards in turn */
+			if (selected &&
+			    ((selected_count++ % shard_count) != shard_index))
+				selected = false;
+
+			if (!selected) {
+				assert(testcases[j].index < TESTCASE_RESULT_COUNT);
+				test_selected[testcases[j].index / 8] &=
+					~(1U << (testcases[j].index % 8));
+				++filtered_out_count;
+			}
+		}
+	}
+
+	NOTICE("Test filter: %u test(s) filtered out, shard %u/%u\n",
+		filtered_out_count, shard_index, shard_count);
+}
+
+bool tftf_is_test_selected(const test_case_t *testcase)
+{
+	assert(testcase->index < TESTCASE_RESULT_COUNT);
+
+	return (test_selected[testcase->index / 8] &
+		(1U << (testcase->index % 8))) != 0;
+}
+
+unsigned int tftf_get_filtered_out_count(void)
+{
+	return filtered_out_count;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -409,6 +409,8 @@ int tftf_timer_framework_handler(void *data)
 	unsigned int handler_core_pos = platform_get_core_pos(read_mpidr_el1());
 	unsigned int next_timer_req_core_pos;
 	unsigned long long current_time;
+	unsigned int wake_cnt = 0;
+	core_mask_t wake_mask;
 	int rc = 0;
 
 	assert(interrupt_req_time[handler_core_pos] != INVALID_TIME);
@@ -442,13 +444,17 @@ int tftf_timer_framework_handler(void *data)
 		timer_handler[handler_core_pos](data);
 
 	/* Send interrupts to all the CPUS in the min time block */
+	core_mask_clear(&wake_mask);
 	for (int i = 0; i < PLATFORM_CORE_COUNT; i++) {
 		if ((interrupt_req_time[i] <=
 				(current_time + TIMER_STEP_VALUE))) {
 			interrupt_req_time[i] = INVALID_TIME;
-			tftf_send_sgi(IRQ_WAKE_SGI, i);
+			core_mask_set(&wake_mask, i);
+			wake_cnt++;
 		}
 	}
+	if (wake_cnt != 0)
+		tftf_send_sgi_mask(IRQ_WAKE_SGI, &wake_mask);
 
 	/* Get the next lowest requested timer core and program it */
 	next_timer_req_core_pos = get_lowest_req_core();
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -410,6 +410,28 @@ test_result_t test_timer_target_multiple_same_interval(void)
 	return multiple_timer_count ? TEST_RESULT_SUCCESS : TEST_RESULT_SKIPPED;
 }
 
+/*
+ * Print how many times the calling CPU took interrupt #irq_num since `start`
+ * was read, `ticks` system counter ticks ago, and the time spent in its
+ * handler.
+ */
+static void print_irq_stats(const char *name, unsigned int irq_num,
+			    const irq_stats_t *start, unsigned long long ticks)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	unsigned long long count;
+	irq_stats_t stats;
+
+	tftf_irq_get_stats(core_pos, irq_num, &stats);
+	count = stats.count - start->count;
+
+	tftf_testcase_printf("CPU %u: %llu %s IRQs, %llu per second, handler %llu ticks on average, %llu at most\n",
+		core_pos, count, name,
+		(count * read_cntfrq_el0()) / ticks,
+		(count != 0ULL) ? (stats.ticks - start->ticks) / count : 0ULL,
+		(unsigned long long)stats.max_ticks);
+}
+
 static test_result_t do_stress_test(void)
 {
 	unsigned int power_state;
@@ -417,13 +439,18 @@ static test_result_t do_stress_test(void)
 	unsigned int timer_int_interval;
 	unsigned int verify_cancel;
 	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	unsigned long long start_time;
 	unsigned long long end_time;
 	unsigned long long current_time;
+	irq_stats_t timer_stats, sgi_stats;
 	int ret;
 
 	tftf_send_event(&cpu_ready[core_pos]);
 
-	end_time = read_cntpct_el0() + read_cntfrq_el0() * 10;
+	tftf_irq_get_stats(core_pos, tftf_get_timer_irq(), &timer_stats);
+	tftf_irq_get_stats(core_pos, IRQ_WAKE_SGI, &sgi_stats);
+	start_time = read_cntpct_el0();
+	end_time = start_time + read_cntfrq_el0() * 10;
 
 	/* Construct the state-id for power down */
 	ret = tftf_psci_make_composite_state_id(MPIDR_AFFLVL0,
@@ -504,6 +531,12 @@ static test_result_t do_stress_test(void)
 		return TEST_RESULT_SKIPPED;
 	}
 
+	current_time = read_cntpct_el0();
+	print_irq_stats("timer", tftf_get_timer_irq(), &timer_stats,
+			current_time - start_time);
+	print_irq_stats("wake SGI", IRQ_WAKE_SGI, &sgi_stats,
+			current_time - start_time);
+
 	return TEST_RESULT_SUCCESS;
 }
 
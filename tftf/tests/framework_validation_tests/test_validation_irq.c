@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -35,16 +35,19 @@ static int set_counter_to_42(void *data)
  * @Test_Aim@ Test IRQ handling on lead CPU
  *
  * Check that IRQ enabling/disabling and IRQ handler registering/unregistering
- * work as expected on the lead CPU.
+ * work as expected on the lead CPU, and that the interrupts taken are counted
+ * in the IRQ statistics.
  */
 test_result_t test_validation_irq(void)
 {
 	unsigned int mpid = read_mpidr_el1();
 	unsigned int core_pos = platform_get_core_pos(mpid);
 	const unsigned int sgi_id = IRQ_NS_SGI_0;
+	irq_stats_t stats_before, stats_after;
 	int ret;
 
 	counter = 0;
+	tftf_irq_get_stats(core_pos, sgi_id, &stats_before);
 
 	/* Now register a handler */
 	ret = tftf_irq_register_handler(sgi_id, increment_counter);
@@ -127,5 +130,19 @@ test_result_t test_validation_irq(void)
 
 	tftf_irq_disable(sgi_id);
 
+	/* The 3 SGIs are counted, but only 2 of them had a handler to time */
+	tftf_irq_get_stats(core_pos, sgi_id, &stats_after);
+	if ((stats_after.count - stats_before.count) != 3U) {
+		tftf_testcase_printf("%llu SGIs counted instead of 3\n",
+			(unsigned long long)(stats_after.count -
+					     stats_before.count));
+		return TEST_RESULT_FAIL;
+	}
+	if ((stats_after.ticks < stats_before.ticks) ||
+	    (stats_after.max_ticks > stats_after.ticks)) {
+		tftf_testcase_printf("Inconsistent SGI handler times\n");
+		return TEST_RESULT_FAIL;
+	}
+
 	return TEST_RESULT_SUCCESS;
 }
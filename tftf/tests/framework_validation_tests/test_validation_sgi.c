@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -7,8 +7,12 @@
 #include <arch_helpers.h>
 #include <debug.h>
 #include <drivers/arm/arm_gic.h>
+#include <events.h>
 #include <irq.h>
+#include <plat_topology.h>
 #include <platform.h>
+#include <power_management.h>
+#include <psci.h>
 #include <sgi.h>
 #include <tftf_lib.h>
 
@@ -80,3 +84,124 @@ test_result_t test_validation_sgi(void)
 
 	return test_res;
 }
+
+/* Number of multicast SGIs taken by each CPU */
+static volatile unsigned int sgi_count[PLATFORM_CORE_COUNT];
+
+static event_t cpu_ready[PLATFORM_CORE_COUNT];
+
+static int sgi_count_handler(void *data)
+{
+	sgi_count[platform_get_core_pos(read_mpidr_el1())]++;
+
+	return 0;
+}
+
+static test_result_t multicast_sgi_cpu(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+
+	tftf_irq_register_handler(IRQ_NS_SGI_0, sgi_count_handler);
+	tftf_irq_enable(IRQ_NS_SGI_0, GIC_HIGHEST_NS_PRIORITY);
+
+	tftf_send_event(&cpu_ready[core_pos]);
+
+	/* Wait for the broadcast and the multicast SGIs */
+	while (sgi_count[core_pos] < 2)
+		continue;
+
+	tftf_irq_disable(IRQ_NS_SGI_0);
+	tftf_irq_unregister_handler(IRQ_NS_SGI_0);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Test the SGIs sent to several CPUs at once
+ *
+ * 1) Power on all the CPUs and register an IRQ handler for SGI 0 on each of
+ *    them.
+ * 2) Send SGI 0 to all the CPUs but the lead CPU with
+ *    tftf_send_sgi_all_but_self().
+ * 3) Send SGI 0 to all the CPUs with tftf_send_sgi_mask().
+ * 4) Check that the lead CPU took the SGI once and the others twice.
+ */
+test_result_t test_validation_sgi_multicast(void)
+{
+	unsigned int lead_pos = platform_get_core_pos(read_mpidr_el1());
+	u_register_t lead_mpid, target_mpid;
+	test_result_t test_res = TEST_RESULT_SUCCESS;
+	unsigned int core_pos, expected;
+	core_mask_t mask;
+	int cpu_node;
+	int ret;
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+
+	for (unsigned int i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		tftf_init_event(&cpu_ready[i]);
+		sgi_count[i] = 0;
+	}
+
+	ret = tftf_irq_register_handler(IRQ_NS_SGI_0, sgi_count_handler);
+	if (ret != 0) {
+		tftf_testcase_printf("Failed to register IRQ %u (%d)",
+				IRQ_NS_SGI_0, ret);
+		return TEST_RESULT_FAIL;
+	}
+	tftf_irq_enable(IRQ_NS_SGI_0, GIC_HIGHEST_NS_PRIORITY);
+
+	core_mask_clear(&mask);
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		core_pos = platform_get_core_pos(target_mpid);
+		core_mask_set(&mask, core_pos);
+
+		if (lead_mpid == target_mpid)
+			continue;
+
+		ret = tftf_cpu_on(target_mpid, (uintptr_t)multicast_sgi_cpu, 0);
+		if (ret != PSCI_E_SUCCESS) {
+			tftf_testcase_printf("Failed to power on CPU 0x%llx (%d)\n",
+				(unsigned long long)target_mpid, ret);
+			tftf_irq_disable(IRQ_NS_SGI_0);
+			tftf_irq_unregister_handler(IRQ_NS_SGI_0);
+			return TEST_RESULT_FAIL;
+		}
+		tftf_wait_for_event(&cpu_ready[core_pos]);
+	}
+
+	tftf_send_sgi_all_but_self(IRQ_NS_SGI_0);
+	tftf_send_sgi_mask(IRQ_NS_SGI_0, &mask);
+
+	/* Wait for the lead CPU to take the SGI and the others to power off */
+	while (sgi_count[lead_pos] == 0)
+		continue;
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
+			PSCI_STATE_OFF)
+			continue;
+	}
+
+	tftf_irq_disable(IRQ_NS_SGI_0);
+	tftf_irq_unregister_handler(IRQ_NS_SGI_0);
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		core_pos = platform_get_core_pos(target_mpid);
+		expected = (core_pos == lead_pos) ? 1 : 2;
+
+		if (sgi_count[core_pos] != expected) {
+			tftf_testcase_printf("CPU 0x%llx took %u SGIs, expected %u\n",
+				(unsigned long long)target_mpid,
+				sgi_count[core_pos], expected);
+			test_res = TEST_RESULT_FAIL;
+		}
+	}
+
+	return test_res;
+}
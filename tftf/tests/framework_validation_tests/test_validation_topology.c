@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <tftf_lib.h>
+
+/*
+ * @Test_Aim@ Check the topology lookup tables against the power domain tree
+ *
+ * For every present CPU, check that the MPIDR lookup returns its core position
+ * and that its cluster is its parent power domain at level 1. Also check that
+ * the cluster iterator visits every present CPU exactly once, and that an MPIDR
+ * which is not in the topology is not found.
+ */
+test_result_t test_validation_topology(void)
+{
+	unsigned int cpu_node, cluster_node, cpu_in_cluster;
+	unsigned int mpid, core_pos, cpus_count = 0, cluster_cpus_count = 0;
+
+	for_each_cpu(cpu_node) {
+		mpid = tftf_get_mpidr_from_node(cpu_node);
+		core_pos = platform_get_core_pos(mpid);
+		cpus_count++;
+
+		if (tftf_get_core_pos_from_mpidr(mpid) != core_pos) {
+			tftf_testcase_printf("Wrong core position for MPIDR 0x%x\n",
+					     mpid);
+			return TEST_RESULT_FAIL;
+		}
+
+		cluster_node = tftf_core_pos_to_cluster_node(core_pos);
+		if (cluster_node != tftf_get_parent_node_from_mpidr(mpid, 1)) {
+			tftf_testcase_printf("Wrong cluster for MPIDR 0x%x\n",
+					     mpid);
+			return TEST_RESULT_FAIL;
+		}
+
+		for_each_cpu_in_cluster(cpu_in_cluster, core_pos) {
+			if (tftf_get_parent_node_from_mpidr(
+				tftf_get_mpidr_from_node(cpu_in_cluster), 1)
+				!= cluster_node) {
+				tftf_testcase_printf("CPU node %u is not in the cluster of MPIDR 0x%x\n",
+						     cpu_in_cluster, mpid);
+				return TEST_RESULT_FAIL;
+			}
+
+			/* Count each CPU once, from its own cluster walk */
+			if (cpu_in_cluster == cpu_node)
+				cluster_cpus_count++;
+		}
+	}
+
+	if ((cpus_count != tftf_get_total_cpus_count()) ||
+	    (cluster_cpus_count != cpus_count)) {
+		tftf_testcase_printf("Found %u CPUs, %u in clusters, expected %u\n",
+				     cpus_count, cluster_cpus_count,
+				     tftf_get_total_cpus_count());
+		return TEST_RESULT_FAIL;
+	}
+
+	if (tftf_get_core_pos_from_mpidr(INVALID_MPID) != PWR_DOMAIN_INIT) {
+		tftf_testcase_printf("Found a core position for INVALID_MPID\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
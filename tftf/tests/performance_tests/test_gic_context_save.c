@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains a test that measures the time spent saving and restoring
+ * the global GIC context, with the current implementation and with the legacy
+ * one, which saves and restores every register whatever its content.
+ */
+
+#include <arch_helpers.h>
+#include <debug.h>
+#include <drivers/arm/arm_gic.h>
+#include <drivers/arm/gic_common.h>
+#include <drivers/arm/gic_v2.h>
+#include <drivers/arm/gic_v3.h>
+#include <mmio.h>
+#include <platform_def.h>
+#include <power_management.h>
+#include <psci.h>
+#include <stdbool.h>
+#include <tftf_lib.h>
+#include <timer.h>
+#include <utils_def.h>
+
+#define ITERATIONS_CNT		10
+
+/* Same bound on the number of SPIs as the one of the drivers */
+#define NUM_SPI_CTX		(PLAT_MAX_SPI_OFFSET_ID + 1)
+
+/*
+ * Context saved by the legacy implementation, for the SGIs and PPIs of the
+ * calling CPU and for the SPIs. `all` marks every interrupt as configured so
+ * that no register is skipped.
+ */
+static struct {
+	uint32_t all[GIC_CTX_ISENABLER_NUM(NUM_SPI_CTX)];
+	uint32_t pcpu_isenabler[GIC_CTX_ISENABLER_NUM(NUM_PCPU_INTR)];
+	uint32_t pcpu_ipriorityr[GIC_CTX_IPRIORITYR_NUM(NUM_PCPU_INTR)];
+	uint32_t pcpu_icfgr[GIC_CTX_ICFGR_NUM(NUM_PCPU_INTR)];
+	uint32_t spi_isenabler[GIC_CTX_ISENABLER_NUM(NUM_SPI_CTX)];
+	uint32_t spi_ipriorityr[GIC_CTX_IPRIORITYR_NUM(NUM_SPI_CTX)];
+	uint32_t spi_icfgr[GIC_CTX_ICFGR_NUM(NUM_SPI_CTX)];
+	/* GICD_IROUTER on GICv3, GICD_ITARGETSR on GICv2 */
+	uint64_t spi_route[GIC_CTX_ISENABLER_NUM(NUM_SPI_CTX) * 32];
+	unsigned int num_spi;
+} legacy_ctx;
+
+static volatile unsigned int wakeup_irq_rcvd;
+
+static inline unsigned long long cycles_to_ns(unsigned long long cycles)
+{
+	unsigned long long freq = read_cntfrq_el0();
+	return (cycles * 1000000000) / freq;
+}
+
+static int suspend_wakeup_handler(void *data)
+{
+	wakeup_irq_rcvd = 1;
+
+	return 0;
+}
+
+static void legacy_save_context_global(void)
+{
+	uintptr_t gicd_base = arm_gic_get_dist_base();
+	unsigned int i;
+
+	legacy_ctx.num_spi = GICD_TYPER_NUM_INTR(gicd_read_typer(gicd_base)) -
+			     MIN_SPI_ID;
+	if (legacy_ctx.num_spi > NUM_SPI_CTX)
+		legacy_ctx.num_spi = NUM_SPI_CTX;
+
+	gicd_save_intr_ctx(arm_gic_get_sgi_ppi_base(), MIN_SGI_ID,
+			   NUM_PCPU_INTR, legacy_ctx.all,
+			   legacy_ctx.pcpu_isenabler,
+			   legacy_ctx.pcpu_ipriorityr, legacy_ctx.pcpu_icfgr);
+	gicd_save_intr_ctx(gicd_base, MIN_SPI_ID, legacy_ctx.num_spi,
+			   legacy_ctx.all, legacy_ctx.spi_isenabler,
+			   legacy_ctx.spi_ipriorityr, legacy_ctx.spi_icfgr);
+
+	if (is_gicv3_mode()) {
+		for (i = 0; i < legacy_ctx.num_spi; i++)
+			legacy_ctx.spi_route[i] = mmio_read_64(gicd_base +
+				GICD_IROUTER + ((MIN_SPI_ID + i) << 3));
+	} else {
+		for (i = 0; i < legacy_ctx.num_spi; i += 4)
+			legacy_ctx.spi_route[i >> 2] = mmio_read_32(gicd_base +
+				GICD_ITARGETSR + MIN_SPI_ID + i);
+	}
+}
+
+static void legacy_restore_context_global(void)
+{
+	uintptr_t gicd_base = arm_gic_get_dist_base();
+	unsigned int i;
+
+	if (is_gicv3_mode()) {
+		for (i = 0; i < legacy_ctx.num_spi; i++)
+			mmio_write_64(gicd_base + GICD_IROUTER +
+				      ((MIN_SPI_ID + i) << 3),
+				      legacy_ctx.spi_route[i]);
+	} else {
+		for (i = 0; i < legacy_ctx.num_spi; i += 4)
+			mmio_write_32(gicd_base + GICD_ITARGETSR +
+				      MIN_SPI_ID + i,
+				      legacy_ctx.spi_route[i >> 2]);
+	}
+
+	gicd_restore_intr_ctx(arm_gic_get_sgi_ppi_base(), MIN_SGI_ID,
+			      NUM_PCPU_INTR, legacy_ctx.all,
+			      legacy_ctx.pcpu_isenabler,
+			      legacy_ctx.pcpu_ipriorityr,
+			      legacy_ctx.pcpu_icfgr);
+	gicd_restore_intr_ctx(gicd_base, MIN_SPI_ID, legacy_ctx.num_spi,
+			      legacy_ctx.all, legacy_ctx.spi_isenabler,
+			      legacy_ctx.spi_ipriorityr, legacy_ctx.spi_icfgr);
+}
+
+/*
+ * Save and restore the global GIC context ITERATIONS_CNT times, with IRQs
+ * masked, and add up the time spent in each step. Both implementations save
+ * the SGI and PPI context of the calling CPU and the SPI context, routes
+ * included, so they are measured over the same register set.
+ */
+static void measure_ctx(bool legacy, unsigned long long *save,
+			unsigned long long *restore)
+{
+	uint64_t start;
+	unsigned int i;
+
+	disable_irq();
+
+	for (i = 0; i < ITERATIONS_CNT; i++) {
+		start = syscounter_read();
+		if (legacy)
+			legacy_save_context_global();
+		else
+			arm_gic_save_context_global();
+		*save += syscounter_read() - start;
+
+		start = syscounter_read();
+		if (legacy)
+			legacy_restore_context_global();
+		else
+			arm_gic_restore_context_global();
+		*restore += syscounter_read() - start;
+	}
+
+	enable_irq();
+}
+
+/*
+ * Suspend the system ITERATIONS_CNT times and add up the time the framework
+ * spends saving and restoring the global GIC context on the way.
+ */
+static int measure_sys_suspend(unsigned long long *save,
+			       unsigned long long *restore)
+{
+	uint64_t save_ticks, restore_ticks;
+	unsigned int i;
+	int timer_rc, suspend_rc;
+	int ret;
+
+	for (i = 0; i < ITERATIONS_CNT; i++) {
+		wakeup_irq_rcvd = 0;
+
+		ret = tftf_program_timer_and_sys_suspend(
+				PLAT_SUSPEND_ENTRY_TIME, &timer_rc,
+				&suspend_rc);
+		if (ret != 0) {
+			tftf_testcase_printf("System suspend failed: timer %d,"
+					     " PSCI %d\n", timer_rc,
+					     suspend_rc);
+			return ret;
+		}
+
+		while (wakeup_irq_rcvd == 0)
+			;
+
+		tftf_get_system_ctx_ticks(&save_ticks, &restore_ticks);
+		*save += save_ticks;
+		*restore += restore_ticks;
+	}
+
+	return 0;
+}
+
+/*
+ * @Test_Aim@ Measure the time taken to save and restore the global GIC context
+ * with the current implementation and with the legacy one, and the time the
+ * system suspend path spends on it with the current implementation.
+ */
+test_result_t test_gic_context_save_latency(void)
+{
+	unsigned long long legacy_save = 0, legacy_restore = 0;
+	unsigned long long save = 0, restore = 0;
+	unsigned long long suspend_save = 0, suspend_restore = 0;
+	unsigned int i;
+	test_result_t result = TEST_RESULT_SUCCESS;
+
+	if (tftf_get_psci_feature_info(SMC_PSCI_SYSTEM_SUSPEND) ==
+	    PSCI_E_NOT_SUPPORTED) {
+		tftf_testcase_printf("System suspend is not supported "
+				     "by the EL3 firmware\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(legacy_ctx.all); i++)
+		legacy_ctx.all[i] = ~0U;
+
+	measure_ctx(true, &legacy_save, &legacy_restore);
+	measure_ctx(false, &save, &restore);
+
+	tftf_timer_register_handler(suspend_wakeup_handler);
+
+	if (measure_sys_suspend(&suspend_save, &suspend_restore) != 0)
+		result = TEST_RESULT_FAIL;
+
+	tftf_timer_unregister_handler();
+	tftf_cancel_timer();
+
+	if (result != TEST_RESULT_SUCCESS)
+		return result;
+
+	tftf_testcase_printf("Legacy global GIC context save: %llu ns\n",
+			     cycles_to_ns(legacy_save / ITERATIONS_CNT));
+	tftf_testcase_printf("Legacy global GIC context restore: %llu ns\n",
+			     cycles_to_ns(legacy_restore / ITERATIONS_CNT));
+	tftf_testcase_printf("Global GIC context save: %llu ns\n",
+			     cycles_to_ns(save / ITERATIONS_CNT));
+	tftf_testcase_printf("Global GIC context restore: %llu ns\n",
+			     cycles_to_ns(restore / ITERATIONS_CNT));
+	tftf_testcase_printf("System suspend GIC context save: %llu ns\n",
+			     cycles_to_ns(suspend_save / ITERATIONS_CNT));
+	tftf_testcase_printf("System suspend GIC context restore: %llu ns\n",
+			     cycles_to_ns(suspend_restore / ITERATIONS_CNT));
+
+	return result;
+}
@@ -0,0 +1,523 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure the latency of interrupt delivery,
+ * from the interrupt being generated to the entry of the IRQ dispatcher on the
+ * target CPU:
+ *  - SGIs sent by each CPU to each CPU, itself included;
+ *  - the EL2 physical timer PPI of each CPU;
+ *  - an SPI made pending by each CPU and routed to each CPU.
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <drivers/arm/arm_gic.h>
+#include <drivers/arm/gic_common.h>
+#include <drivers/arm/private_timer.h>
+#include <events.h>
+#include <irq.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <power_management.h>
+#include <psci.h>
+#include <sgi.h>
+#include <stdio.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+#include <utils_def.h>
+
+#define TEST_SGI_ID		IRQ_NS_SGI_0
+#define TEST_SPI_ID		(MIN_SPI_ID + 2)
+
+/* Number of samples taken for each source and target CPU pair */
+#define ITERATIONS_CNT		100
+
+/* Number of samples taken by the timer test on each CPU (1 ms each) */
+#define PPI_ITERATIONS_CNT	100
+
+/* Values of source_pos when no CPU is sending interrupts */
+#define SOURCE_IDLE		PLATFORM_CORE_COUNT
+#define SOURCES_DONE		(PLATFORM_CORE_COUNT + 1)
+
+/* Per-CPU bookkeeping, updated by the IRQ handler of that CPU. */
+typedef struct {
+	/* System counter value on entry to the IRQ dispatcher */
+	volatile uint64_t entry_ts;
+	/* Number of times the handler ran */
+	volatile unsigned int count;
+} __aligned(CACHE_WRITEBACK_GRANULE) irq_perf_cpu_data_t;
+
+static irq_perf_cpu_data_t cpu_data[PLATFORM_CORE_COUNT];
+
+static event_t cpu_ready[PLATFORM_CORE_COUNT];
+
+/* Interrupt measured by the matrix tests */
+static unsigned int test_irq;
+
+/* Position of the CPU sending the interrupts, or one of the values above */
+static volatile unsigned int source_pos;
+
+/* Set by a non-lead CPU that failed to set up the interrupt */
+static volatile int cpu_setup_failed;
+
+struct latency_stats {
+	unsigned long long min;
+	unsigned long long max;
+	unsigned long long sum;
+	unsigned int count;
+};
+
+/* Latencies of each source (first index) and target CPU pair */
+static struct latency_stats latency_matrix[PLATFORM_CORE_COUNT][PLATFORM_CORE_COUNT];
+
+/* Latencies of the timer PPI of each CPU */
+static struct latency_stats ppi_latency[PLATFORM_CORE_COUNT];
+
+static inline unsigned long long cycles_to_ns(unsigned long long cycles)
+{
+	unsigned long long freq = read_cntfrq_el0();
+	return (cycles * 1000000000) / freq;
+}
+
+static void latency_stats_init(struct latency_stats *stats)
+{
+	stats->min = UINT64_MAX;
+	stats->max = 0;
+	stats->sum = 0;
+	stats->count = 0;
+}
+
+static void latency_stats_add(struct latency_stats *stats,
+			      unsigned long long cycles)
+{
+	stats->min = MIN(stats->min, cycles);
+	stats->max = MAX(stats->max, cycles);
+	stats->sum += cycles;
+	stats->count++;
+}
+
+static void latency_stats_merge(struct latency_stats *stats,
+				const struct latency_stats *other)
+{
+	stats->min = MIN(stats->min, other->min);
+	stats->max = MAX(stats->max, other->max);
+	stats->sum += other->sum;
+	stats->count += other->count;
+}
+
+static void print_latency(const char *what, const struct latency_stats *stats)
+{
+	if (stats->count == 0)
+		return;
+
+	tftf_testcase_printf("%s: %llu ns (ranging from %llu to %llu)\n", what,
+		cycles_to_ns(stats->sum / stats->count),
+		cycles_to_ns(stats->min), cycles_to_ns(stats->max));
+}
+
+static int irq_perf_handler(void *data)
+{
+	irq_perf_cpu_data_t *cpu = &cpu_data[platform_get_core_pos(
+						read_mpidr_el1())];
+
+	cpu->entry_ts = tftf_irq_get_entry_ticks();
+	/* Publish the timestamp before the CPU waiting on the count sees it */
+	dmbish();
+	cpu->count++;
+
+	return 0;
+}
+
+static int timer_perf_handler(void *data)
+{
+	private_timer_stop();
+
+	return irq_perf_handler(data);
+}
+
+/*
+ * Trigger test_irq ITERATIONS_CNT times on the CPU at position target_pos,
+ * waiting each time for the target to take it, and record the time from the
+ * trigger to the entry of the IRQ dispatcher of the target.
+ */
+static void measure_target(unsigned int target_pos, struct latency_stats *stats)
+{
+	irq_perf_cpu_data_t *target = &cpu_data[target_pos];
+	unsigned long long send_ts;
+	unsigned int count;
+
+	if (!IS_SGI(test_irq))
+		arm_gic_set_intr_target(test_irq, target_pos);
+
+	for (unsigned int i = 0; i < ITERATIONS_CNT; ++i) {
+		count = target->count;
+
+		send_ts = syscounter_read();
+		if (IS_SGI(test_irq))
+			tftf_send_sgi(test_irq, target_pos);
+		else
+			arm_gic_set_intr_pending(test_irq);
+
+		while (target->count == count)
+			continue;
+		dmbish();
+
+		latency_stats_add(stats, target->entry_ts - send_ts);
+	}
+}
+
+/* Measure the latencies from the calling CPU to every CPU */
+static void measure_source(void)
+{
+	unsigned int pos = platform_get_core_pos(read_mpidr_el1());
+	unsigned int target_pos;
+	int cpu_node;
+
+	for_each_cpu(cpu_node) {
+		target_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+		measure_target(target_pos, &latency_matrix[pos][target_pos]);
+	}
+}
+
+/*
+ * Per-CPU setup of the matrix tests. The handler of an SPI is common to all
+ * CPUs so only the lead CPU registers it.
+ */
+static int matrix_cpu_setup(void)
+{
+	if (!IS_SGI(test_irq))
+		return 0;
+
+	if (tftf_irq_register_handler(test_irq, irq_perf_handler) != 0)
+		return -1;
+
+	tftf_irq_enable(test_irq, GIC_HIGHEST_NS_PRIORITY);
+	return 0;
+}
+
+static void matrix_cpu_teardown(void)
+{
+	if (!IS_SGI(test_irq))
+		return;
+
+	tftf_irq_disable(test_irq);
+	tftf_irq_unregister_handler(test_irq);
+}
+
+/*
+ * Entry point of the non-lead CPUs in the matrix tests. They take interrupts
+ * in a busy loop, so that the latency does not include the exit from a low
+ * power state, and send interrupts to all the CPUs when it is their turn.
+ */
+static test_result_t matrix_cpu(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+
+	if (matrix_cpu_setup() != 0) {
+		cpu_setup_failed = 1;
+		tftf_send_event(&cpu_ready[core_pos]);
+		return TEST_RESULT_FAIL;
+	}
+
+	tftf_send_event(&cpu_ready[core_pos]);
+
+	while (source_pos != SOURCES_DONE) {
+		if (source_pos == core_pos) {
+			measure_source();
+			dmbish();
+			source_pos = SOURCE_IDLE;
+		}
+	}
+
+	matrix_cpu_teardown();
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static void print_latency_matrix(const char *name)
+{
+	struct latency_stats self, others;
+	char row[8 + (PLATFORM_CORE_COUNT * 9)];
+	unsigned int src_pos, dst_pos;
+	int src_node, dst_node;
+	size_t len;
+
+	latency_stats_init(&self);
+	latency_stats_init(&others);
+
+	tftf_testcase_printf("%s latency with GICv%u, average in ns, from the CPU of each row to the CPU of each column:\n",
+		name, is_gicv3_mode() ? 3U : 2U);
+
+	len = snprintf(row, sizeof(row), "      ");
+	for_each_cpu(dst_node) {
+		dst_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(dst_node));
+		len += snprintf(row + len, sizeof(row) - len, " %8u",
+				dst_pos);
+	}
+	tftf_testcase_printf("%s\n", row);
+
+	for_each_cpu(src_node) {
+		src_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(src_node));
+		len = snprintf(row, sizeof(row), "%4u: ", src_pos);
+
+		for_each_cpu(dst_node) {
+			struct latency_stats *stats;
+
+			dst_pos = platform_get_core_pos(
+					tftf_get_mpidr_from_node(dst_node));
+			stats = &latency_matrix[src_pos][dst_pos];
+
+			len += snprintf(row + len, sizeof(row) - len, " %8llu",
+				cycles_to_ns(stats->sum / stats->count));
+
+			latency_stats_merge((src_pos == dst_pos) ?
+					    &self : &others, stats);
+		}
+		tftf_testcase_printf("%s\n", row);
+	}
+
+	print_latency("To the sending CPU", &self);
+	print_latency("To another CPU", &others);
+}
+
+/*
+ * Measure the latency of test_irq from every CPU to every CPU. The CPUs take
+ * turns at sending interrupts while the others wait for them.
+ */
+static test_result_t measure_latency_matrix(unsigned int irq_num,
+					    const char *name)
+{
+	unsigned int lead_pos = platform_get_core_pos(read_mpidr_el1());
+	u_register_t lead_mpid, target_mpid;
+	test_result_t ret = TEST_RESULT_SUCCESS;
+	unsigned int core_pos;
+	int cpu_node;
+	int psci_ret;
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+
+	for (unsigned int i = 0; i < PLATFORM_CORE_COUNT; i++) {
+		tftf_init_event(&cpu_ready[i]);
+		for (unsigned int j = 0; j < PLATFORM_CORE_COUNT; j++)
+			latency_stats_init(&latency_matrix[i][j]);
+	}
+
+	test_irq = irq_num;
+	source_pos = SOURCE_IDLE;
+	cpu_setup_failed = 0;
+
+	if (IS_SGI(test_irq)) {
+		if (matrix_cpu_setup() != 0)
+			return TEST_RESULT_FAIL;
+	} else {
+		if (tftf_irq_register_handler(test_irq, irq_perf_handler) != 0)
+			return TEST_RESULT_FAIL;
+		tftf_irq_enable(test_irq, GIC_HIGHEST_NS_PRIORITY);
+	}
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+
+		psci_ret = tftf_cpu_on(target_mpid, (uintptr_t)matrix_cpu, 0);
+		if (psci_ret != PSCI_E_SUCCESS) {
+			ERROR("CPU ON failed for 0x%llx\n",
+				(unsigned long long)target_mpid);
+			ret = TEST_RESULT_FAIL;
+			break;
+		}
+
+		core_pos = platform_get_core_pos(target_mpid);
+		tftf_wait_for_event(&cpu_ready[core_pos]);
+
+		if (cpu_setup_failed != 0) {
+			tftf_testcase_printf("CPU 0x%llx failed to set up IRQ #%u\n",
+				(unsigned long long)target_mpid, test_irq);
+			ret = TEST_RESULT_FAIL;
+			break;
+		}
+	}
+
+	if (ret == TEST_RESULT_SUCCESS) {
+		for_each_cpu(cpu_node) {
+			core_pos = platform_get_core_pos(
+					tftf_get_mpidr_from_node(cpu_node));
+
+			if (core_pos == lead_pos) {
+				measure_source();
+				continue;
+			}
+
+			source_pos = core_pos;
+			while (source_pos != SOURCE_IDLE)
+				continue;
+			dmbish();
+		}
+	}
+
+	source_pos = SOURCES_DONE;
+
+	/* Wait for all the other CPUs to be done */
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
+			PSCI_STATE_OFF)
+			continue;
+	}
+
+	if (IS_SGI(test_irq)) {
+		matrix_cpu_teardown();
+	} else {
+		tftf_irq_disable(test_irq);
+		tftf_irq_unregister_handler(test_irq);
+	}
+
+	if (ret == TEST_RESULT_SUCCESS)
+		print_latency_matrix(name);
+
+	return ret;
+}
+
+/*
+ * @Test_Aim@ Measure the latency from tftf_send_sgi() to the entry of the IRQ
+ * dispatcher on the target CPU, for every source and target CPU pair. The
+ * matrix of the average latencies is part of the test output, along with the
+ * latencies of SGIs sent to the sending CPU and to other CPUs.
+ * This test always succeeds if all the CPUs could be powered on.
+ */
+test_result_t test_irq_sgi_latency(void)
+{
+	return measure_latency_matrix(TEST_SGI_ID, "SGI");
+}
+
+/*
+ * @Test_Aim@ Measure the latency from an SPI being made pending at the GIC
+ * Distributor to the entry of the IRQ dispatcher on the CPU it is routed to,
+ * for every source and target CPU pair.
+ * This test always succeeds if all the CPUs could be powered on.
+ */
+test_result_t test_irq_spi_latency(void)
+{
+	return measure_latency_matrix(TEST_SPI_ID, "SPI");
+}
+
+/*
+ * Measure the latency of the timer PPI of the calling CPU, from the system
+ * counter reaching the compare value to the entry of the IRQ dispatcher.
+ */
+static test_result_t measure_timer_ppi(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	irq_perf_cpu_data_t *cpu = &cpu_data[core_pos];
+	unsigned long long fire_ts;
+	unsigned int count;
+
+	latency_stats_init(&ppi_latency[core_pos]);
+
+	if (tftf_irq_register_handler(IRQ_PCPU_HP_TIMER,
+				      timer_perf_handler) != 0)
+		return TEST_RESULT_FAIL;
+	tftf_irq_enable(IRQ_PCPU_HP_TIMER, GIC_HIGHEST_NS_PRIORITY);
+
+	for (unsigned int i = 0; i < PPI_ITERATIONS_CNT; ++i) {
+		count = cpu->count;
+
+		private_timer_start(1);
+		fire_ts = read_cnthp_cval_el2();
+
+		while (cpu->count == count)
+			continue;
+		dmbish();
+
+		latency_stats_add(&ppi_latency[core_pos],
+				  cpu->entry_ts - fire_ts);
+	}
+
+	tftf_irq_disable(IRQ_PCPU_HP_TIMER);
+	tftf_irq_unregister_handler(IRQ_PCPU_HP_TIMER);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Measure the latency from the EL2 physical timer of each CPU
+ * firing to the entry of the IRQ dispatcher. The CPUs are measured one after
+ * the other so that they do not disturb each other. The latencies of each CPU
+ * are part of the test output.
+ * This test is skipped if the TFTF does not run at EL2.
+ */
+test_result_t test_irq_ppi_latency(void)
+{
+	unsigned int lead_pos = platform_get_core_pos(read_mpidr_el1());
+	u_register_t lead_mpid, target_mpid;
+	struct latency_stats all;
+	unsigned int core_pos;
+	char what[32];
+	int cpu_node;
+	int psci_ret;
+
+	if (!IS_IN_EL2()) {
+		tftf_testcase_printf("The EL2 physical timer is not accessible\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+
+	if (measure_timer_ppi() != TEST_RESULT_SUCCESS)
+		return TEST_RESULT_FAIL;
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+
+		psci_ret = tftf_cpu_on(target_mpid,
+				(uintptr_t)measure_timer_ppi, 0);
+		if (psci_ret != PSCI_E_SUCCESS) {
+			ERROR("CPU ON failed for 0x%llx\n",
+				(unsigned long long)target_mpid);
+			return TEST_RESULT_FAIL;
+		}
+
+		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
+			PSCI_STATE_OFF)
+			continue;
+	}
+
+	latency_stats_init(&all);
+
+	tftf_testcase_printf("Timer PPI latency with GICv%u:\n",
+		is_gicv3_mode() ? 3U : 2U);
+
+	for_each_cpu(cpu_node) {
+		core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+
+		if (ppi_latency[core_pos].count != PPI_ITERATIONS_CNT) {
+			tftf_testcase_printf("CPU %u took %u timer interrupts\n",
+				core_pos, ppi_latency[core_pos].count);
+			return TEST_RESULT_FAIL;
+		}
+
+		snprintf(what, sizeof(what), "CPU %u%s", core_pos,
+			 (core_pos == lead_pos) ? " (lead)" : "");
+		print_latency(what, &ppi_latency[core_pos]);
+		latency_stats_merge(&all, &ppi_latency[core_pos]);
+	}
+
+	print_latency("All CPUs", &all);
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that route LPIs through the GICv3 ITS and generate
+ * them by writing to GITS_TRANSLATER. Each CPU is given its own EventID,
+ * translated to its own LPI that is delivered to it. The tests measure:
+ *  - the latency from the write to GITS_TRANSLATER to the entry of the IRQ
+ *    dispatcher, on each CPU in turn;
+ *  - the number of LPIs each Re-distributor takes per second when all the
+ *    CPUs generate their next LPI from the handler of the previous one.
+ */
+
+#include <arch_helpers.h>
+#include <cassert.h>
+#include <debug.h>
+#include <drivers/arm/arm_gic.h>
+#include <drivers/arm/gic_common.h>
+#include <drivers/arm/gic_v3_its.h>
+#include <events.h>
+#include <irq.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <power_management.h>
+#include <psci.h>
+#include <stdbool.h>
+#include <tftf_lib.h>
+#include <utils_def.h>
+
+/*
+ * DeviceID that the ITS gives to the writes of the cores to GITS_TRANSLATER.
+ * It is IMPLEMENTATION DEFINED: if no LPI is received the tests are skipped.
+ */
+#define TEST_DEVICE_ID		0
+
+#define LPI_PRIORITY		GIC_HIGHEST_NS_PRIORITY
+
+/* Number of samples taken on each CPU */
+#define ITERATIONS_CNT		100
+
+/* Duration of the LPI storm on each CPU */
+#define STORM_DURATION_MS	10
+
+/* Time given to an LPI to be delivered */
+#define LPI_TIMEOUT_MS		10
+
+/* Each CPU uses the EventID and the LPI number offset of its position */
+CASSERT(PLATFORM_CORE_COUNT <= MAX_LPI_NUM, assert_lpi_per_cpu);
+CASSERT(PLATFORM_CORE_COUNT <= (1U << ITS_EVENT_ID_BITS), assert_event_per_cpu);
+
+/* Per-CPU figures, written by each CPU for itself. */
+typedef struct {
+	/* Number of LPIs taken */
+	volatile unsigned int count;
+	/* Whether the handler generates the next LPI */
+	volatile unsigned int storm;
+	unsigned long long min;
+	unsigned long long max;
+	unsigned long long sum;
+	unsigned long long storm_lpis;
+	unsigned long long storm_ticks;
+	test_result_t result;
+} __aligned(CACHE_WRITEBACK_GRANULE) lpi_cpu_data_t;
+
+static lpi_cpu_data_t cpu_data[PLATFORM_CORE_COUNT];
+
+static event_t cpu_ready[PLATFORM_CORE_COUNT];
+static event_t start_storm;
+
+/* Position of the CPU that starts the storm */
+static unsigned int lead_pos;
+
+static inline unsigned long long cycles_to_ns(unsigned long long cycles)
+{
+	unsigned long long freq = read_cntfrq_el0();
+	return (cycles * 1000000000) / freq;
+}
+
+static inline unsigned long long ms_to_cycles(unsigned long long ms)
+{
+	return (read_cntfrq_el0() * ms) / 1000;
+}
+
+static int lpi_handler(void *data)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+
+	cpu_data[core_pos].count++;
+	if (cpu_data[core_pos].storm != 0U)
+		gicv3_its_translate(core_pos);
+
+	return 0;
+}
+
+/* Wait for the CPU to take an LPI after `count` LPIs */
+static int wait_for_lpi(unsigned int core_pos, unsigned int count,
+			uint64_t start)
+{
+	uint64_t timeout = ms_to_cycles(LPI_TIMEOUT_MS);
+
+	while (cpu_data[core_pos].count == count) {
+		if ((syscounter_read() - start) > timeout)
+			return -1;
+	}
+
+	return 0;
+}
+
+static void measure_latency(unsigned int core_pos)
+{
+	lpi_cpu_data_t *data = &cpu_data[core_pos];
+	unsigned long long cycles;
+	unsigned int i, count;
+	uint64_t start;
+
+	data->min = UINT64_MAX;
+	data->max = 0;
+	data->sum = 0;
+
+	for (i = 0; i < ITERATIONS_CNT; i++) {
+		count = data->count;
+		start = syscounter_read();
+		gicv3_its_translate(core_pos);
+
+		if (wait_for_lpi(core_pos, count, start) != 0) {
+			data->result = TEST_RESULT_SKIPPED;
+			return;
+		}
+
+		cycles = tftf_irq_get_entry_ticks() - start;
+		data->min = MIN(data->min, cycles);
+		data->max = MAX(data->max, cycles);
+		data->sum += cycles;
+	}
+}
+
+static void measure_storm(unsigned int core_pos)
+{
+	lpi_cpu_data_t *data = &cpu_data[core_pos];
+	unsigned int count = data->count;
+	uint64_t start, duration = ms_to_cycles(STORM_DURATION_MS);
+
+	data->storm = 1U;
+	start = syscounter_read();
+	gicv3_its_translate(core_pos);
+
+	if (wait_for_lpi(core_pos, count, start) != 0) {
+		data->storm = 0U;
+		data->result = TEST_RESULT_SKIPPED;
+		return;
+	}
+
+	while ((syscounter_read() - start) < duration)
+		continue;
+
+	data->storm = 0U;
+	data->storm_ticks = syscounter_read() - start;
+	data->storm_lpis = data->count - count;
+}
+
+/* Start the storm on all the CPUs once the other CPUs are ready */
+static void start_storm_all_cpus(void)
+{
+	unsigned int core_pos;
+	int cpu_node;
+
+	for_each_cpu(cpu_node) {
+		core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+		if (core_pos != lead_pos)
+			tftf_wait_for_event(&cpu_ready[core_pos]);
+	}
+
+	tftf_send_event_to(&start_storm, tftf_get_total_cpus_count() - 1U);
+}
+
+static void wait_for_storm_start(unsigned int core_pos)
+{
+	if (core_pos == lead_pos) {
+		start_storm_all_cpus();
+	} else {
+		tftf_send_event(&cpu_ready[core_pos]);
+		tftf_wait_for_event(&start_storm);
+	}
+}
+
+/*
+ * Route the LPI of the calling CPU to itself, then take the measurements.
+ * In the storm test, the CPUs wait for each other so that they all generate
+ * LPIs at the same time.
+ */
+static test_result_t lpi_cpu(bool storm)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	unsigned int lpi = MIN_LPI_ID + core_pos;
+	lpi_cpu_data_t *data = &cpu_data[core_pos];
+
+	data->result = TEST_RESULT_SUCCESS;
+
+	if ((gicv3_its_setup_local() != 0) ||
+	    (tftf_irq_register_handler(lpi, lpi_handler) != 0)) {
+		data->result = TEST_RESULT_FAIL;
+		goto ready;
+	}
+
+	if (gicv3_its_map_lpi(TEST_DEVICE_ID, core_pos, lpi, core_pos,
+			      LPI_PRIORITY) != 0) {
+		data->result = TEST_RESULT_FAIL;
+		goto unregister;
+	}
+
+	if (storm) {
+		wait_for_storm_start(core_pos);
+		measure_storm(core_pos);
+	} else {
+		measure_latency(core_pos);
+	}
+
+	if (gicv3_its_unmap_lpi(TEST_DEVICE_ID, core_pos, lpi) != 0)
+		data->result = TEST_RESULT_FAIL;
+
+unregister:
+	tftf_irq_unregister_handler(lpi);
+ready:
+	/* The other CPUs wait for this CPU even if the setup failed */
+	if (storm && (data->result == TEST_RESULT_FAIL))
+		wait_for_storm_start(core_pos);
+
+	return data->result;
+}
+
+static test_result_t lpi_latency_cpu(void)
+{
+	return lpi_cpu(false);
+}
+
+static test_result_t lpi_storm_cpu(void)
+{
+	return lpi_cpu(true);
+}
+
+static test_result_t its_setup(void)
+{
+	uintptr_t its_base = plat_get_gits_base();
+
+	if (!is_gicv3_mode() || (its_base == 0U)) {
+		tftf_testcase_printf("No GICv3 ITS\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	if ((gicv3_its_init(its_base) != 0) ||
+	    (gicv3_its_map_device(TEST_DEVICE_ID) != 0))
+		return TEST_RESULT_FAIL;
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static void wait_for_cpu_off(u_register_t mpid)
+{
+	while (tftf_psci_affinity_info(mpid, MPIDR_AFFLVL0) != PSCI_STATE_OFF)
+		continue;
+}
+
+/* Gather the results of the CPUs, the worst one wins */
+static test_result_t lpi_results(void)
+{
+	test_result_t ret = TEST_RESULT_SUCCESS;
+	unsigned int core_pos;
+	int cpu_node;
+
+	for_each_cpu(cpu_node) {
+		core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+
+		if (cpu_data[core_pos].result == TEST_RESULT_FAIL)
+			return TEST_RESULT_FAIL;
+		if (cpu_data[core_pos].result == TEST_RESULT_SKIPPED)
+			ret = TEST_RESULT_SKIPPED;
+	}
+
+	if (ret == TEST_RESULT_SKIPPED)
+		tftf_testcase_printf("LPI not received: DeviceID %u is not the one of the cores\n",
+				     TEST_DEVICE_ID);
+
+	return ret;
+}
+
+/*
+ * @Test_Aim@ Measure the latency of LPIs generated through GITS_TRANSLATER,
+ * on each CPU in turn.
+ */
+test_result_t test_its_lpi_latency(void)
+{
+	u_register_t lead_mpid, target_mpid;
+	unsigned long long sum = 0, min = UINT64_MAX, max = 0;
+	unsigned int core_pos;
+	test_result_t ret;
+	int cpu_node;
+	int psci_ret;
+
+	ret = its_setup();
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid) {
+			lpi_latency_cpu();
+			continue;
+		}
+
+		psci_ret = tftf_cpu_on(target_mpid,
+				(uintptr_t)lpi_latency_cpu, 0);
+		if (psci_ret != PSCI_E_SUCCESS) {
+			ERROR("CPU ON failed for 0x%llx\n",
+				(unsigned long long)target_mpid);
+			return TEST_RESULT_FAIL;
+		}
+
+		wait_for_cpu_off(target_mpid);
+	}
+
+	ret = lpi_results();
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		core_pos = platform_get_core_pos(target_mpid);
+
+		NOTICE("CPU 0x%llx: %llu ns (ranging from %llu to %llu)\n",
+			(unsigned long long)target_mpid,
+			cycles_to_ns(cpu_data[core_pos].sum / ITERATIONS_CNT),
+			cycles_to_ns(cpu_data[core_pos].min),
+			cycles_to_ns(cpu_data[core_pos].max));
+
+		sum += cpu_data[core_pos].sum;
+		min = MIN(min, cpu_data[core_pos].min);
+		max = MAX(max, cpu_data[core_pos].max);
+	}
+
+	tftf_testcase_printf("LPI latency: %llu ns (ranging from %llu to %llu)\n",
+		cycles_to_ns(sum / (ITERATIONS_CNT * tftf_get_total_cpus_count())),
+		cycles_to_ns(min), cycles_to_ns(max));
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Measure the sustained rate of LPIs taken by each Re-distributor
+ * while all the CPUs take a storm of LPIs.
+ */
+test_result_t test_its_lpi_storm(void)
+{
+	u_register_t lead_mpid, target_mpid;
+	unsigned long long rate, total = 0, min_rate = UINT64_MAX;
+	unsigned int core_pos, cpus_cnt;
+	test_result_t ret;
+	int cpu_node;
+	int psci_ret;
+
+	ret = its_setup();
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+	lead_pos = platform_get_core_pos(lead_mpid);
+	cpus_cnt = tftf_get_total_cpus_count();
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++)
+		tftf_init_event(&cpu_ready[i]);
+	tftf_init_event(&start_storm);
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+
+		psci_ret = tftf_cpu_on(target_mpid,
+				(uintptr_t)lpi_storm_cpu, 0);
+		if (psci_ret != PSCI_E_SUCCESS) {
+			ERROR("CPU ON failed for 0x%llx\n",
+				(unsigned long long)target_mpid);
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	/* The lead CPU starts the storm once it is ready itself */
+	lpi_storm_cpu();
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid != target_mpid)
+			wait_for_cpu_off(target_mpid);
+	}
+
+	ret = lpi_results();
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		core_pos = platform_get_core_pos(target_mpid);
+
+		rate = (cpu_data[core_pos].storm_lpis * read_cntfrq_el0()) /
+			cpu_data[core_pos].storm_ticks;
+		NOTICE("CPU 0x%llx: %llu LPIs/s\n",
+			(unsigned long long)target_mpid, rate);
+
+		total += rate;
+		min_rate = MIN(min_rate, rate);
+	}
+
+	tftf_testcase_printf("All %u cores: %llu LPIs/s (slowest core %llu LPIs/s)\n",
+		cpus_cnt, total, min_rate);
+
+	return TEST_RESULT_SUCCESS;
+}
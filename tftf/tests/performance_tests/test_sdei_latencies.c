@@ -0,0 +1,545 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure the cost of SDEI event dispatch:
+ *  - the latency from sdei_event_signal() or a bound interrupt firing to the
+ *    entry of the event handler;
+ *  - the latency from SDEI_EVENT_COMPLETE/SDEI_EVENT_COMPLETE_AND_RESUME to
+ *    the resumption of the interrupted context;
+ *  - the sustained number of events handled per second, on a single core and
+ *    on all cores at once.
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <drivers/arm/private_timer.h>
+#include <events.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <power_management.h>
+#include <psci.h>
+#include <sdei.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+#include <utils_def.h>
+
+#define EV_COOKIE		0xDEADBEEF
+
+/* Number of samples taken by the latency tests */
+#define ITERATIONS_CNT		1000
+
+/* Number of samples taken by the bound interrupt test (1 ms each) */
+#define INTR_ITERATIONS_CNT	100
+
+/* Number of events signalled by each core in the throughput test */
+#define THROUGHPUT_EVENTS_CNT	10000
+
+extern sdei_handler_t sdei_perf_entrypoint;
+extern sdei_handler_t sdei_perf_entrypoint_resume;
+
+/* Per-CPU bookkeeping, updated by the SDEI handler of that CPU. */
+typedef struct {
+	/* System counter value on handler entry */
+	volatile uint64_t entry_ts;
+	/* System counter value right before the event completion SMC */
+	volatile uint64_t complete_ts;
+	/* Number of times the handler ran */
+	volatile unsigned int count;
+	/* Throughput window of this CPU */
+	uint64_t start_ts;
+	uint64_t end_ts;
+} __aligned(CACHE_WRITEBACK_GRANULE) sdei_perf_cpu_data_t;
+
+static sdei_perf_cpu_data_t cpu_data[PLATFORM_CORE_COUNT];
+
+static event_t cpu_ready[PLATFORM_CORE_COUNT];
+static event_t start_signalling;
+
+/* True if the handler must stop the private timer. */
+static volatile int private_timer_source;
+
+/* Latency information in nano-seconds */
+struct latency_info {
+	unsigned long long min;
+	unsigned long long max;
+	unsigned long long avg;
+};
+
+struct latency_stats {
+	unsigned long long min;
+	unsigned long long max;
+	unsigned long long sum;
+	unsigned int count;
+};
+
+static inline unsigned long long cycles_to_ns(unsigned long long cycles)
+{
+	unsigned long long freq = read_cntfrq_el0();
+	return (cycles * 1000000000) / freq;
+}
+
+static void latency_stats_init(struct latency_stats *stats)
+{
+	stats->min = UINT64_MAX;
+	stats->max = 0;
+	stats->sum = 0;
+	stats->count = 0;
+}
+
+static void latency_stats_add(struct latency_stats *stats,
+			      unsigned long long cycles)
+{
+	stats->min = MIN(stats->min, cycles);
+	stats->max = MAX(stats->max, cycles);
+	stats->sum += cycles;
+	stats->count++;
+}
+
+static void latency_stats_get(const struct latency_stats *stats,
+			      struct latency_info *latency)
+{
+	assert(stats->count != 0);
+
+	latency->min = cycles_to_ns(stats->min);
+	latency->max = cycles_to_ns(stats->max);
+	latency->avg = cycles_to_ns(stats->sum / stats->count);
+}
+
+static void print_latency(const char *what, const struct latency_stats *stats)
+{
+	struct latency_info latency;
+
+	latency_stats_get(stats, &latency);
+	tftf_testcase_printf("%s: %llu ns (ranging from %llu to %llu)\n",
+		what, latency.avg, latency.min, latency.max);
+}
+
+/*
+ * C part of the SDEI handler, called from sdei_perf_entrypoint{_resume}()
+ * with the system counter value sampled on entry. Returns the address where
+ * the assembly code stores the timestamp taken right before completing the
+ * event.
+ */
+uint64_t *sdei_perf_handler(int ev, uint64_t arg, uint64_t entry_ts)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	sdei_perf_cpu_data_t *data = &cpu_data[core_pos];
+
+	assert(arg == EV_COOKIE);
+
+	if (private_timer_source != 0)
+		private_timer_stop();
+
+	data->entry_ts = entry_ts;
+	data->count++;
+
+	return (uint64_t *)&data->complete_ts;
+}
+
+/*
+ * Register, enable and unmask event `ev` for the calling CPU, with `ep` as
+ * handler.
+ */
+static int sdei_perf_event_setup(int ev, sdei_handler_t *ep)
+{
+	int64_t ret;
+
+	ret = sdei_event_register(ev, ep, EV_COOKIE, SDEI_REGF_RM_PE,
+				  read_mpidr_el1());
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI event register failed: 0x%llx\n",
+			(unsigned long long)ret);
+		return -1;
+	}
+
+	ret = sdei_event_enable(ev);
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI event enable failed: 0x%llx\n",
+			(unsigned long long)ret);
+		sdei_event_unregister(ev);
+		return -1;
+	}
+
+	ret = sdei_pe_unmask();
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI pe unmask failed: 0x%llx\n",
+			(unsigned long long)ret);
+		sdei_event_disable(ev);
+		sdei_event_unregister(ev);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void sdei_perf_event_teardown(int ev)
+{
+	sdei_pe_mask();
+	sdei_event_disable(ev);
+	sdei_event_unregister(ev);
+}
+
+static test_result_t check_sdei_version(void)
+{
+	int64_t ret;
+
+	ret = sdei_version();
+	if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
+		tftf_testcase_printf("Unexpected SDEI version: 0x%llx\n",
+			(unsigned long long)ret);
+		return TEST_RESULT_SKIPPED;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Signal event 0 to the calling CPU 'ITERATIONS_CNT' times and gather the
+ * signal-to-entry and completion-to-resume latencies.
+ */
+static test_result_t measure_signal_latency(sdei_handler_t *ep)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	sdei_perf_cpu_data_t *data = &cpu_data[core_pos];
+	struct latency_stats entry_stats, resume_stats;
+	unsigned long long signal_ts, resume_ts;
+	unsigned int count;
+	int64_t ret = 0;
+
+	latency_stats_init(&entry_stats);
+	latency_stats_init(&resume_stats);
+
+	disable_irq();
+
+	if (sdei_perf_event_setup(0, ep) != 0) {
+		enable_irq();
+		return TEST_RESULT_FAIL;
+	}
+
+	for (unsigned int i = 0; i < ITERATIONS_CNT; ++i) {
+		count = data->count;
+
+		signal_ts = read_cntpct_el0();
+		ret = sdei_event_signal(read_mpidr_el1());
+		if (ret < 0) {
+			tftf_testcase_printf("SDEI event signal failed: 0x%llx\n",
+				(unsigned long long)ret);
+			break;
+		}
+
+		/* The event might be dispatched after the SMC has returned */
+		while (data->count == count)
+			continue;
+		resume_ts = read_cntpct_el0();
+
+		latency_stats_add(&entry_stats, data->entry_ts - signal_ts);
+		latency_stats_add(&resume_stats, resume_ts - data->complete_ts);
+	}
+
+	sdei_perf_event_teardown(0);
+	enable_irq();
+
+	if (ret < 0)
+		return TEST_RESULT_FAIL;
+
+	print_latency("Signal to handler entry", &entry_stats);
+	print_latency("Completion to resume", &resume_stats);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Measure the latency from sdei_event_signal() to the entry of the
+ * handler of event 0 and the cost of SDEI_EVENT_COMPLETE, i.e. the time from
+ * the completion SMC to the resumption of the interrupted context.
+ * This test always succeeds if SDEI is supported.
+ */
+test_result_t test_sdei_signal_latency(void)
+{
+	test_result_t ret;
+
+	ret = check_sdei_version();
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	return measure_signal_latency(sdei_perf_entrypoint);
+}
+
+/*
+ * @Test_Aim@ Same as test_sdei_signal_latency(), but completing the event
+ * with SDEI_EVENT_COMPLETE_AND_RESUME.
+ * This test always succeeds if SDEI is supported.
+ */
+test_result_t test_sdei_complete_and_resume_latency(void)
+{
+	test_result_t ret;
+
+	ret = check_sdei_version();
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	return measure_signal_latency(sdei_perf_entrypoint_resume);
+}
+
+/*
+ * @Test_Aim@ Bind the per-CPU EL2 physical timer interrupt to an SDEI event
+ * and measure the latency from the timer firing (i.e. the system counter
+ * reaching the compare value) to the entry of the SDEI handler.
+ * This test always succeeds if SDEI is supported.
+ */
+test_result_t test_sdei_bound_intr_latency(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	sdei_perf_cpu_data_t *data = &cpu_data[core_pos];
+	struct sdei_intr_ctx intr_ctx;
+	struct latency_stats entry_stats;
+	unsigned long long fire_ts;
+	unsigned int count;
+	int64_t bound_ev;
+	test_result_t ret;
+
+	ret = check_sdei_version();
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	latency_stats_init(&entry_stats);
+
+	disable_irq();
+	bound_ev = sdei_interrupt_bind(IRQ_PCPU_HP_TIMER, &intr_ctx);
+	if (bound_ev < 0) {
+		tftf_testcase_printf("SDEI interrupt bind failed: %llx\n",
+			(unsigned long long)bound_ev);
+		enable_irq();
+		return TEST_RESULT_FAIL;
+	}
+
+	if (sdei_perf_event_setup(bound_ev, sdei_perf_entrypoint) != 0) {
+		sdei_interrupt_release(bound_ev, &intr_ctx);
+		enable_irq();
+		return TEST_RESULT_FAIL;
+	}
+
+	private_timer_source = 1;
+
+	for (unsigned int i = 0; i < INTR_ITERATIONS_CNT; ++i) {
+		count = data->count;
+
+		private_timer_start(1);
+		fire_ts = read_cnthp_cval_el2();
+
+		while (data->count == count)
+			continue;
+
+		latency_stats_add(&entry_stats, data->entry_ts - fire_ts);
+	}
+
+	private_timer_source = 0;
+
+	sdei_perf_event_teardown(bound_ev);
+	sdei_interrupt_release(bound_ev, &intr_ctx);
+	enable_irq();
+
+	print_latency("Timer fire to handler entry", &entry_stats);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Signal event 0 to the calling CPU 'THROUGHPUT_EVENTS_CNT' times, waiting
+ * for each event to be handled before signalling the next one, and record
+ * the time window it took.
+ */
+static test_result_t signal_events(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	sdei_perf_cpu_data_t *data = &cpu_data[core_pos];
+	unsigned int count;
+	int64_t ret = 0;
+
+	data->count = 0;
+	data->start_ts = read_cntpct_el0();
+
+	for (unsigned int i = 0; i < THROUGHPUT_EVENTS_CNT; ++i) {
+		count = data->count;
+
+		ret = sdei_event_signal(read_mpidr_el1());
+		if (ret < 0)
+			break;
+
+		while (data->count == count)
+			continue;
+	}
+
+	data->end_ts = read_cntpct_el0();
+
+	if (ret < 0) {
+		tftf_testcase_printf("SDEI event signal failed: 0x%llx\n",
+			(unsigned long long)ret);
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static unsigned long long events_per_sec(unsigned long long events,
+					 unsigned long long cycles)
+{
+	if (cycles == 0)
+		return 0;
+
+	return (events * read_cntfrq_el0()) / cycles;
+}
+
+static test_result_t signal_throughput_cpu(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	test_result_t ret;
+
+	disable_irq();
+
+	if (sdei_perf_event_setup(0, sdei_perf_entrypoint) != 0) {
+		enable_irq();
+		tftf_send_event(&cpu_ready[core_pos]);
+		return TEST_RESULT_FAIL;
+	}
+
+	tftf_send_event(&cpu_ready[core_pos]);
+	tftf_wait_for_event(&start_signalling);
+
+	ret = signal_events();
+
+	sdei_perf_event_teardown(0);
+	enable_irq();
+
+	return ret;
+}
+
+/*
+ * @Test_Aim@ Measure the sustained number of SDEI events handled per second,
+ * first on the lead CPU alone, then on all CPUs signalling themselves at the
+ * same time. The per-CPU rates are printed on the console, the lead CPU rate,
+ * the aggregate rate and the rate of the slowest CPU are part of the test
+ * output.
+ */
+test_result_t test_sdei_signal_throughput(void)
+{
+	unsigned int lead_pos = platform_get_core_pos(read_mpidr_el1());
+	u_register_t lead_mpid, target_mpid;
+	unsigned long long single_rate, min_rate, rate;
+	unsigned long long window_start, window_end;
+	unsigned int core_pos, cpus_cnt;
+	test_result_t ret;
+	int cpu_node;
+	int psci_ret;
+
+	ret = check_sdei_version();
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+	cpus_cnt = tftf_get_total_cpus_count();
+
+	for (unsigned int i = 0; i < PLATFORM_CORE_COUNT; i++)
+		tftf_init_event(&cpu_ready[i]);
+	tftf_init_event(&start_signalling);
+
+	/* Single core run on the lead CPU */
+	disable_irq();
+	if (sdei_perf_event_setup(0, sdei_perf_entrypoint) != 0) {
+		enable_irq();
+		return TEST_RESULT_FAIL;
+	}
+	ret = signal_events();
+	sdei_perf_event_teardown(0);
+	enable_irq();
+
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	single_rate = events_per_sec(THROUGHPUT_EVENTS_CNT,
+		cpu_data[lead_pos].end_ts - cpu_data[lead_pos].start_ts);
+
+	/* All cores at once */
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+
+		psci_ret = tftf_cpu_on(target_mpid,
+				(uintptr_t)signal_throughput_cpu, 0);
+		if (psci_ret != PSCI_E_SUCCESS) {
+			ERROR("CPU ON failed for 0x%llx\n",
+				(unsigned long long)target_mpid);
+			return TEST_RESULT_FAIL;
+		}
+
+		core_pos = platform_get_core_pos(target_mpid);
+		tftf_wait_for_event(&cpu_ready[core_pos]);
+	}
+
+	disable_irq();
+	if (sdei_perf_event_setup(0, sdei_perf_entrypoint) != 0) {
+		enable_irq();
+		tftf_send_event_to(&start_signalling, cpus_cnt - 1);
+		return TEST_RESULT_FAIL;
+	}
+
+	tftf_send_event_to(&start_signalling, cpus_cnt - 1);
+	ret = signal_events();
+
+	sdei_perf_event_teardown(0);
+	enable_irq();
+
+	/* Wait for all the other CPUs to be done */
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
+			PSCI_STATE_OFF)
+			continue;
+	}
+
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	window_start = UINT64_MAX;
+	window_end = 0;
+	min_rate = UINT64_MAX;
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		core_pos = platform_get_core_pos(target_mpid);
+
+		if (cpu_data[core_pos].count != THROUGHPUT_EVENTS_CNT) {
+			tftf_testcase_printf("CPU 0x%llx handled %u events\n",
+				(unsigned long long)target_mpid,
+				cpu_data[core_pos].count);
+			return TEST_RESULT_FAIL;
+		}
+
+		rate = events_per_sec(THROUGHPUT_EVENTS_CNT,
+			cpu_data[core_pos].end_ts - cpu_data[core_pos].start_ts);
+		NOTICE("CPU 0x%llx: %llu events/s\n",
+			(unsigned long long)target_mpid, rate);
+
+		min_rate = MIN(min_rate, rate);
+		window_start = MIN(window_start, cpu_data[core_pos].start_ts);
+		window_end = MAX(window_end, cpu_data[core_pos].end_ts);
+	}
+
+	tftf_testcase_printf("Single core: %llu events/s\n", single_rate);
+	tftf_testcase_printf("All %u cores: %llu events/s (slowest core %llu events/s)\n",
+		cpus_cnt,
+		events_per_sec((unsigned long long)THROUGHPUT_EVENTS_CNT * cpus_cnt,
+			       window_end - window_start),
+		min_rate);
+
+	return TEST_RESULT_SUCCESS;
+}
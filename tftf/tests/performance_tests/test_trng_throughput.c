@@ -0,0 +1,465 @@
+/*
+ * Copyright (c) 2023, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure the throughput and the per-call
+ * latency of the TRNG_RND SMC, on a single core and on all cores at once, and
+ * that run lightweight statistical checks over the returned entropy stream.
+ *
+ * The statistical checks are:
+ *  - the frequency (monobit) and runs tests from NIST SP 800-22, evaluated at
+ *    a significance level of 0.001 so that a single run gives a
+ *    stable verdict;
+ *  - the repetition count and adaptive proportion health tests from NIST
+ *    SP 800-90B, applied to 8-bit samples assumed to carry full entropy (as
+ *    mandated by the TRNG specification), with a false positive probability
+ *    of 2^-30 per sample.
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <debug.h>
+#include <events.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <power_management.h>
+#include <psci.h>
+#include <string.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+#include <trng.h>
+#include <utils_def.h>
+
+/* Number of TRNG_RND calls issued for each request size */
+#define TRNG_CALLS_CNT		1000
+
+/* Number of bits of entropy fed to the statistical tests */
+#define QUALITY_STREAM_BITS	(U(1) << 20)
+
+/* Width in bits of the registers returning entropy */
+#define TRNG_REG_BITS		(sizeof(u_register_t) * 8U)
+
+/* SP 800-90B repetition count test cutoff: 1 + ceil(30 / 8) */
+#define RCT_CUTOFF		5U
+
+/* SP 800-90B adaptive proportion test window and cutoff */
+#define APT_WINDOW		512U
+#define APT_CUTOFF		16U
+
+/*
+ * Health state of an entropy stream. The SP 800-22 tests only need the
+ * number of ones and the number of runs, so the stream does not have to be
+ * stored.
+ */
+struct trng_health {
+	unsigned long long bits;
+	unsigned long long ones;
+	unsigned long long runs;
+	unsigned int last_bit;
+
+	unsigned int rct_sample;
+	unsigned int rct_count;
+	unsigned int rct_failures;
+
+	unsigned int apt_sample;
+	unsigned int apt_count;
+	unsigned int apt_index;
+	unsigned int apt_failures;
+};
+
+/* Per-CPU throughput figures, written by each CPU for itself. */
+typedef struct {
+	uint64_t start_ts;
+	uint64_t end_ts;
+	uint64_t retries;
+	test_result_t result;
+} __aligned(CACHE_WRITEBACK_GRANULE) trng_cpu_data_t;
+
+static trng_cpu_data_t cpu_data[PLATFORM_CORE_COUNT];
+
+static event_t cpu_ready[PLATFORM_CORE_COUNT];
+static event_t start_requests;
+
+static inline unsigned long long cycles_to_ns(unsigned long long cycles)
+{
+	unsigned long long freq = read_cntfrq_el0();
+	return (cycles * 1000000000) / freq;
+}
+
+static unsigned long long bits_per_sec(unsigned long long bits,
+				       unsigned long long cycles)
+{
+	if (cycles == 0)
+		return 0;
+
+	return (bits * read_cntfrq_el0()) / cycles;
+}
+
+static unsigned int popcount64(uint64_t x)
+{
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+static int trng_supported(void)
+{
+	if (tftf_trng_version() == TRNG_E_NOT_SUPPORTED)
+		return 0;
+
+	return tftf_trng_feature_implemented(SMC_TRNG_RND) ? 1 : 0;
+}
+
+/*
+ * Issue TRNG_RND for `nbits` bits, retrying as long as the TRNG reports that
+ * no entropy is available. The number of retries is added to `*retries`.
+ */
+static smc_ret_values trng_rnd_retry(uint32_t nbits, uint64_t *retries)
+{
+	smc_ret_values rnd_out;
+
+	for (;;) {
+		rnd_out = tftf_trng_rnd(nbits);
+		if ((int32_t)rnd_out.ret0 != TRNG_E_NO_ENTROPY)
+			break;
+		(*retries)++;
+	}
+
+	return rnd_out;
+}
+
+static void trng_health_init(struct trng_health *health)
+{
+	memset(health, 0, sizeof(*health));
+}
+
+static void trng_health_feed_sample(struct trng_health *health,
+				    unsigned int sample)
+{
+	/* Repetition count test */
+	if ((health->rct_count != 0U) && (sample == health->rct_sample)) {
+		if (++health->rct_count == RCT_CUTOFF)
+			health->rct_failures++;
+	} else {
+		health->rct_sample = sample;
+		health->rct_count = 1U;
+	}
+
+	/* Adaptive proportion test */
+	if (health->apt_index == 0U) {
+		health->apt_sample = sample;
+		health->apt_count = 1U;
+	} else if (sample == health->apt_sample) {
+		if (++health->apt_count == APT_CUTOFF)
+			health->apt_failures++;
+	}
+
+	if (++health->apt_index == APT_WINDOW)
+		health->apt_index = 0U;
+}
+
+/* Feed the `nbits` least significant bits of `word` to the health tests. */
+static void trng_health_feed(struct trng_health *health, uint64_t word,
+			     unsigned int nbits)
+{
+	uint64_t transitions;
+
+	assert((nbits != 0U) && (nbits <= 64U) && ((nbits % 8U) == 0U));
+
+	if (nbits < 64U)
+		word &= (1ULL << nbits) - 1ULL;
+
+	/* Runs: count bit transitions, including across words */
+	transitions = (word ^ (word >> 1));
+	if (nbits < 64U)
+		transitions &= (1ULL << (nbits - 1U)) - 1ULL;
+	else
+		transitions &= ~(1ULL << 63);
+
+	if (health->bits == 0ULL)
+		health->runs = 1ULL;
+	else if ((word & 1ULL) != health->last_bit)
+		health->runs++;
+
+	health->runs += popcount64(transitions);
+	health->ones += popcount64(word);
+	health->bits += nbits;
+	health->last_bit = (unsigned int)(word >> (nbits - 1U)) & 1U;
+
+	for (unsigned int i = 0U; i < nbits; i += 8U)
+		trng_health_feed_sample(health, (unsigned int)(word >> i) & 0xFFU);
+}
+
+/* Feed the entropy returned by a TRNG_RND call for `nbits` bits. */
+static void trng_health_feed_rnd(struct trng_health *health,
+				 const smc_ret_values *rnd_out,
+				 unsigned int nbits)
+{
+	const u_register_t regs[3] = {
+		rnd_out->ret3, rnd_out->ret2, rnd_out->ret1
+	};
+
+	for (unsigned int i = 0U; (i < 3U) && (nbits != 0U); i++) {
+		unsigned int reg_bits = MIN(nbits, (unsigned int)TRNG_REG_BITS);
+
+		trng_health_feed(health, regs[i], reg_bits);
+		nbits -= reg_bits;
+	}
+}
+
+/*
+ * SP 800-22 frequency test: the test passes if
+ * |S| / sqrt(n) <= 3.2905, where S = ones - zeros.
+ */
+static bool trng_monobit_pass(const struct trng_health *health)
+{
+	long long s = (2LL * (long long)health->ones) - (long long)health->bits;
+	unsigned long long s2 = (unsigned long long)(s * s);
+
+	return (s2 * 10000ULL) <= (108276ULL * health->bits);
+}
+
+/*
+ * SP 800-22 runs test: with o ones and z zeros out of n bits, the test passes
+ * if |V - 2oz/n| <= 2.3268 * 2 * sqrt(2n) * oz / n^2, i.e.
+ * (V - 2oz/n)^2 <= 43.31 * (oz/n)^2 / n.
+ */
+static bool trng_runs_pass(const struct trng_health *health)
+{
+	unsigned long long n = health->bits;
+	unsigned long long e = (health->ones * (n - health->ones)) / n;
+	long long d = (long long)health->runs - (long long)(2ULL * e);
+	unsigned long long d2 = (unsigned long long)(d * d);
+
+	return d2 <= (((4331ULL * e * e) / 100ULL) / n);
+}
+
+/*
+ * Issue TRNG_CALLS_CNT requests for `nbits` bits on the calling CPU and
+ * record the time window in its cpu_data slot.
+ */
+static test_result_t trng_requests(uint32_t nbits, unsigned long long *min,
+				   unsigned long long *max)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	trng_cpu_data_t *data = &cpu_data[core_pos];
+	unsigned long long call_start, cycles;
+	smc_ret_values rnd_out;
+
+	*min = UINT64_MAX;
+	*max = 0ULL;
+	data->retries = 0ULL;
+	data->result = TEST_RESULT_SUCCESS;
+	data->start_ts = read_cntpct_el0();
+
+	for (unsigned int i = 0U; i < TRNG_CALLS_CNT; i++) {
+		call_start = read_cntpct_el0();
+		rnd_out = trng_rnd_retry(nbits, &data->retries);
+		cycles = read_cntpct_el0() - call_start;
+
+		if ((int32_t)rnd_out.ret0 != TRNG_E_SUCCESS) {
+			data->result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		*min = MIN(*min, cycles);
+		*max = MAX(*max, cycles);
+	}
+
+	data->end_ts = read_cntpct_el0();
+
+	return data->result;
+}
+
+/*
+ * @Test_Aim@ Measure the throughput and the per-call latency of TRNG_RND on
+ * the lead CPU for 32, 64 and TRNG_MAX_BITS bit requests.
+ * This test always succeeds if TRNG is supported.
+ */
+test_result_t test_trng_rnd_throughput(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	const uint32_t sizes[] = { 32U, 64U, TRNG_MAX_BITS };
+	unsigned long long min, max, cycles;
+
+	if (!trng_supported())
+		return TEST_RESULT_SKIPPED;
+
+	for (unsigned int i = 0U; i < ARRAY_SIZE(sizes); i++) {
+		if (trng_requests(sizes[i], &min, &max) != TEST_RESULT_SUCCESS) {
+			tftf_testcase_printf("TRNG_RND(%u) failed\n", sizes[i]);
+			return TEST_RESULT_FAIL;
+		}
+
+		cycles = cpu_data[core_pos].end_ts - cpu_data[core_pos].start_ts;
+		tftf_testcase_printf(
+			"%u bits: %llu bits/s, %llu ns/call (%llu to %llu), %llu retries\n",
+			sizes[i],
+			bits_per_sec((unsigned long long)sizes[i] * TRNG_CALLS_CNT,
+				     cycles),
+			cycles_to_ns(cycles / TRNG_CALLS_CNT),
+			cycles_to_ns(min), cycles_to_ns(max),
+			(unsigned long long)cpu_data[core_pos].retries);
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static test_result_t trng_throughput_cpu(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	unsigned long long min, max;
+
+	tftf_send_event(&cpu_ready[core_pos]);
+	tftf_wait_for_event(&start_requests);
+
+	return trng_requests(TRNG_MAX_BITS, &min, &max);
+}
+
+/*
+ * @Test_Aim@ Measure the aggregate TRNG_RND throughput when all CPUs request
+ * TRNG_MAX_BITS bits at the same time. The per-CPU rates are printed on the
+ * console, the aggregate rate and the rate of the slowest CPU are part of the
+ * test output.
+ * This test always succeeds if TRNG is supported.
+ */
+test_result_t test_trng_rnd_throughput_all_cores(void)
+{
+	u_register_t lead_mpid, target_mpid;
+	unsigned long long window_start, window_end, rate, min_rate;
+	unsigned long long min, max, retries = 0ULL;
+	unsigned int core_pos, cpus_cnt;
+	test_result_t ret;
+	int cpu_node;
+	int psci_ret;
+
+	if (!trng_supported())
+		return TEST_RESULT_SKIPPED;
+
+	lead_mpid = read_mpidr_el1() & MPID_MASK;
+	cpus_cnt = tftf_get_total_cpus_count();
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++)
+		tftf_init_event(&cpu_ready[i]);
+	tftf_init_event(&start_requests);
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+
+		psci_ret = tftf_cpu_on(target_mpid,
+				(uintptr_t)trng_throughput_cpu, 0);
+		if (psci_ret != PSCI_E_SUCCESS) {
+			ERROR("CPU ON failed for 0x%llx\n",
+				(unsigned long long)target_mpid);
+			return TEST_RESULT_FAIL;
+		}
+
+		core_pos = platform_get_core_pos(target_mpid);
+		tftf_wait_for_event(&cpu_ready[core_pos]);
+	}
+
+	tftf_send_event_to(&start_requests, cpus_cnt - 1U);
+	ret = trng_requests(TRNG_MAX_BITS, &min, &max);
+
+	/* Wait for all the other CPUs to be done */
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		if (lead_mpid == target_mpid)
+			continue;
+		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
+			PSCI_STATE_OFF)
+			continue;
+	}
+
+	window_start = UINT64_MAX;
+	window_end = 0ULL;
+	min_rate = UINT64_MAX;
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
+		core_pos = platform_get_core_pos(target_mpid);
+
+		if (cpu_data[core_pos].result != TEST_RESULT_SUCCESS) {
+			tftf_testcase_printf("TRNG_RND failed on CPU 0x%llx\n",
+				(unsigned long long)target_mpid);
+			ret = TEST_RESULT_FAIL;
+			continue;
+		}
+
+		rate = bits_per_sec((unsigned long long)TRNG_MAX_BITS *
+				    TRNG_CALLS_CNT,
+			cpu_data[core_pos].end_ts - cpu_data[core_pos].start_ts);
+		NOTICE("CPU 0x%llx: %llu bits/s\n",
+			(unsigned long long)target_mpid, rate);
+
+		min_rate = MIN(min_rate, rate);
+		retries += cpu_data[core_pos].retries;
+		window_start = MIN(window_start, cpu_data[core_pos].start_ts);
+		window_end = MAX(window_end, cpu_data[core_pos].end_ts);
+	}
+
+	if (ret != TEST_RESULT_SUCCESS)
+		return ret;
+
+	tftf_testcase_printf(
+		"All %u cores: %llu bits/s (slowest core %llu bits/s), %llu retries\n",
+		cpus_cnt,
+		bits_per_sec((unsigned long long)TRNG_MAX_BITS *
+			     TRNG_CALLS_CNT * cpus_cnt,
+			     window_end - window_start),
+		min_rate, retries);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Pull QUALITY_STREAM_BITS bits of entropy through TRNG_RND and
+ * run the monobit, runs, repetition count and adaptive proportion tests over
+ * the stream. The test fails if any of them fails.
+ */
+test_result_t test_trng_rnd_quality(void)
+{
+	struct trng_health health;
+	smc_ret_values rnd_out;
+	uint64_t retries = 0ULL;
+	bool monobit, runs;
+
+	if (!trng_supported())
+		return TEST_RESULT_SKIPPED;
+
+	trng_health_init(&health);
+
+	while (health.bits < QUALITY_STREAM_BITS) {
+		rnd_out = trng_rnd_retry(TRNG_MAX_BITS, &retries);
+		if ((int32_t)rnd_out.ret0 != TRNG_E_SUCCESS) {
+			tftf_testcase_printf("TRNG_RND returned 0x%lx\n",
+				(unsigned long)rnd_out.ret0);
+			return TEST_RESULT_FAIL;
+		}
+
+		trng_health_feed_rnd(&health, &rnd_out, TRNG_MAX_BITS);
+	}
+
+	monobit = trng_monobit_pass(&health);
+	runs = trng_runs_pass(&health);
+
+	tftf_testcase_printf("%llu bits, %llu ones, %llu runs\n",
+		health.bits, health.ones, health.runs);
+	tftf_testcase_printf(
+		"Monobit: %s, runs: %s, RCT failures: %u, APT failures: %u\n",
+		monobit ? "pass" : "FAIL", runs ? "pass" : "FAIL",
+		health.rct_failures, health.apt_failures);
+
+	if (!monobit || !runs || (health.rct_failures != 0U) ||
+	    (health.apt_failures != 0U))
+		return TEST_RESULT_FAIL;
+
+	return TEST_RESULT_SUCCESS;
+}
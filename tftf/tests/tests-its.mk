@@ -0,0 +1,12 @@
+#
+# Copyright (c) 2023, Arm Limited. All rights reserved.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+# The ITS driver is only built with these tests, as its tables take 64KB of
+# memory per core.
+TESTS_SOURCES	+=	drivers/arm/gic/gic_v3_its.c				\
+	$(addprefix tftf/tests/performance_tests/,			\
+		test_its_lpi.c						\
+	)
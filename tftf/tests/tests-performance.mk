@@ -1,10 +1,15 @@
 #
-# Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
 
 TESTS_SOURCES	+=	$(addprefix tftf/tests/performance_tests/,	\
 	smc_latencies.c							\
+	sdei_perf_entrypoint.S						\
+	test_gic_context_save.c						\
+	test_irq_latencies.c						\
 	test_psci_latencies.c						\
+	test_sdei_latencies.c						\
+	test_trng_throughput.c						\
 )
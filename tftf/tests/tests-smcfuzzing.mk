@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2020, Arm Limited. All rights reserved.
+# Copyright (c) 2020-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -12,6 +12,22 @@ SMC_FUZZ_INSTANCE_COUNT ?= 1
 SMC_FUZZ_SEEDS ?= $(shell python -c "from random import randint; seeds = [randint(0, 4294967295) for i in range($(SMC_FUZZ_INSTANCE_COUNT))];print(\",\".join(str(x) for x in seeds));")
 SMC_FUZZ_CALLS_PER_INSTANCE ?= 100
 
+# Run the instances concurrently, one per CPU, each with its own memory pool
+# and random number generator state so that results only depend on the seeds
+SMC_FUZZ_MULTICORE ?= 0
+
+# Number of memory pools of at least 64KB, i.e. maximum number of CPUs running
+# instances concurrently in multi-core mode
+SMC_FUZZ_POOL_COUNT ?= 1
+
+# Probe the firmware state after each call and raise the biases of the calls
+# producing new return values or state transitions, then print the coverage map
+SMC_FUZZ_FEEDBACK ?= 0
+
+# Use the original first-fit allocator for the memory pools instead of the
+# size-class slab allocator
+SMC_FUZZ_LEGACY_MALLOC ?= 0
+
 # Validate SMC fuzzer parameters
 
 # Instance count must not be zero
@@ -24,6 +40,20 @@ ifeq ($(SMC_FUZZ_CALLS_PER_INSTANCE),0)
 $(error SMC_FUZZ_CALLS_PER_INSTANCE must not be zero!)
 endif
 
+# Pool count must not be zero
+ifeq ($(SMC_FUZZ_POOL_COUNT),0)
+$(error SMC_FUZZ_POOL_COUNT must not be zero!)
+endif
+
+# Multi-core mode needs one pool per CPU running instances
+ifeq ($(SMC_FUZZ_MULTICORE)-$(SMC_FUZZ_POOL_COUNT),1-1)
+$(error SMC_FUZZ_MULTICORE requires SMC_FUZZ_POOL_COUNT to be greater than 1!)
+endif
+
+$(eval $(call assert_boolean,SMC_FUZZ_FEEDBACK))
+$(eval $(call assert_boolean,SMC_FUZZ_LEGACY_MALLOC))
+$(eval $(call assert_boolean,SMC_FUZZ_MULTICORE))
+
 # Make sure seed count and instance count match
 TEST_SEED_COUNT = $(shell python -c "print(len(\"$(SMC_FUZZ_SEEDS)\".split(\",\")))")
 ifneq ($(TEST_SEED_COUNT), $(SMC_FUZZ_INSTANCE_COUNT))
@@ -34,10 +64,22 @@ endif
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_SEEDS))
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_INSTANCE_COUNT))
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_CALLS_PER_INSTANCE))
+$(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_FEEDBACK))
+$(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_LEGACY_MALLOC))
+$(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_MULTICORE))
+$(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_POOL_COUNT))
 
 TESTS_SOURCES	+=							\
 	$(addprefix smc_fuzz/src/,					\
+		alias_table.c						\
+		arg_gen.c						\
 		randsmcmod.c						\
-		smcmalloc.c						\
-		fifo3d.c						\
+		smc_coverage.c						\
+		smc_tree.c						\
 	)
+
+ifeq ($(SMC_FUZZ_LEGACY_MALLOC),1)
+TESTS_SOURCES	+=	smc_fuzz/src/smcmalloc.c
+else
+TESTS_SOURCES	+=	smc_fuzz/src/smcslab.c
+endif
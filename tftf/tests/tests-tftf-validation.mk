@@ -1,5 +1,5 @@
 #
-# Copyright (c) 2018, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -11,4 +11,5 @@ TESTS_SOURCES	+=						\
 		test_validation_irq.c				\
 		test_validation_nvm.c				\
 		test_validation_sgi.c				\
+		test_validation_topology.c			\
 	)
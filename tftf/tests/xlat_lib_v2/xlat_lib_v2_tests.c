@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2023, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -28,6 +28,8 @@
  */
 
 #define STRESS_TEST_ITERATIONS		1000
+#define STRESS_TEST_BULK_ITERATIONS	16
+#define CONT_TEST_ITERATIONS		32
 
 #define SIZE_L1		XLAT_BLOCK_SIZE(1)
 #define SIZE_L2		XLAT_BLOCK_SIZE(2)
@@ -242,6 +244,11 @@ static size_t block_size;
  */
 static int block_used[STRESS_TEST_NUM_BLOCKS];
 
+/* Snapshots of the translation tables before and after the stress test */
+#define STRESS_TEST_SNAPSHOT_SIZE	(8U * 1024U)
+static uint64_t snapshot_before[STRESS_TEST_SNAPSHOT_SIZE / sizeof(uint64_t)];
+static uint64_t snapshot_after[STRESS_TEST_SNAPSHOT_SIZE / sizeof(uint64_t)];
+
 /* Returns -1 if error, 1 if chunk added, 0 if not added */
 static int alloc_random_chunk(void)
 {
@@ -768,17 +775,91 @@ test_result_t xlat_lib_v2_alignment_test(void)
 	return TEST_RESULT_SUCCESS;
 }
 
+static unsigned long long ticks_to_us(uint64_t ticks)
+{
+	return (ticks * 1000000ULL) / read_cntfrq_el0();
+}
+
+/*
+ * Map and unmap the whole region of the stress test STRESS_TEST_BULK_ITERATIONS
+ * times, changing the attributes of its pages in between, and print the time
+ * taken by each step. The region starts one page after `memory_base`, which is
+ * aligned to a level 1 block, so its unaligned head, up to the next level 2
+ * block, is mapped with pages and the rest with blocks. Only the pages of the
+ * head can have their attributes changed.
+ */
+static int stress_test_bulk(uintptr_t memory_base)
+{
+	uintptr_t base = memory_base + PAGE_SIZE;
+	size_t size = memory_size - PAGE_SIZE;
+	size_t pages_size = MIN(size, SIZE_L2 - PAGE_SIZE);
+	uint64_t map_ticks = 0U, unmap_ticks = 0U, attr_ticks = 0U;
+	uint64_t start;
+	int rc;
+
+	for (int i = 0; i < STRESS_TEST_BULK_ITERATIONS; i++) {
+		start = syscounter_read();
+		rc = mmap_add_dynamic_region(base, base, size,
+					     MT_DEVICE | MT_RW);
+		map_ticks += syscounter_read() - start;
+		if (rc != 0) {
+			tftf_testcase_printf("%d: mmap_add_dynamic_region: %d\n",
+					     __LINE__, rc);
+			return -1;
+		}
+
+		start = syscounter_read();
+		rc = xlat_change_mem_attributes(base, pages_size,
+						MT_RO | MT_EXECUTE_NEVER);
+		attr_ticks += syscounter_read() - start;
+		if (rc != 0) {
+			tftf_testcase_printf("%d: xlat_change_mem_attributes: %d\n",
+					     __LINE__, rc);
+			(void)mmap_remove_dynamic_region(base, size);
+			return -1;
+		}
+
+		start = syscounter_read();
+		rc = mmap_remove_dynamic_region(base, size);
+		unmap_ticks += syscounter_read() - start;
+		if (rc != 0) {
+			tftf_testcase_printf("%d: mmap_remove_dynamic_region: %d\n",
+					     __LINE__, rc);
+			return -1;
+		}
+	}
+
+	tftf_testcase_printf("%zu KiB: map %llu us, unmap %llu us, change attributes of %zu KiB %llu us\n",
+		size / 1024U,
+		ticks_to_us(map_ticks) / STRESS_TEST_BULK_ITERATIONS,
+		ticks_to_us(unmap_ticks) / STRESS_TEST_BULK_ITERATIONS,
+		pages_size / 1024U,
+		ticks_to_us(attr_ticks) / STRESS_TEST_BULK_ITERATIONS);
+
+	return 0;
+}
+
 /**
  * @Test_Aim@ Perform dynamic translation tables API stress tests
  *
- * This test performs a stress test in the library APIs.
+ * This test performs a stress test in the library APIs. It also prints the
+ * time taken to map, unmap and change the attributes of a large region, and
+ * checks that all the tables and mmap entries used are given back, and that
+ * the translation tables are left as they were found.
  */
 test_result_t xlat_lib_v2_stress_test(void)
 {
 	test_result_t test_result = TEST_RESULT_SUCCESS;
+	xlat_tables_stats_t stats_before, stats_after;
+	xlat_snapshot_t *snap_before = (xlat_snapshot_t *)snapshot_before;
+	xlat_snapshot_t *snap_after = (xlat_snapshot_t *)snapshot_after;
+	int snap_rc;
 	uintptr_t memory_base;
 	int rc;
 
+	xlat_get_tables_stats(&stats_before);
+	snap_rc = xlat_snapshot(snap_before, sizeof(snapshot_before));
+
 	/*
 	 * 1) Try to allocate an invalid region. It should fail, but it will
 	 * return the address of memory that can be used for the following
@@ -828,6 +909,10 @@ test_result_t xlat_lib_v2_stress_test(void)
 		return TEST_RESULT_FAIL;
 	}
 
+	if (stress_test_bulk(memory_base) != 0) {
+		return TEST_RESULT_FAIL;
+	}
+
 	/* 3) Start stress test with the calculated top VA and space */
 
 	memset(block_used, 0, sizeof(block_used));
@@ -853,5 +938,153 @@ test_result_t xlat_lib_v2_stress_test(void)
 		}
 	}
 
+	xlat_get_tables_stats(&stats_after);
+
+	tftf_testcase_printf("Tables: %u used, peak %u out of %u. Regions: %u out of %u\n",
+		stats_after.tables_used, stats_after.tables_peak,
+		stats_after.tables_num, stats_after.regions,
+		stats_after.regions_num);
+
+	if ((stats_after.tables_used != stats_before.tables_used) ||
+	    (stats_after.regions != stats_before.regions)) {
+		tftf_testcase_printf("%d: Leaked %d tables and %d regions\n",
+			__LINE__,
+			(int)(stats_after.tables_used - stats_before.tables_used),
+			(int)(stats_after.regions - stats_before.regions));
+		test_result = TEST_RESULT_FAIL;
+	}
+
+	if (snap_rc == 0) {
+		snap_rc = xlat_snapshot(snap_after, sizeof(snapshot_after));
+	}
+	if (snap_rc != 0) {
+		tftf_testcase_printf("Snapshot of the tables skipped: %d\n",
+				     snap_rc);
+	} else if (xlat_snapshot_diff(snap_before, snap_after) != 0U) {
+		tftf_testcase_printf("%d: Translation tables modified\n",
+				     __LINE__);
+		test_result = TEST_RESULT_FAIL;
+	} else {
+		xlat_snapshot_print_profile(snap_after);
+	}
+
 	return test_result;
 }
+
+/*
+ * Regions mapped by the contiguous hint test. The first one is mapped with
+ * pages, as its base isn't aligned to a level 2 block, the second one with
+ * level 2 blocks.
+ */
+static const struct {
+	const char *name;
+	size_t offset;
+	size_t size;
+} cont_tests[] = {
+	{ "pages",	XLAT_CONT_SIZE(3),	2 * SIZE_L2 },
+	{ "blocks",	0,			2 * XLAT_CONT_SIZE(2) }
+};
+
+/*
+ * Map and unmap a region CONT_TEST_ITERATIONS times, then map it once more and
+ * translate each of its pages with the AT instruction. Print the time taken by
+ * each step. Returns 0 on success, 1 if the region isn't mapped correctly and
+ * the error code of mmap_add_dynamic_region() if it can't be mapped.
+ */
+static int cont_test_region(const char *name, uintptr_t base, size_t size,
+			    unsigned int attr)
+{
+	uint64_t map_ticks = 0U, unmap_ticks = 0U, at_ticks;
+	uint64_t start;
+	int rc;
+
+	for (int i = 0; i < CONT_TEST_ITERATIONS; i++) {
+		start = syscounter_read();
+		rc = mmap_add_dynamic_region(base, base, size, attr);
+		map_ticks += syscounter_read() - start;
+		if (rc != 0) {
+			return rc;
+		}
+
+		start = syscounter_read();
+		rc = mmap_remove_dynamic_region(base, size);
+		unmap_ticks += syscounter_read() - start;
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	rc = mmap_add_dynamic_region(base, base, size, attr);
+	if (rc != 0) {
+		return rc;
+	}
+
+	start = syscounter_read();
+	rc = verify_region_mapped(base, base, size);
+	at_ticks = syscounter_read() - start;
+
+	if (mmap_remove_dynamic_region(base, size) != 0) {
+		rc = 1;
+	}
+
+	tftf_testcase_printf("%s%s: map %llu us, unmap %llu us, AT %llu ns/page\n",
+		name, ((attr & MT_CONT_HINT) != 0U) ? " (hint)" : "",
+		ticks_to_us(map_ticks) / CONT_TEST_ITERATIONS,
+		ticks_to_us(unmap_ticks) / CONT_TEST_ITERATIONS,
+		(ticks_to_us(at_ticks) * 1000ULL) / (size / PAGE_SIZE));
+
+	return rc;
+}
+
+/**
+ * @Test_Aim@ Measure the effect of the contiguous hint on mapping regions
+ *
+ * This test maps regions with pages and with level 2 blocks, with and without
+ * the contiguous hint, checks that they are mapped correctly and prints the
+ * time taken to map and unmap them and to translate their pages.
+ */
+test_result_t xlat_lib_v2_contiguous_test(void)
+{
+	uintptr_t memory_base;
+	int rc;
+
+	/*
+	 * Try to allocate an invalid region. It should fail, but it will
+	 * return the address of memory that can be used for the test.
+	 */
+	rc = add_region_alloc_va(0, &memory_base, SIZE_MAX, MT_DEVICE);
+	if (rc == 0) {
+		tftf_testcase_printf("%d: add_region_alloc_va() didn't fail\n",
+				     __LINE__);
+		return TEST_RESULT_FAIL;
+	}
+
+	/* Align it so that the level 2 blocks can be contiguous */
+	memory_base = (memory_base + SIZE_L1 - 1UL) & ~MASK_L1;
+
+	INFO("Using 0x%lx as base address for tests.\n", memory_base);
+
+	for (int i = 0; i < ARRAY_SIZE(cont_tests); i++) {
+		uintptr_t base = memory_base + cont_tests[i].offset;
+
+		rc = cont_test_region(cont_tests[i].name, base,
+				      cont_tests[i].size,
+				      MT_DEVICE | MT_CONT_HINT);
+		if (rc == 0) {
+			rc = cont_test_region(cont_tests[i].name, base,
+					      cont_tests[i].size, MT_DEVICE);
+		}
+
+		if ((rc == -ENOMEM) || (rc == -ERANGE)) {
+			tftf_testcase_printf("%d: Not enough memory for %s\n",
+					     __LINE__, cont_tests[i].name);
+			return TEST_RESULT_SKIPPED;
+		} else if (rc != 0) {
+			tftf_testcase_printf("%d: %s: %d\n", __LINE__,
+					     cont_tests[i].name, rc);
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -1,7 +1,7 @@
 #!/usr/bin/env perl
 
 #
-# Copyright (c) 2018-2020, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2023, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -168,14 +168,22 @@ for my $testsuite (@all_testsuites) {
     my $testcase_name = $testcase->getAttribute('name');
     my $testcase_description = $testcase->getAttribute('description');
     my $testcase_function = $testcase->getAttribute('function');
+    my $testcase_single_core = $testcase->getAttribute('single_core');
 
     if (!defined($testcase_description)) { $testcase_description = ""; }
 
-    print FILE_SRC "  { $testcase_index, \"$testcase_name\", \"$testcase_description\", $testcase_function },\n";
+    # Test cases tagged as single-core may run in parallel with other ones.
+    if (defined($testcase_single_core) && ($testcase_single_core eq "true")) {
+      $testcase_single_core = 1;
+    } else {
+      $testcase_single_core = 0;
+    }
+
+    print FILE_SRC "  { $testcase_index, \"$testcase_name\", \"$testcase_description\", $testcase_function, $testcase_single_core },\n";
 
     $testcase_index++;
   }
-  print FILE_SRC "  { 0, NULL, NULL, NULL }\n";
+  print FILE_SRC "  { 0, NULL, NULL, NULL, 0 }\n";
   print FILE_SRC "};\n\n";
   $testsuite_index++;
 }